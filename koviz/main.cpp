@@ -5,6 +5,7 @@
 #include <QString>
 #include <QDate>
 #include <QRegExp>
+#include <QThread>
 
 #include <string>
 using namespace std;
@@ -22,15 +23,18 @@ using namespace std;
 #ifdef __linux
 #include "libkoviz/timeit_linux.h"
 #endif
-#include "libkoviz/timestamps.h"
-#include "libkoviz/tricktablemodel.h"
 #include "libkoviz/dp.h"
 #include "libkoviz/snap.h"
 #include "libkoviz/csv.h"
 #include "libkoviz/datamodel_trick.h"
 #include "libkoviz/curvemodel.h"
+#include "libkoviz/curvemodel_ensemble.h"
+#include "libkoviz/curvesmerge.h"
+#include "libkoviz/dppagebuilder.h"
+#include "libkoviz/bookprinter.h"
 #include "libkoviz/trick_types.h"
 #include "libkoviz/session.h"
+#include "libkoviz/tailfollower.h"
 
 QStandardItemModel* createVarsModel(Runs* runs);
 bool writeTrk(const QString& ftrk, const QString &timeName,
@@ -39,6 +43,11 @@ bool writeTrk(const QString& ftrk, const QString &timeName,
 bool writeCsv(const QString& fcsv, const QStringList& timeNames,
               DPTable* dpTable, const QString &runDir,
               double startTime, double stopTime, double tolerance);
+void createVarsPages(PlotBookModel* bookModel, Runs* runs,
+                     const QString& varsString, const QString& timeName,
+                     const QStringList& unitOverridesList,
+                     const QString& presentation);
+void printPdfProgress(int nPagesDone, int nPages, void* data);
 bool convert2csv(const QStringList& timeNames,
                  const QString& ftrk, const QString& fcsv);
 bool convert2trk(const QString& csvFileName, const QString &trkFileName);
@@ -162,6 +171,12 @@ class SnapOptions : public Options
     QString yaxislabel;
     QString vars;
     QString liveTime;
+    uint loadThreads;
+    bool isNoCache;
+    uint pdfThreads;
+    bool isPdfExact;
+    QString ensemble;
+    uint follow;
 };
 
 SnapOptions opts;
@@ -317,6 +332,23 @@ int main(int argc, char *argv[])
     opts.add("-liveTime",
              &opts.liveTime,"", "Select first curve and set live time arrow.  "
                                 "Videos will start paused at given time.");
+    opts.add("-loadThreads", &opts.loadThreads, 0,
+             "Number of threads used to load RUN data (default is all cores)");
+    opts.add("-noCache:{0,1}",&opts.isNoCache,false,
+             "Do not read or write the trk header cache in RUN dirs");
+    opts.add("-pdfThreads", &opts.pdfThreads, 0,
+             "Number of threads used to render -pdf pages "
+             "(default is all cores)");
+    opts.add("-pdfExact:{0,1}",&opts.isPdfExact,false,
+             "Print every sample of curves into -pdf files (default is "
+             "min/max per printer dot column)");
+    opts.add("-ensemble",&opts.ensemble,"",
+             "Plot stats across RUNs instead of a curve per RUN, "
+             "e.g. -ensemble \"mean,+3sigma,-3sigma\" "
+             "(stats: mean,min,max,+Nsigma,-Nsigma,pN)");
+    opts.add("-follow",&opts.follow,0,
+             "Follow RUNs that are still logging, curves are extended at "
+             "most every given milliseconds (e.g. -follow 500)");
 
     opts.parse(argc,argv, QString("koviz"), &ok);
 
@@ -335,6 +367,15 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    foreach ( QString stat, opts.ensemble.split(",",QString::SkipEmptyParts) ) {
+        if ( !CurveModelEnsemble::isStat(stat) ) {
+            fprintf(stderr,"koviz [error]: -ensemble has bad stat=\"%s\".  "
+                           "Stats are mean,min,max,+Nsigma,-Nsigma and pN "
+                           "(e.g. p95).\n", stat.toLatin1().constData());
+            return -1;
+        }
+    }
+
     QStringList dps;
     QStringList runDirs;
     foreach ( QString f, opts.rundps ) {
@@ -616,6 +657,10 @@ int main(int argc, char *argv[])
         if ( isPdf ) {
             isShowProgress = false;
         }
+#ifdef __linux
+        TimeItLinux loadTimer;
+        loadTimer.start();
+#endif
         if ( isMonte ) {
 
             QDir monteDir(runDirs.at(0));
@@ -649,7 +694,9 @@ int main(int argc, char *argv[])
             runs = new Runs(timeNames,monteRunsList,varMap,
                             filterPattern,
                             excludePattern,
-                            isShowProgress);
+                            isShowProgress,
+                            !opts.isNoCache,
+                            opts.loadThreads);
             monteInputsModel = monteInputModel(monteDir.absolutePath(),
                                                runsList);
         } else {
@@ -660,9 +707,20 @@ int main(int argc, char *argv[])
             runs = new Runs(timeNames,runsList,varMap,
                             filterPattern,
                             excludePattern,
-                            isShowProgress);
+                            isShowProgress,
+                            !opts.isNoCache,
+                            opts.loadThreads);
             monteInputsModel = runsInputModel(runsList);
         }
+#ifdef __linux
+        if ( opts.isDebug ) {
+            fprintf(stderr, "koviz [debug]: loaded %d runs in %g sec "
+                            "using %d threads\n",
+                    runs->runDirs().size(), loadTimer.stop()/1000000.0,
+                    opts.loadThreads > 0 ? (int)opts.loadThreads
+                                         : QThread::idealThreadCount());
+        }
+#endif
         varsModel = createVarsModel(runs);
 
         // Make a list of titles
@@ -1189,6 +1247,8 @@ int main(int argc, char *argv[])
         bookModel->addChild(rootItem,"ButtonReset",opts.buttonReset );
         bookModel->addChild(rootItem,"XAxisLabel",xaxislabel );
         bookModel->addChild(rootItem,"YAxisLabel",yaxislabel );
+        bookModel->addChild(rootItem,"IsPrintExact",opts.isPdfExact );
+        bookModel->addChild(rootItem,"EnsembleStats",opts.ensemble );
 
         if ( isTrk ) {
 
@@ -1289,6 +1349,51 @@ int main(int argc, char *argv[])
             }
 
 
+        } else if ( isPdf && !opts.isPlotAllVars ) {
+
+            // Build the book straight into the model and print it,
+            // no PlotMainWindow (or any other widget) is made
+            DPPageBuilder pageBuilder(timeNames.at(0),runs->runDirs(),
+                                      bookModel,unitOverridesList);
+            int idNum = 0;
+            foreach ( QString dp, dps ) {
+                pageBuilder.createPages(dp,&idNum);
+            }
+            createVarsPages(bookModel,runs,opts.vars,timeName,
+                            unitOverridesList,presentation);
+
+            // Plot views sync x-time plots to the last one whose math
+            // rect was set, do the same without views
+            QModelIndexList pageIdxs = bookModel->pageIdxs();
+            for ( int i = pageIdxs.size()-1; i >= 0; --i ) {
+                QModelIndexList plotIdxs = bookModel->plotIdxs(pageIdxs.at(i));
+                int j = plotIdxs.size()-1;
+                while ( j >= 0 && !bookModel->isXTime(plotIdxs.at(j)) ) {
+                    --j;
+                }
+                if ( j >= 0 ) {
+                    bookModel->syncXTimePlots(plotIdxs.at(j));
+                    break;
+                }
+            }
+
+            BookPrinter bookPrinter(bookModel);
+            bookPrinter.setThreadCount(opts.pdfThreads);
+            if ( opts.isDebug ) {
+                bookPrinter.setProgressCallback(printPdfProgress);
+            }
+#ifdef __linux
+            TimeItLinux pdfTimer;
+            pdfTimer.start();
+#endif
+            ret = bookPrinter.savePdf(pdfOutFile,pageIdxs) ? 0 : -1;
+#ifdef __linux
+            if ( opts.isDebug ) {
+                fprintf(stderr, "koviz [debug]: printed %d pages in %g sec\n",
+                        pageIdxs.size(), pdfTimer.stop()/1000000.0);
+            }
+#endif
+
         } else {
 
             QString dpDir;
@@ -1321,84 +1426,27 @@ int main(int argc, char *argv[])
                              varsModel,
                              monteInputsModel);
 
-            //
-            // Handle -vars commandline option
-            //
-            QStringList vars = opts.vars.split(",", QString::SkipEmptyParts);
-            foreach (QString var, vars ) {
-                QString v = var;
-                if ( v.at(0) == '@' ) {
-                    v = var.mid(1);
-                }
-                if ( !runs->params().contains(v) ) {
-                    fprintf(stderr, "koviz [error]: Cannot find var=\"%s\" "
-                                    "from -vars option.  Run(s) do not contain "
-                                    "this variable.\n",
-                                    var.toLatin1().constData());
-                    exit(-1);
-                }
-            }
-            int i = 0;
-            QStandardItem* pageItem = 0;
-            QModelIndex plotIdx;
-            foreach ( QString var, vars ) {
-                if ( i > 0 && var.at(0) == '@' ) {
-                    // If var begins with @, place on same plot as last var
-                    QModelIndex pageIdx = pageItem->index();
-                    QModelIndex plotsIdx = bookModel->getIndex(pageIdx,
-                                                                "Plots","Page");
-                    int nplots = bookModel->rowCount(plotsIdx);
-                    plotIdx = bookModel->index(nplots-1,0,plotsIdx);
-                    QModelIndex curvesIdx = bookModel->getIndex(plotIdx,
-                                                         "Curves", "Plot");
-                    QString v = var.mid(1);
-                    bookModel->createCurves(curvesIdx,timeName,v,
-                                            unitOverridesList, 0,0);
-
-                    // Set y axis label to empty string (since multiple vars)
-                    QModelIndex yAxisLabelIdx = bookModel->getDataIndex(plotIdx,
-                                                       "PlotYAxisLabel","Plot");
-                    bookModel->setData(yAxisLabelIdx, "");
-                } else {
-                    if ( i%6 == 0 ) {
-                        pageItem = bookModel->createPageItem();
-                    }
-
-                    QStandardItem* plotItem = bookModel->createPlotItem(
-                                                          pageItem,
-                                                          timeName,
-                                                          var.trimmed(),
-                                                          unitOverridesList,0);
-                    plotIdx = plotItem->index();
-                    ++i;
-                }
-
-                // Presentation
-                QModelIndex presIdx = bookModel->getDataIndex(plotIdx,
-                                                    "PlotPresentation", "Plot");
-                if ( runs->runDirs().size() == 2 ) {
-                    QModelIndex curvesIdx = bookModel->getIndex(plotIdx,
-                                                               "Curves","Plot");
-                    QModelIndexList curveIdxs = bookModel->getIndexList(
-                                                    curvesIdx,"Curve","Curves");
-                    if ( curveIdxs.size() == 2 && !presentation.isEmpty()) {
-                        bookModel->setData(presIdx,presentation);
-                        QRectF bbox = bookModel->calcCurvesBBox(curvesIdx);
-                        bookModel->setPlotMathRect(bbox,plotIdx);
-                    }
-                }
-            }
+            createVarsPages(bookModel,runs,opts.vars,timeName,
+                            unitOverridesList,presentation);
 
             if ( !opts.liveTime.isEmpty() ) {
                 w.selectFirstCurve();
             }
 
             if ( isPdf ) {
+                // -a with -pdf plots vars through the vars widget
                 w.savePdf(pdfOutFile);
                 ret = 0;
             } else {
+                // Plots made interactively load curves in the background
+                bookModel->setAsyncCurves(true);
+                TailFollower* follower = 0;
+                if ( opts.follow > 0 && runs ) {
+                    follower = new TailFollower(runs,bookModel,opts.follow);
+                }
                 w.show();
                 ret = a.exec();
+                delete follower;
             }
         }
 
@@ -1663,88 +1711,35 @@ bool writeTrk(const QString& ftrk, const QString& timeName,
         return false;
     }
 
-    // Make time stamps list
-    QList<double> timeStamps;
-    foreach ( CurveModel* curve, curves ) {
-
-        if ( !curve ) continue ;
-
-        curve->map();
-
-        ModelIterator* it = curve->begin();
-        while ( !it->isDone() ) {
-            double t = it->t();
-            if ( t < start ) {
-                it->next();
-                continue;
-            }
-            if ( t > stop ) {
-                break;
-            }
-            TimeStamps::insert(t,timeStamps);
-            it->next();
-        }
-        delete it;
-        curve->unmap();
-    }
-
     // Open trk file for writing
     QFile trk(ftrk);
     if (!trk.open(QIODevice::WriteOnly)) {
         fprintf(stderr,"koviz: [error] could not open %s\n",
                 ftrk.toLatin1().constData());
+        foreach ( CurveModel* curveModel, curves ) {
+            delete curveModel;
+        }
         return false;
     }
     QDataStream out(&trk);
 
     // Write Trk Header
     TrickModel::writeTrkHeader(out,params);
-    trk.flush();
 
-    // Resize Trk file to fit all the data + header
-    qint64 headerSize = trk.size();
-    qint64 nParams = params.size();
-    qint64 recordSize = nParams*sizeof(double);
-    qint64 nRecords = timeStamps.count();
-    qint64 dataSize = nRecords*recordSize;
-    qint64 fileSize = headerSize + dataSize;
-    trk.resize(fileSize);
-
-    int nTimeStamps = timeStamps.count();
-
-    // Write time stamps and data
-    int i = 0;
+    // Write records in one pass over the merged timeline of all curves
     foreach ( CurveModel* curve, curves ) {
-
-        if ( !curve ) {
-            // write time stamps
-            for ( int j = 0 ; j < nTimeStamps; ++j ) {
-                qint64 recordOffset = j*recordSize;
-                qint64 paramOffset = 0;
-                qint64 offset = headerSize + recordOffset + paramOffset;
-                trk.seek(offset);
-                out << timeStamps.at(j)+timeShift;
-            }
-        } else {
-            // write curve data
-            curve->map();
-            ModelIterator* it = curve->begin();
-            for ( int j = 0 ; j < nTimeStamps; ++j ) {
-
-                double timeStamp = timeStamps.at(j);
-                int k = curve->indexAtTime(timeStamp);
-                double v = it->at(k)->y();
-
-                qint64 recordOffset = j*recordSize;
-                qint64 paramOffset = i*sizeof(double);
-                qint64 offset = headerSize + recordOffset + paramOffset;
-                trk.seek(offset);
-                out << v;
-            }
-            delete it;
-            curve->unmap();
+        if ( curve ) curve->map();
+    }
+    CurvesMerge merge(curves,start,stop);
+    int nParams = curves.size();
+    while ( merge.next() ) {
+        out << merge.time()+timeShift;
+        for ( int i = 1; i < nParams; ++i ) {
+            out << merge.value(i);
         }
-        ++i;
+    }
+    foreach ( CurveModel* curve, curves ) {
+        if ( curve ) curve->unmap();
     }
 
     //
@@ -1803,32 +1798,76 @@ bool writeCsv(const QString& fcsv, const QStringList& timeNames,
     }
 
 
-    TrickTableModel ttm(timeNames, runDir, params);
-    int rc = ttm.rowCount();
-    int cc = ttm.columnCount();
-    double epsilon = tolerance/2.0;
-    for ( int r = 0 ; r < rc; ++r ) {
-        bool isWriteRecord = true;
-        for ( int c = 0 ; c < cc; ++c ) {
-            QModelIndex idx = ttm.index(r,c);
-            double v = ttm.data(idx).toDouble();
-            if ( c == 0 ) {
-                if ( v < startTime-epsilon || v > stopTime+epsilon ) {
-                    isWriteRecord = false;
-                    break;
-                }
-            }
-            out << v;
-            if ( c < cc-1 ) {
-                int fw = out.fieldWidth();
-                out.setFieldWidth(0);
-                out << ",";
-                out.setFieldWidth(fw);
-            }
+    // Make a curve for each param from the first trk in RUN that has it.
+    // Params not found in RUN are left null (and written as 0)
+    QStringList trks = QDir(runDir).entryList(QStringList("*.trk"),
+                                              QDir::Files);
+    if ( trks.isEmpty() ) {
+        fprintf(stderr,"koviz [error]: no trk logfiles found in %s\n",
+                runDir.toLatin1().constData());
+        return false;
+    }
+    QList<DataModel*> trkModels;
+    QList<CurveModel*> curves;
+    for ( int i = 0; i < params.size(); ++i ) {
+        curves << 0;
+    }
+    int nFound = 0;
+    foreach ( QString trk, trks ) {
+        DataModel* trkModel = DataModel::createDataModel(timeNames,
+                                                         runDir + "/" + trk);
+        trkModel->map();
+        int timeCol = -1;
+        foreach ( QString timeName, timeNames ) {
+            timeCol = trkModel->paramColumn(timeName);
+            if ( timeCol >= 0 ) break;
+        }
+        bool isUsed = false;
+        if ( timeCol >= 0 ) {
+            for ( int i = 0; i < params.size(); ++i ) {
+                if ( curves.at(i) ) continue;
+                int col = trkModel->paramColumn(params.at(i));
+                if ( col < 0 || col == timeCol ) continue;
+                curves[i] = new CurveModel(trkModel,timeCol,timeCol,col);
+                isUsed = true;
+                ++nFound;
+            }
+        }
+        if ( isUsed ) {
+            trkModels << trkModel;
+        } else {
+            trkModel->unmap();
+            delete trkModel;
         }
-        if ( isWriteRecord && r < rc-1 ) {
+        if ( nFound == params.size() ) break;
+    }
+
+    // Write records in one pass over the merged timeline of all curves
+    double epsilon = tolerance/2.0;
+    CurvesMerge merge(curves,startTime-epsilon,stopTime+epsilon);
+    int cc = curves.size();
+    bool isFirst = true;
+    while ( merge.next() ) {
+        if ( !isFirst ) {
             out << "\n";
         }
+        isFirst = false;
+        out << merge.time();
+        for ( int c = 0; c < cc; ++c ) {
+            int fw = out.fieldWidth();
+            out.setFieldWidth(0);
+            out << ",";
+            out.setFieldWidth(fw);
+            out << merge.value(c);
+        }
+    }
+
+    foreach ( CurveModel* curve, curves ) {
+        delete curve;
+    }
+    foreach ( DataModel* trkModel, trkModels ) {
+        trkModel->unmap();
+        delete trkModel;
     }
 
     // Clean up
@@ -1837,6 +1876,85 @@ bool writeCsv(const QString& fcsv, const QStringList& timeNames,
     return true;
 }
 
+// Handle -vars commandline option, plots go on pages of six
+void createVarsPages(PlotBookModel* bookModel, Runs* runs,
+                     const QString& varsString, const QString& timeName,
+                     const QStringList& unitOverridesList,
+                     const QString& presentation)
+{
+    QStringList vars = varsString.split(",", QString::SkipEmptyParts);
+    foreach (QString var, vars ) {
+        QString v = var;
+        if ( v.at(0) == '@' ) {
+            v = var.mid(1);
+        }
+        if ( !runs->params().contains(v) ) {
+            fprintf(stderr, "koviz [error]: Cannot find var=\"%s\" "
+                            "from -vars option.  Run(s) do not contain "
+                            "this variable.\n",
+                            var.toLatin1().constData());
+            exit(-1);
+        }
+    }
+    int i = 0;
+    QStandardItem* pageItem = 0;
+    QModelIndex plotIdx;
+    foreach ( QString var, vars ) {
+        if ( i > 0 && var.at(0) == '@' ) {
+            // If var begins with @, place on same plot as last var
+            QModelIndex pageIdx = pageItem->index();
+            QModelIndex plotsIdx = bookModel->getIndex(pageIdx,
+                                                        "Plots","Page");
+            int nplots = bookModel->rowCount(plotsIdx);
+            plotIdx = bookModel->index(nplots-1,0,plotsIdx);
+            QModelIndex curvesIdx = bookModel->getIndex(plotIdx,
+                                                 "Curves", "Plot");
+            QString v = var.mid(1);
+            bookModel->createCurves(curvesIdx,timeName,v,
+                                    unitOverridesList, 0,0);
+
+            // Set y axis label to empty string (since multiple vars)
+            QModelIndex yAxisLabelIdx = bookModel->getDataIndex(plotIdx,
+                                               "PlotYAxisLabel","Plot");
+            bookModel->setData(yAxisLabelIdx, "");
+        } else {
+            if ( i%6 == 0 ) {
+                pageItem = bookModel->createPageItem();
+            }
+
+            QStandardItem* plotItem = bookModel->createPlotItem(
+                                                  pageItem,
+                                                  timeName,
+                                                  var.trimmed(),
+                                                  unitOverridesList,0);
+            plotIdx = plotItem->index();
+            ++i;
+        }
+
+        // Presentation
+        QModelIndex presIdx = bookModel->getDataIndex(plotIdx,
+                                            "PlotPresentation", "Plot");
+        if ( runs->runDirs().size() == 2 ) {
+            QModelIndex curvesIdx = bookModel->getIndex(plotIdx,
+                                                       "Curves","Plot");
+            QModelIndexList curveIdxs = bookModel->getIndexList(
+                                            curvesIdx,"Curve","Curves");
+            if ( curveIdxs.size() == 2 && !presentation.isEmpty()) {
+                bookModel->setData(presIdx,presentation);
+                QRectF bbox = bookModel->calcCurvesBBox(curvesIdx);
+                bookModel->setPlotMathRect(bbox,plotIdx);
+            }
+        }
+    }
+}
+
+void printPdfProgress(int nPagesDone, int nPages, void* data)
+{
+    Q_UNUSED(data);
+    fprintf(stderr, "koviz [debug]: printed pdf page %d of %d\n",
+            nPagesDone, nPages);
+}
+
 void preset_start(double* time, double new_time, bool* ok)
 {
     *ok = true;
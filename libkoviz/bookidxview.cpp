@@ -806,14 +806,8 @@ void BookIdxView::__paintSymbol(const QPointF& p,
 void BookIdxView::_paintGrid(QPainter &painter, const QModelIndex& plotIdx)
 {
     // If Grid DNE or off or math rect is zero, do not paint grid
-    bool isGrid = _bookModel()->isChildIndex(plotIdx,"Plot","PlotGrid");
-    if ( !isGrid ) {
-        return;
-    }
-    QModelIndex isGridIdx = _bookModel()->getDataIndex(plotIdx,
-                                                       "PlotGrid","Plot");
-    isGrid = _bookModel()->data(isGridIdx).toBool();
-    if ( !isGrid ) {
+    PlotProps plotProps = _bookModel()->plotProps(plotIdx);
+    if ( !plotProps.isGrid ) {
         return;
     }
     const QRectF M = _mathRect();
@@ -821,12 +815,8 @@ void BookIdxView::_paintGrid(QPainter &painter, const QModelIndex& plotIdx)
         return;
     }
 
-    QString plotXScale = _bookModel()->getDataString(plotIdx,
-                                                     "PlotXScale","Plot");
-    QString plotYScale = _bookModel()->getDataString(plotIdx,
-                                                     "PlotYScale","Plot");
-    bool isXLogScale = ( plotXScale == "log" ) ? true : false;
-    bool isYLogScale = ( plotYScale == "log" ) ? true : false;
+    bool isXLogScale = plotProps.isXLogScale;
+    bool isYLogScale = plotProps.isYLogScale;
 
     QList<double> xtics = _bookModel()->majorXTics(plotIdx);
     if ( isXLogScale ) {
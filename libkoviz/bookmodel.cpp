@@ -1,5 +1,7 @@
 #include "bookmodel.h"
 #include <float.h>
+#include <QCoreApplication>
+#include <stdexcept>
 #include "unit.h"
 
 PlotBookModel::PlotBookModel(const QStringList& timeNames,
@@ -23,12 +25,29 @@ PlotBookModel::PlotBookModel(const QStringList& timeNames,
 
 PlotBookModel::~PlotBookModel()
 {
-    foreach ( QPainterPath* path, _curve2path.values() ) {
-        if ( path ) {
-            delete path;
+    // Stop curve jobs before the curve models go away
+    foreach ( CurvePointsJob* job, _curveJobs ) {
+        job->cancel();
+    }
+    _curvePool.clear();
+    _curvePool.waitForDone();
+    foreach ( CurvePointsJob* job, _curveJobs ) {
+        delete job;
+    }
+    _curveJobs.clear();
+    _curve2job.clear();
+    delete _pendingPoints;
+
+    foreach ( CurvePoints* points, _curve2points.values() ) {
+        if ( points ) {
+            delete points;
         }
     }
-    _curve2path.clear();
+    _curve2points.clear();
+    foreach ( CurveLOD* lod, _curve2lod.values() ) {
+        delete lod;
+    }
+    _curve2lod.clear();
 
     foreach ( QModelIndex pageIdx, pageIdxs() ) {
         foreach ( QModelIndex plotIdx, plotIdxs(pageIdx) ) {
@@ -44,13 +63,19 @@ PlotBookModel::~PlotBookModel()
 bool PlotBookModel::setData(const QModelIndex &idx,
                             const QVariant &value, int role)
 {
-    // If setting curve data, for speed, cache a painterpath out of curve model
+    // If setting curve data, for speed, cache curve points out of curve model
     if ( idx.column() == 1 ) {
         QModelIndex tagIdx = sibling(idx.row(),0,idx);
         QString tag = data(tagIdx).toString();
         if ( tag == "CurveData" ) {
             CurveModel* curveModel = QVariantToPtr<CurveModel>::convert(value);
             QModelIndex curveIdx = idx.parent();
+            CurveModel* prevModel = QVariantToPtr<CurveModel>::convert(
+                                                                    data(idx));
+            if ( prevModel && prevModel != curveModel ) {
+                // Callers delete the replaced model, so its job must be done
+                _cancelCurvePointsJob(prevModel);
+            }
             _createPainterPath(curveIdx,
                                false,0,false,0,false,0,
                                false,0,false,0,false,0,
@@ -141,7 +166,15 @@ bool PlotBookModel::setData(const QModelIndex &idx,
         }
     }
 
-    return QStandardItemModel::setData(idx,value,role);
+    bool ret = QStandardItemModel::setData(idx,value,role);
+
+    // Tags are often set with signals blocked, so cached props are not
+    // left to dataChanged
+    if ( idx.parent().isValid() ) {
+        _invalidateProps(idx.parent());
+    }
+
+    return ret;
 }
 
 void PlotBookModel::setPlotMathRect(const QRectF& mathRect,
@@ -158,6 +191,46 @@ void PlotBookModel::setPlotMathRect(const QRectF& mathRect,
     setData(plotMathRectIdx, M);
 }
 
+// Same as CurvesView::dataChanged() does per view for another plot's rect
+void PlotBookModel::syncXTimePlots(const QModelIndex &plotIdx)
+{
+    if ( !isXTime(plotIdx) ) return;
+
+    QRectF M = data(getDataIndex(plotIdx,"PlotMathRect","Plot")).toRectF();
+    QString M_PlotXScale = getDataString(plotIdx,"PlotXScale","Plot");
+
+    foreach ( QModelIndex pageIdx, pageIdxs() ) {
+        foreach ( QModelIndex idx, plotIdxs(pageIdx) ) {
+            if ( idx == plotIdx || !isXTime(idx) ) continue;
+
+            QModelIndex plotRectIdx = getDataIndex(idx,"PlotMathRect","Plot");
+            QRectF R = data(plotRectIdx).toRectF();
+            QRectF N = M;
+            QString R_PlotXScale = getDataString(idx,"PlotXScale","Plot");
+            if ( M_PlotXScale == "log" && R_PlotXScale == "linear" ) {
+                N.setLeft(pow(10,N.left()));
+                N.setRight(pow(10,N.right()));
+            } else if ( M_PlotXScale == "linear" && R_PlotXScale == "log") {
+                if ( N.left() != 0.0 ) {
+                    N.setLeft(log10(N.left()));
+                }
+                if ( N.right() != 0.0 ) {
+                    N.setRight(log10(N.right()));
+                }
+            }
+            if ( N.left() != R.left() || N.right() != R.right() ) {
+                R.setLeft(N.left());
+                R.setRight(N.right());
+                double xMin = getDataDouble(idx,"PlotXMinRange","Plot");
+                double xMax = getDataDouble(idx,"PlotXMaxRange","Plot");
+                if ( R.left() >= xMin && R.right() <= xMax ) {
+                    setPlotMathRect(R,idx);
+                }
+            }
+        }
+    }
+}
+
 QStandardItem *PlotBookModel::addChild(QStandardItem *parentItem,
                                        const QString &childTitle,
                                        const QVariant &childValue)
@@ -395,11 +468,48 @@ QRectF PlotBookModel::getPlotMathRect(const QModelIndex &plotIdx) const
 
 void PlotBookModel::_initModel()
 {
+    _isAsyncCurves = false;
+    _isCreatingCurves = false;
+    _isPrinting = false;
+    _isGrowPending = false;
+    _pendingPoints = new CurvePoints;
+
     setColumnCount(2);
     QStandardItem *rootItem = invisibleRootItem();
 
     addChild(rootItem, "Pages","");
     addChild(rootItem, "Tables","");
+
+    connect(this,SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+            this,SLOT(_propsDataChanged(QModelIndex,QModelIndex)));
+    connect(this,SIGNAL(rowsInserted(QModelIndex,int,int)),
+            this,SLOT(_propsRowsInserted(QModelIndex,int,int)));
+    connect(this,SIGNAL(rowsRemoved(QModelIndex,int,int)),
+            this,SLOT(_clearProps()));
+    connect(this,SIGNAL(modelReset()),
+            this,SLOT(_clearProps()));
+}
+
+// Root items, in the order they are added (see koviz main.cpp)
+static QHash<QString,int> _createRootRows()
+{
+    QStringList tags;
+    tags << "Pages" << "Tables" << "DefaultPageTitles" << "LiveCoordTime"
+         << "LiveCoordTimeIndex" << "StartTime" << "StopTime"
+         << "Presentation" << "IsShowLiveCoord" << "RunToShiftHash"
+         << "LegendLabels" << "Orientation" << "TimeMatchTolerance"
+         << "Frequency" << "IsLegend" << "LegendColors" << "ForegroundColor"
+         << "BackgroundColor" << "Linestyles" << "Symbolstyles" << "Groups"
+         << "StatusBarMessage" << "IsShowPageTitle" << "IsShowPlotLegend"
+         << "PlotLegendPosition" << "ButtonSelectAndPan" << "ButtonZoom"
+         << "ButtonReset" << "XAxisLabel" << "YAxisLabel" << "IsPrintExact"
+         << "EnsembleStats";
+
+    QHash<QString,int> rows;
+    for ( int i = 0; i < tags.size(); ++i ) {
+        rows.insert(tags.at(i),i);
+    }
+    return rows;
 }
 
 //
@@ -462,83 +572,24 @@ QModelIndex PlotBookModel::getIndex(const QModelIndex &startIdx,
     }
 
     if ( !startIdx.isValid() ) {
-        if ( searchItemText == "Pages" ) {
-            idx = index(0,0);
-        } else if ( searchItemText == "Tables" ) {
-            idx = index(1,0);
-        } else if ( searchItemText == "DefaultPageTitles" ) {
-            idx = index(2,0);
-        } else if ( searchItemText == "LiveCoordTime" ) {
-            idx = index(3,0);
-        } else if ( searchItemText == "LiveCoordTimeIndex" ) {
-            idx = index(4,0);
-        } else if ( searchItemText == "StartTime" ) {
-            idx = index(5,0);
-        } else if ( searchItemText == "StopTime" ) {
-            idx = index(6,0);
-        } else if ( searchItemText == "Presentation" ) {
-            idx = index(7,0);
-        } else if ( searchItemText == "IsShowLiveCoord" ) {
-            idx = index(8,0);
-        } else if ( searchItemText == "RunToShiftHash" ) {
-            idx = index(9,0);
-        } else if ( searchItemText == "LegendLabels" ) {
-            idx = index(10,0);
-        } else if ( searchItemText == "Orientation" ) {
-            idx = index(11,0);
-        } else if ( searchItemText == "TimeMatchTolerance" ) {
-            idx = index(12,0);
-        } else if ( searchItemText == "Frequency" ) {
-            idx = index(13,0);
-        } else if ( searchItemText == "IsLegend" ) {
-            idx = index(14,0);
-        } else if ( searchItemText == "LegendColors" ) {
-            idx = index(15,0);
-        } else if ( searchItemText == "ForegroundColor" ) {
-            idx = index(16,0);
-        } else if ( searchItemText == "BackgroundColor" ) {
-            idx = index(17,0);
-        } else if ( searchItemText == "Linestyles" ) {
-            idx = index(18,0);
-        } else if ( searchItemText == "Symbolstyles" ) {
-            idx = index(19,0);
-        } else if ( searchItemText == "Groups" ) {
-            idx = index(20,0);
-        } else if ( searchItemText == "StatusBarMessage" ) {
-            idx = index(21,0);
-        } else if ( searchItemText == "IsShowPageTitle" ) {
-            idx = index(22,0);
-        } else if ( searchItemText == "IsShowPlotLegend" ) {
-            idx = index(23,0);
-        } else if ( searchItemText == "PlotLegendPosition" ) {
-            idx = index(24,0);
-        } else if ( searchItemText == "ButtonSelectAndPan" ) {
-            idx = index(25,0);
-        } else if ( searchItemText == "ButtonZoom" ) {
-            idx = index(26,0);
-        } else if ( searchItemText == "ButtonReset" ) {
-            idx = index(27,0);
-        } else if ( searchItemText == "XAxisLabel" ) {
-            idx = index(28,0);
-        } else if ( searchItemText == "YAxisLabel" ) {
-            idx = index(29,0);
-        } else {
+        static const QHash<QString,int> rootRows = _createRootRows();
+        int row = rootRows.value(searchItemText,-1);
+        if ( row < 0 ) {
             fprintf(stderr,"koviz [bad scoobs]:3: getIndex() received "
                            "root as a startIdx and had bad child "
                            "item text of \"%s\".\n",
                            searchItemText.toLatin1().constData());
             exit(-1);
         }
+        idx = index(row,0);
     } else {
-        QStringList cStrings;
-        int rc = itemFromIndex(startIdx)->rowCount();
+        QStandardItem* startItem = itemFromIndex(startIdx);
+        int rc = startItem->rowCount();
         bool isFound = false;
         for ( int i = 0; i < rc; ++i ) {
-            QModelIndex cIdx = index(i,0,startIdx);
-            QString cText = itemFromIndex(cIdx)->text();
-            cStrings << cText;
-            if ( cText == searchItemText ) {
-                idx = cIdx;
+            QStandardItem* cItem = startItem->child(i);
+            if ( cItem && cItem->text() == searchItemText ) {
+                idx = cItem->index();
                 isFound = true;
                 break;
             }
@@ -739,29 +790,330 @@ CurveModel *PlotBookModel::getCurveModel(const QModelIndex &curveIdx) const
     return curveModel;
 }
 
-QPainterPath* PlotBookModel::getPainterPath(const QModelIndex &curveIdx) const
+CurvePoints* PlotBookModel::getCurvePoints(const QModelIndex &curveIdx) const
 {
-    QPainterPath* path;
+    CurvePoints* points;
 
     CurveModel* curveModel = getCurveModel(curveIdx);
 
-    if ( _curve2path.contains(curveModel) ) {
-        path = _curve2path.value(curveModel);
+    if ( _curve2points.contains(curveModel) ) {
+        points = _curve2points.value(curveModel);
+    } else if ( _curve2job.contains(curveModel) ) {
+        points = _pendingPoints; // points are being built on a pool thread
     } else {
         fprintf(stderr,"koviz [bad scoobs]: "
-                       "PlotBookModel::getCurvePainterPath()\n");
+                       "PlotBookModel::getCurvePoints()\n");
         exit(-1);
     }
 
-    return path;
+    return points;
+}
+
+CurveLOD* PlotBookModel::getCurveLOD(const QModelIndex &curveIdx) const
+{
+    CurveModel* curveModel = getCurveModel(curveIdx);
+    return _curve2lod.value(curveModel,0);
+}
+
+CurveProps PlotBookModel::curveProps(const QModelIndex &curveIdx) const
+{
+    const QStandardItem* item = itemFromIndex(curveIdx);
+    QMutexLocker locker(&_propsMutex);
+    if ( _curveProps.contains(item) ) {
+        return _curveProps.value(item);
+    }
+
+    CurveProps props;
+    props.curveModel = getCurveModel(curveIdx);
+    props.color = QColor(getDataString(curveIdx,"CurveColor","Curve"));
+    props.lineStyle = getDataString(curveIdx,
+                                    "CurveLineStyle","Curve").toLower();
+    props.linePattern = getLineStylePattern(props.lineStyle);
+    props.symbolStyle = getDataString(curveIdx,
+                                      "CurveSymbolStyle","Curve").toLower();
+    props.runID = getDataInt(curveIdx,"CurveRunID","Curve");
+    props.xScale = xScale(curveIdx,props.curveModel);
+    props.xBias = xBias(curveIdx,props.curveModel);
+    props.yScale = yScale(curveIdx);
+    props.yBias = yBias(curveIdx);
+
+    _curveProps.insert(item,props);
+    return props;
+}
+
+PlotProps PlotBookModel::plotProps(const QModelIndex &plotIdx) const
+{
+    const QStandardItem* item = itemFromIndex(plotIdx);
+    QMutexLocker locker(&_propsMutex);
+    if ( _plotProps.contains(item) ) {
+        return _plotProps.value(item);
+    }
+
+    PlotProps props;
+    props.xScale = getDataString(plotIdx,"PlotXScale","Plot");
+    props.yScale = getDataString(plotIdx,"PlotYScale","Plot");
+    props.isXLogScale = ( props.xScale == "log" );
+    props.isYLogScale = ( props.yScale == "log" );
+    if ( isChildIndex(plotIdx,"Plot","PlotGrid") ) {
+        props.isGrid = getDataBool(plotIdx,"PlotGrid","Plot");
+    }
+    props.presentation = getDataString(plotIdx,"PlotPresentation","Plot");
+
+    _plotProps.insert(item,props);
+    return props;
+}
+
+// A tag's parent is the curve or plot whose props hold its value
+void PlotBookModel::_invalidateProps(const QModelIndex &idx)
+{
+    const QStandardItem* item = itemFromIndex(idx);
+    QMutexLocker locker(&_propsMutex);
+    _curveProps.remove(item);
+    _plotProps.remove(item);
+}
+
+void PlotBookModel::_propsDataChanged(const QModelIndex &topLeft,
+                                      const QModelIndex &bottomRight)
+{
+    Q_UNUSED(bottomRight);
+    if ( topLeft.parent().isValid() ) {
+        _invalidateProps(topLeft.parent());
+    }
+}
+
+void PlotBookModel::_propsRowsInserted(const QModelIndex &pidx,
+                                       int start, int end)
+{
+    Q_UNUSED(start);
+    Q_UNUSED(end);
+    if ( pidx.isValid() ) {
+        _invalidateProps(pidx);
+    }
+}
+
+// Removed items may be freed and their addresses reused
+void PlotBookModel::_clearProps()
+{
+    QMutexLocker locker(&_propsMutex);
+    _curveProps.clear();
+    _plotProps.clear();
+}
+
+void PlotBookModel::setAsyncCurves(bool isAsync)
+{
+    _isAsyncCurves = isAsync;
+}
+
+bool PlotBookModel::isCurvePointsPending(const QModelIndex &curveIdx) const
+{
+    CurveModel* curveModel = getCurveModel(curveIdx);
+    return ( !_curve2points.contains(curveModel) &&
+              _curve2job.contains(curveModel) );
+}
+
+// Pending curve jobs that are not on pageIdx are canceled (and parked)
+// so the pool works on what the user is looking at.  Parked jobs on
+// pageIdx are restarted.
+void PlotBookModel::setCurvesPriorityPage(const QModelIndex &pageIdx)
+{
+    _curvesPriorityPageIdx = pageIdx;
+
+    foreach ( CurvePointsJob* job, _curve2job.values() ) {
+        if ( job->pageIdx() == pageIdx ) {
+            if ( job->isDeferred() ) {
+                _startCurvePointsJob(job);
+            } else {
+                job->uncancel();
+            }
+        } else if ( !job->isDeferred() ) {
+            job->cancel();
+        }
+    }
+}
+
+// Block until every pending curve has its points (e.g. before printing)
+void PlotBookModel::waitForCurves()
+{
+    _curvesPriorityPageIdx = QModelIndex();
+    foreach ( CurvePointsJob* job, _curve2job.values() ) {
+        if ( job->isDeferred() ) {
+            _startCurvePointsJob(job);
+        } else {
+            job->uncancel();
+        }
+    }
+
+    while ( !_curve2job.isEmpty() ) {
+        _curvePool.waitForDone();
+        // Deliver queued finished() signals, canceled jobs get rerun
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+}
+
+void PlotBookModel::_startCurvePointsJob(CurvePointsJob *job)
+{
+    job->uncancel();
+    job->setDeferred(false);
+    _curvePool.start(job);
+}
+
+CurvePointsJob* PlotBookModel::_takeCurvePointsJob(CurveModel *curveModel)
+{
+    CurvePointsJob* job = _curve2job.take(curveModel);
+    if ( job ) {
+        QPersistentModelIndex plotIdx(job->plotIdx());
+        int cnt = _plot2pendingCnt.value(plotIdx,0)-1;
+        if ( cnt > 0 ) {
+            _plot2pendingCnt.insert(plotIdx,cnt);
+        } else {
+            _plot2pendingCnt.remove(plotIdx);
+        }
+    }
+    return job;
+}
+
+// The job's finished() still arrives and the slot throws it away
+void PlotBookModel::_cancelCurvePointsJob(CurveModel *curveModel)
+{
+    CurvePointsJob* job = _takeCurvePointsJob(curveModel);
+    if ( job ) {
+        job->cancel();
+        job->wait();
+        if ( job->isDeferred() ) {
+            // Already finished and parked, no signal is coming
+            _curveJobs.removeOne(job);
+            delete job;
+        }
+    }
 }
 
-// TODO: cache error path if it's not changing
-QPainterPath *PlotBookModel::getCurvesErrorPath(const QModelIndex &curvesIdx)
+void PlotBookModel::_curvePointsJobFinished()
 {
-    QPainterPath* path;
-    path = _createCurvesErrorPath(curvesIdx);
-    return path;
+    CurvePointsJob* job = qobject_cast<CurvePointsJob*>(sender());
+    if ( !job ) return;
+
+    CurveModel* curveModel = job->curveModel();
+    if ( _curve2job.value(curveModel,0) != job ) {
+        // Stale (curve data was replaced or recalculated)
+        _curveJobs.removeOne(job);
+        job->deleteLater();
+        return;
+    }
+
+    QModelIndex curveIdx = job->curveIdx();
+    if ( !curveIdx.isValid() ) {
+        // Curve was removed from the book while the job ran
+        _takeCurvePointsJob(curveModel);
+        _curveJobs.removeOne(job);
+        job->deleteLater();
+        return;
+    }
+
+    if ( !job->hasResult() ) {
+        // Canceled by a page switch
+        if ( !_curvesPriorityPageIdx.isValid() ||
+             job->pageIdx() == _curvesPriorityPageIdx ) {
+            _startCurvePointsJob(job);
+        } else {
+            job->setDeferred(true);
+        }
+        return;
+    }
+
+    // Install points and the level of detail pyramid
+    _takeCurvePointsJob(curveModel);
+    _curveJobs.removeOne(job);
+    if ( _curve2lod.contains(curveModel) ) {
+        delete _curve2lod.take(curveModel);
+    }
+    if ( _curve2points.contains(curveModel) ) {
+        delete _curve2points.take(curveModel);
+    }
+    _curve2points.insert(curveModel,job->takePoints());
+    _curve2lod.insert(curveModel,job->takeLOD());
+    _curve2nrows.insert(curveModel,job->nrows());
+    job->deleteLater();
+    curveModel->unmap(); // the job's pin kept it mapped
+
+    // Signal views, this may be during a createCurves() with signals off
+    bool block = blockSignals(false);
+    QModelIndex curveDataIdx = getDataIndex(curveIdx,"CurveData","Curve");
+    emit dataChanged(curveDataIdx,curveDataIdx);
+
+    // Once a plot's last curve lands, redo its math rect unless the user
+    // has zoomed or panned in the meantime
+    QPersistentModelIndex plotIdx(job->plotIdx());
+    if ( !_plot2pendingCnt.contains(plotIdx) &&
+         _plot2pendingRect.contains(plotIdx) ) {
+        QRectF R = _plot2pendingRect.take(plotIdx);
+        if ( getPlotMathRect(plotIdx) == R ) {
+            _initPlotMathRect(getIndex(plotIdx,"Curves","Plot"));
+        }
+    }
+    blockSignals(block);
+}
+
+void PlotBookModel::growCurves()
+{
+    if ( _isPrinting ) {
+        _isGrowPending = true;
+        return;
+    }
+
+    foreach ( QModelIndex pageIdx, pageIdxs() ) {
+        foreach ( QModelIndex plotIdx, plotIdxs(pageIdx) ) {
+            QModelIndex curvesIdx = getIndex(plotIdx,"Curves","Plot");
+            QModelIndexList grownCurveIdxs;
+            foreach ( QModelIndex curveIdx, curveIdxs(curvesIdx) ) {
+                CurveModel* curveModel = getCurveModel(curveIdx);
+                if ( !curveModel || _curve2job.contains(curveModel) ||
+                     !_curve2nrows.contains(curveModel) ) {
+                    continue; // points are still being made
+                }
+                if ( _curve2nrows.value(curveModel) < curveModel->rowCount() ) {
+                    grownCurveIdxs << curveIdx;
+                }
+            }
+            if ( grownCurveIdxs.isEmpty() ) {
+                continue;
+            }
+
+            QRectF R = getPlotMathRect(plotIdx);
+            QRectF bbox = calcCurvesBBox(curvesIdx);
+            bool isFollowing = ( R.right() >= bbox.right() );
+
+            foreach ( QModelIndex curveIdx, grownCurveIdxs ) {
+                _createPainterPath(curveIdx,
+                                   false,0,false,0,false,0,
+                                   false,0,false,0,false,0,
+                                   "","","","",0,true);
+                QModelIndex curveDataIdx = getDataIndex(curveIdx,
+                                                        "CurveData","Curve");
+                emit dataChanged(curveDataIdx,curveDataIdx);
+            }
+
+            if ( isFollowing ) {
+                _initPlotMathRect(curvesIdx);
+            }
+        }
+    }
+}
+
+void PlotBookModel::setPrinting(bool isPrinting)
+{
+    _isPrinting = isPrinting;
+    if ( !_isPrinting && _isGrowPending ) {
+        _isGrowPending = false;
+        growCurves();
+    }
+}
+
+// TODO: cache error points if they're not changing
+CurvePoints *PlotBookModel::getCurvesErrorPoints(const QModelIndex &curvesIdx)
+{
+    CurvePoints* points;
+    points = _createCurvesErrorPoints(curvesIdx);
+    return points;
 }
 
 QModelIndexList PlotBookModel::getIndexList(const QModelIndex &startIdx,
@@ -988,6 +1340,67 @@ double PlotBookModel::yBias(const QModelIndex &curveIdx) const
     return yb;
 }
 
+// Bounding box of a curve's logged data from cached column stats, so
+// no curve points are needed.  Only valid when points are the raw data
+// i.e. linear plot scales with no time window or frequency.  Otherwise,
+// or if the curve has no finite data, a null rect is returned.
+QRectF PlotBookModel::_curveStatsBBox(const QModelIndex &curveIdx) const
+{
+    QRectF bbox;
+
+    QModelIndex plotIdx = curveIdx.parent().parent();
+    if ( getDataString(plotIdx,"PlotXScale","Plot") != "linear" ||
+         getDataString(plotIdx,"PlotYScale","Plot") != "linear" ) {
+        return bbox;
+    }
+    if ( isChildIndex(QModelIndex(),"","StartTime") &&
+         getDataDouble(QModelIndex(),"StartTime") != -DBL_MAX ) {
+        return bbox;
+    }
+    if ( isChildIndex(QModelIndex(),"","StopTime") &&
+         getDataDouble(QModelIndex(),"StopTime") != DBL_MAX ) {
+        return bbox;
+    }
+    if ( isChildIndex(QModelIndex(),"","Frequency") &&
+         getDataDouble(QModelIndex(),"Frequency") > 0.0 ) {
+        return bbox;
+    }
+
+    CurveModel* curveModel = getCurveModel(curveIdx);
+    if ( !curveModel ) {
+        return bbox;
+    }
+    curveModel->map();
+    ColumnStats xStats = curveModel->xStats();
+    ColumnStats yStats = curveModel->yStats();
+    curveModel->unmap();
+
+    if ( !xStats.isEmpty() && !yStats.isEmpty() ) {
+        bbox = QRectF(xStats.min,yStats.min,
+                      xStats.max-xStats.min,yStats.max-yStats.min);
+    }
+
+    return bbox;
+}
+
+// True if the curve has no finite y data, so its points must be empty.
+// Column stats answer this without building the points.
+bool PlotBookModel::isCurveDataEmpty(const QModelIndex &curveIdx) const
+{
+    CurveModel* curveModel = getCurveModel(curveIdx);
+    if ( !curveModel ) {
+        return true;
+    }
+    if ( _curve2points.contains(curveModel) ) {
+        return _curve2points.value(curveModel)->isEmpty();
+    }
+    curveModel->map();
+    bool isEmpty = curveModel->yStats().isEmpty();
+    curveModel->unmap();
+
+    return isEmpty;
+}
+
 QRectF PlotBookModel::calcCurvesBBox(const QModelIndex &curvesIdx) const
 {
     QRectF bbox;
@@ -1000,7 +1413,7 @@ QRectF PlotBookModel::calcCurvesBBox(const QModelIndex &curvesIdx) const
         int rc = rowCount(curvesIdx);
         for (int i = 0; i < rc; ++i) {
             QModelIndex curveIdx = index(i,0,curvesIdx);
-            QPainterPath* path = getPainterPath(curveIdx);
+            CurvePoints* points = getCurvePoints(curveIdx);
             double xb = 0.0;
             double yb = 0.0;
             double xs = 1.0;
@@ -1013,7 +1426,11 @@ QRectF PlotBookModel::calcCurvesBBox(const QModelIndex &curvesIdx) const
                 yb = yBias(curveIdx);
                 ys = yScale(curveIdx);
             }
-            QRectF pathBox = path->boundingRect();
+            QRectF pathBox = points->boundingRect();
+            if ( points->isEmpty() && isCurvePointsPending(curveIdx) ) {
+                // Stand in column stats until the curve's points land
+                pathBox = _curveStatsBBox(curveIdx);
+            }
             double w = pathBox.width();
             double h = pathBox.height();
             QPointF topLeft(xs*pathBox.topLeft().x()+xb,
@@ -1022,14 +1439,14 @@ QRectF PlotBookModel::calcCurvesBBox(const QModelIndex &curvesIdx) const
             bbox = bbox.united(scaledPathBox);
         }
         if ( presentation == "error+compare" ) {
-            QPainterPath* errorPath = _createCurvesErrorPath(curvesIdx);
-            bbox = bbox.united(errorPath->boundingRect());
-            delete errorPath;
+            CurvePoints* errorPoints = _createCurvesErrorPoints(curvesIdx);
+            bbox = bbox.united(errorPoints->boundingRect());
+            delete errorPoints;
         }
     } else if ( presentation == "error" ) {
-        QPainterPath* errorPath = _createCurvesErrorPath(curvesIdx);
-        bbox = errorPath->boundingRect();
-        delete errorPath;
+        CurvePoints* errorPoints = _createCurvesErrorPoints(curvesIdx);
+        bbox = errorPoints->boundingRect();
+        delete errorPoints;
     } else {
         fprintf(stderr,"koviz [bad scoobs]: PlotBookModel::calcCurvesBBox()\n");
         exit(-1);
@@ -1106,70 +1523,138 @@ QRectF PlotBookModel::calcCurvesBBox(const QModelIndex &curvesIdx) const
     return bbox;
 }
 
-// Note 1:
-//   No scaling or bias is done for linear plot scale since it is done
-//   via the paint transform. For log scale, the path is scaled/biased.
-// Note 2:
-//   For the live coord to work, every point in the curve model
-//   must have an associated point in the path.  There are two issues.
-//         1) If the model point is close to or the same as the previously
-//            added point, Qt will not add the point to the path
-//         2) If the model point is a NAN, Qt will not add the point to
-//            the path
-//   A trick I did to force Qt to draw successive identical points
-//   or points that are very close to one another is to
-//   add a different point (+1.0) and then change the point i.e.:
-//                    // Add (x,y) twice to path in succession
-//                    path->lineTo(x,y);
-//                    path->lineTo(x+1.0,y+1.0);
-//                    int n = path->elementCount();
-//                    path->setElementPositionAt(n-1,x,y);
-//   The trick for NANs is to add a point to the path that is already on the
-//   path.  If the model has points [(0,7),(1,3),(2,4),(3,nan),(4,8)], the path
-//   should skip from (2,4) to (4,8).  To make that happen, replace (3,nan)
-//   with (2,4).  The extra (2,4) point keeps model to path one-to-one and is
-//   effectively the same path (a drawback is that the duplicated point is
-//   sticky).
-//
-//   If all points in the curve model are nans, no points will be added to
-//   the path, so the returned path is empty.  The plot will show up as "Empty".
-//   This happens, for example, when a motion capture marker is never viewable,
-//   the plot of the marker position will show up as "Empty" since there are
-//   no valid points in the marker trajectory.
-QPainterPath* PlotBookModel::__createPainterPath(CurveModel *curveModel,
+CurvePoints* PlotBookModel::__createCurvePoints(CurveModel *curveModel,
                                                double startTime,double stopTime,
                                                double xs, double xb,
                                                double ys, double yb,
                                                const QString &plotXScale,
                                                const QString &plotYScale)
 {
-    QPainterPath* path = new QPainterPath;
+    bool isXLogScale = ( plotXScale == "log" ) ? true : false;
+    bool isYLogScale = ( plotYScale == "log" ) ? true : false;
+    double f = getDataDouble(QModelIndex(),"Frequency");
 
     curveModel->map();
+    CurvePoints* points = _calcCurvePoints(curveModel,startTime,stopTime,
+                                           xs,xb,ys,yb,
+                                           isXLogScale,isYLogScale,f);
+    curveModel->unmap();
 
-    ModelIterator* it = curveModel->begin();
-
-    bool isXLogScale = ( plotXScale == "log" ) ? true : false;
-    bool isYLogScale = ( plotYScale == "log" ) ? true : false;
+    return points;
+}
 
-    double f = getDataDouble(QModelIndex(),"Frequency");
-    bool isFirst = true;
+// Note 1:
+//   No scaling or bias is done for linear plot scale since it is done
+//   via the paint transform. For log scale, the points are scaled/biased.
+// Note 2:
+//   For the live coord to work, every point in the curve model
+//   must have an associated curve point.  CurvePoints stores every
+//   appended point, so the only issue is model points that are NANs.
+//   The trick for NANs is to add a point that is already on the curve.
+//   If the model has points [(0,7),(1,3),(2,4),(3,nan),(4,8)], the curve
+//   should skip from (2,4) to (4,8).  To make that happen, replace (3,nan)
+//   with (2,4).  The extra (2,4) point keeps model to points one-to-one and
+//   is effectively the same curve (a drawback is that the duplicated point
+//   is sticky).  Leading NANs are replaced with the first good point.
+//
+//   If all points in the curve model are nans, no points will be added,
+//   so the returned points are empty.  The plot will show up as "Empty".
+//   This happens, for example, when a motion capture marker is never viewable,
+//   the plot of the marker position will show up as "Empty" since there are
+//   no valid points in the marker trajectory.
+//
+// Thread safe, the caller maps (or pins) the curve model.
+// If isCancel is set while building, the partial points are returned.
+CurvePoints* PlotBookModel::_calcCurvePoints(const CurveModel *curveModel,
+                                             double startTime, double stopTime,
+                                             double xs, double xb,
+                                             double ys, double yb,
+                                             bool isXLogScale, bool isYLogScale,
+                                             double f,
+                                             const QAtomicInt* isCancel)
+{
+    CurvePoints* points = new CurvePoints;
+
+    // Seek to the [startTime,stopTime] window instead of walking the
+    // whole log (if rows are in time order).  A row of slop is kept on
+    // either side, the time check below trims it.
+    int nrows = curveModel->rowCount();
+    int rowBeg = 0;
+    int rowEnd = nrows;
+    bool isSeek = false;
+    if ( nrows > 0 && (startTime > -DBL_MAX || stopTime < DBL_MAX) ) {
+        isSeek = curveModel->tStats().isMonotonic;
+    }
+    if ( isSeek ) {
+        // Same index as indexAtTime(), safe on curve points workers
+        const TimeIndex* timeIndex = curveModel->timeIndex();
+        if ( startTime > -DBL_MAX ) {
+            int row = qMin(timeIndex->lowerBound(startTime),nrows);
+            rowBeg = qMax(row-1,0);
+        }
+        if ( stopTime < DBL_MAX ) {
+            rowEnd = qMin(timeIndex->upperBound(stopTime)+1,nrows);
+        }
+    }
+
+    points->reserve(qMax(rowEnd-rowBeg,0));
+    _appendCurvePoints(points,curveModel,rowBeg,rowEnd,startTime,stopTime,
+                       xs,xb,ys,yb,isXLogScale,isYLogScale,f,isCancel);
+
+    // Frequency and time window may have skipped rows
+    points->squeeze();
+
+    return points;
+}
+
+// Appends curve points for model rows [rowBeg,rowEnd), see
+// _calcCurvePoints().  Also used to extend the points of a curve whose
+// model has grown (see growCurves()).
+void PlotBookModel::_appendCurvePoints(CurvePoints* points,
+                                       const CurveModel *curveModel,
+                                       int rowBeg, int rowEnd,
+                                       double startTime, double stopTime,
+                                       double xs, double xb,
+                                       double ys, double yb,
+                                       bool isXLogScale, bool isYLogScale,
+                                       double f,
+                                       const QAtomicInt* isCancel)
+{
+    bool isFirst = points->isEmpty();
     int cntNANs = 0;
-    while ( !it->isDone() ) {
-        double t = it->t();
+
+    // Pull the curve out of the model a chunk of rows at a time
+    const int chunkSize = 65536;
+    int bufSize = qMax(qMin(chunkSize,rowEnd-rowBeg),0);
+    QVector<double> tChunk(bufSize);
+    QVector<double> xChunk(bufSize);
+    QVector<double> yChunk(bufSize);
+    int chunkBeg = rowBeg;
+    int chunkEnd = rowBeg;
+    for ( int row = rowBeg; row < rowEnd; ++row ) {
+        if ( row == chunkEnd ) {
+            if ( isCancel && isCancel->load() ) {
+                break;
+            }
+            chunkBeg = row;
+            chunkEnd = qMin(row+chunkSize,rowEnd);
+            curveModel->values(chunkBeg,chunkEnd,
+                               tChunk.data(),xChunk.data(),yChunk.data());
+        }
+        int k = row-chunkBeg;
+
+        double t = tChunk.at(k);
         if ( f > 0.0 ) {
             if ( fabs(t-round(t/f)*f) > 1.0e-9 ) { // t not divisible by f?
-                it->next();
                 continue;
             }
         }
         if ( t < startTime || t > stopTime ) {
-            it->next();
             continue;
         }
 
-        double x = it->x();
-        double y = it->y();
+        double x = xChunk.at(k);
+        double y = yChunk.at(k);
 
         if ( isXLogScale ) {
             x = x*xs + xb;
@@ -1178,7 +1663,6 @@ QPainterPath* PlotBookModel::__createPainterPath(CurveModel *curveModel,
             } else if ( x < 0 ) {
                 x = log10(-x);
             } else if ( x == 0 ) {
-                it->next();
                 continue; // skip log(0) since -inf
             }
         }
@@ -1190,76 +1674,31 @@ QPainterPath* PlotBookModel::__createPainterPath(CurveModel *curveModel,
             } else if ( y < 0 ) {
                 y = log10(-y);
             } else if ( y == 0 ) {
-                it->next();
                 continue; // skip log(0) since -inf
             }
         }
 
-        if ( isFirst ) {
-            path->moveTo(x,y);
-            if ( path->elementCount() == 1 ) {
-                isFirst = false;
-                for ( int i = 0; i < cntNANs; ++i ) {
-                    // Beginning of path was nans
-                    // Add first good point to beginning of path cntNANs times
-                    int m = path->elementCount();
-                    path->lineTo(x+1.0,y+1.0); // see Note 2 at top of method
-                    int n = path->elementCount();
-                    if ( n > m ) {
-                        path->setElementPositionAt(n-1,x,y);
-                    } else {
-                        fprintf(stderr, "koviz [error]: __createPainterPath:1: "
-                                "could not add point (%g,%g)\n", x,y);
-                    }
-                }
-            } else {
-                // Point not added, probably a nan
-                // Count number nans that are at beginning of path
+        if ( !std::isfinite(x) || !std::isfinite(y) ) {
+            // See Note 2 at top of method
+            if ( isFirst ) {
                 ++cntNANs;
+            } else {
+                int n = points->count();
+                points->append(points->x(n-1),points->y(n-1));
             }
-        } else {
-            int m = path->elementCount();
-            path->lineTo(x,y);
-            int n = path->elementCount();
-            if ( m == n ) {
-                /* When points are very close to one another,
-                 * it looks like Qt will skip adding a lineTo(x,y).
-                 * This bit of code tries to force Qt to add the
-                 * lineTo(x,y) no matter how close the two points
-                 * are to one another.
-                 * See Note 2 at top of method for more details
-                 */
-                path->lineTo(x+1.0,y+1.0);
-                int o = path->elementCount();
-                if ( o > 0 ) {
-                    if ( o > m ) {
-                        path->setElementPositionAt(o-1,x,y);
-                    } else {
-                        // If that fails, more than likely x or y is nan
-                        // Draw a line from the last point to itself
-                        // See Note 2 at top of method for more details
-                        QPainterPath::Element el = path->elementAt(o-1);
-                        int i = path->elementCount();
-                        path->lineTo(el.x+1,el.y+1);
-                        int j = path->elementCount();
-                        if ( i < j ) {
-                            path->setElementPositionAt(j-1,el.x,el.y);
-                        } else {
-                            fprintf(stderr,
-                                    "koviz [error] : __createPainterPath:2:"
-                                    " could not add point (%g,%g)\n",el.x,el.y);
-                        }
-                    }
-                }
-            }
+            continue;
         }
 
-        it->next();
+        if ( isFirst ) {
+            isFirst = false;
+            for ( int i = 0; i < cntNANs; ++i ) {
+                // Beginning of curve was nans
+                // Add first good point to beginning cntNANs times
+                points->append(x,y);
+            }
+        }
+        points->append(x,y);
     }
-    delete it;
-    curveModel->unmap();
-
-    return path;
 }
 
 void PlotBookModel::_createPainterPath(const QModelIndex &curveIdx,
@@ -1273,7 +1712,8 @@ void PlotBookModel::_createPainterPath(const QModelIndex &curveIdx,
                                       const QString &yUnitIn,
                                       const QString &plotXScaleIn,
                                       const QString &plotYScaleIn,
-                                      CurveModel *curveModelIn)
+                                      CurveModel *curveModelIn,
+                                      bool isGrow)
 {
     QModelIndex plotIdx = curveIdx.parent().parent();
 
@@ -1391,39 +1831,92 @@ void PlotBookModel::_createPainterPath(const QModelIndex &curveIdx,
         }
     }
 
-    // Create path and cache it
-    if ( _curve2path.contains(curveModel) ) {
-        QPainterPath* currPath = _curve2path.value(curveModel);
-        delete currPath;
-        _curve2path.remove(curveModel);
-    }
-    QPainterPath* path = __createPainterPath(curveModel,
-                                            (start-tb)/ts,(stop-tb)/ts,
-                                             xs, xb, ys, yb,
-                                            plotXScale, plotYScale);
-    _curve2path.insert(curveModel,path);
+    if ( isGrow ) {
+        // Extend points with the rows the model gained (see growCurves())
+        CurvePoints* points = _curve2points.value(curveModel,0);
+        int nrows = curveModel->rowCount();
+        int rowBeg = _curve2nrows.value(curveModel,nrows);
+        if ( rowBeg >= nrows ) {
+            return;
+        }
+        if ( points && !points->isEmpty() ) {
+            bool isXLogScale = ( plotXScale == "log" ) ? true : false;
+            bool isYLogScale = ( plotYScale == "log" ) ? true : false;
+            double f = getDataDouble(QModelIndex(),"Frequency");
+            curveModel->map();
+            _appendCurvePoints(points,curveModel,rowBeg,nrows,
+                               (start-tb)/ts,(stop-tb)/ts,
+                               xs, xb, ys, yb,
+                               isXLogScale, isYLogScale, f);
+            curveModel->unmap();
+            _curve2lod.value(curveModel)->grow();
+            _curve2nrows.insert(curveModel,nrows);
+            return;
+        }
+        // Nothing plotted yet (e.g. all nans so far), so build it whole
+    }
+
+    // A job still building this curve's points is now out of date
+    _cancelCurvePointsJob(curveModel);
+
+    if ( _isAsyncCurves && _isCreatingCurves ) {
+        // Build points on the curve pool, placeholder until it finishes
+        bool isXLogScale = ( plotXScale == "log" ) ? true : false;
+        bool isYLogScale = ( plotYScale == "log" ) ? true : false;
+        double f = getDataDouble(QModelIndex(),"Frequency");
+        CurvePointsJob* job = new CurvePointsJob(curveIdx, curveModel,
+                                                 (start-tb)/ts,(stop-tb)/ts,
+                                                 xs, xb, ys, yb,
+                                                 isXLogScale, isYLogScale, f);
+        connect(job,SIGNAL(finished()),this,SLOT(_curvePointsJobFinished()));
+        _curveJobs.append(job);
+        _curve2job.insert(curveModel,job);
+        QPersistentModelIndex jobPlotIdx(plotIdx);
+        _plot2pendingCnt.insert(jobPlotIdx,
+                                _plot2pendingCnt.value(jobPlotIdx,0)+1);
+        _startCurvePointsJob(job);
+        return;
+    }
+
+    // Create points and cache them (along with their level of detail pyramid)
+    if ( _curve2lod.contains(curveModel) ) {
+        delete _curve2lod.value(curveModel);
+        _curve2lod.remove(curveModel);
+    }
+    if ( _curve2points.contains(curveModel) ) {
+        CurvePoints* currPoints = _curve2points.value(curveModel);
+        delete currPoints;
+        _curve2points.remove(curveModel);
+    }
+    CurvePoints* points = __createCurvePoints(curveModel,
+                                              (start-tb)/ts,(stop-tb)/ts,
+                                              xs, xb, ys, yb,
+                                              plotXScale, plotYScale);
+    _curve2points.insert(curveModel,points);
+    _curve2lod.insert(curveModel,new CurveLOD(points));
+    _curve2nrows.insert(curveModel,curveModel->rowCount());
 }
 
 // curveIdx0/1 are child indices of "Curves" with tagname "Curve"
 //
-// returned path is scaled
+// returned points are scaled
 //
-// Note: error paths do not do CurveYScale (or bias)
-QPainterPath* PlotBookModel::_createCurvesErrorPath(
+// Note: error points do not do CurveYScale (or bias)
+CurvePoints* PlotBookModel::_createCurvesErrorPoints(
                                             const QModelIndex &curvesIdx) const
 {
-    QPainterPath* path = new QPainterPath;
+    CurvePoints* points = new CurvePoints;
 
     if ( !isIndex(curvesIdx,"Curves") ) {
         fprintf(stderr,"koviz [bad scoobies]:1:"
-                       "PlotBookModel::_createErrorPath()\n");
+                       "PlotBookModel::_createCurvesErrorPoints()\n");
         exit(-1);
     }
 
     if ( rowCount(curvesIdx) != 2 ) {
         fprintf(stderr,"koviz [bad scoobies]:2:"
-                       "PlotBookModel::_createErrorPath(): "
-                       "Expected two curves for creating an error path.\n");
+                       "PlotBookModel::_createCurvesErrorPoints(): "
+                       "Expected two curves for creating error points.\n");
 
         exit(-1);
     }
@@ -1433,14 +1926,14 @@ QPainterPath* PlotBookModel::_createCurvesErrorPath(
 
     if ( c0 == 0 || c1 == 0 ) {
         fprintf(stderr,"koviz [bad scoobs]:3: "
-                       "PlotBookModel::_createErrorPath(). "
+                       "PlotBookModel::_createCurvesErrorPoints(). "
                        "Null curveModel!\n ");
         exit(-1);
     }
 
     if ( c0->t()->unit() != c1->t()->unit() ) {
         fprintf(stderr,"koviz [bad scoobs]:4: "
-                       "PlotBookModel::_createErrorPath().  "
+                       "PlotBookModel::_createCurvesErrorPoints().  "
                        "TODO: curveModels time units do not match.\n");
         exit(-1);
     }
@@ -1531,7 +2024,6 @@ QPainterPath* PlotBookModel::_createCurvesErrorPath(
     ModelIterator* i1 = c1->begin();
     double start = getDataDouble(QModelIndex(),"StartTime");
     double stop = getDataDouble(QModelIndex(),"StopTime");
-    bool isFirst = true;
     while ( !i0->isDone() && !i1->isDone() ) {
         double t0 = xs0*i0->t()+xb0;
         double t1 = xs1*i1->t()+xb1;
@@ -1590,11 +2082,8 @@ QPainterPath* PlotBookModel::_createCurvesErrorPath(
                 if ( isXLogScale ) {
                     t0 = log10(t0);
                 }
-                if ( isFirst ) {
-                    path->moveTo(t0,yy);
-                    isFirst = false;
-                } else {
-                    path->lineTo(t0,yy);
+                if ( std::isfinite(t0) && std::isfinite(yy) ) {
+                    points->append(t0,yy);
                 }
             }
         }
@@ -1604,7 +2093,7 @@ QPainterPath* PlotBookModel::_createCurvesErrorPath(
     c0->unmap();
     c1->unmap();
 
-    return path;
+    return points;
 }
 
 // If all curves have same unit, return that, else return "--"
@@ -2231,10 +2720,25 @@ void PlotBookModel::createCurves(QModelIndex curvesIdx,
                                  QAbstractItemModel* monteModel,
                                  QWidget *parent)
 {
+    int rc = _runs->runDirs().count();
+
+    // With many RUNs, optionally plot ensemble stats instead of every RUN
+    if ( rc > 1 && isChildIndex(QModelIndex(),"","EnsembleStats") ) {
+        QString ensembleStats = getDataString(QModelIndex(),"EnsembleStats");
+        QStringList stats = ensembleStats.split(",",QString::SkipEmptyParts);
+        if ( !stats.isEmpty() ) {
+            _createEnsembleCurves(curvesIdx,timeName,yName,
+                                  unitOverrides,stats);
+            return;
+        }
+    }
+
     // Turn off model signals when adding children for significant speedup
     bool block = blockSignals(true);
 
-    int rc = _runs->runDirs().count();
+    // Curve points are built on the curve pool if async curves are on
+    _isCreatingCurves = true;
+
     QList<QColor> colors = createCurveColors(rc);
 
     QHash<int,QString> run2color;
@@ -2529,11 +3033,141 @@ void PlotBookModel::createCurves(QModelIndex curvesIdx,
 
     // Turn signals back on before adding curveModel
     blockSignals(block);
+    _isCreatingCurves = false;
 
     // Update progress dialog
     progress.setValue(rc);
 
-    // Initialize plot math rect
+    _initPlotMathRect(curvesIdx);
+
+    // If curves are still loading, the math rect is redone when they land
+    QPersistentModelIndex plotIdx(curvesIdx.parent());
+    if ( _plot2pendingCnt.contains(plotIdx) ) {
+        _plot2pendingRect.insert(plotIdx,getPlotMathRect(plotIdx));
+    }
+}
+
+// A curve per ensemble stat (see CurveModelEnsemble) across all RUNs
+void PlotBookModel::_createEnsembleCurves(const QModelIndex &curvesIdx,
+                                          const QString &timeName,
+                                          const QString &yName,
+                                          const QStringList &unitOverrides,
+                                          const QStringList &stats)
+{
+    bool block = blockSignals(true);
+    _isCreatingCurves = true;
+
+    int rc = _runs->runDirs().count();
+    QList<CurveModel*> runCurves;
+    for ( int r = 0; r < rc; ++r) {
+        CurveModel* curveModel = createCurve(r,timeName,timeName,yName);
+        if ( !curveModel ) {
+            // This should not happen
+            fprintf(stderr, "koviz [bad scoobs]: bookmodel.cpp\n"
+                            "curve(%d,%s,%s,%s) failed.  Aborting!!!\n",
+                    r,
+                    timeName.toLatin1().constData(),
+                    timeName.toLatin1().constData(),
+                    yName.toLatin1().constData());
+            exit(-1);
+        }
+        runCurves << curveModel;
+    }
+
+    QList<CurveModel*> curveModels = CurveModelEnsemble::createCurves(
+                                                              runCurves,stats);
+    qDeleteAll(runCurves); // stats are copied out of the runs
+
+    // Stats of a var share a color, each var on the plot gets its own
+    int nCurves = rowCount(curvesIdx);
+    int nVars = nCurves/stats.size();
+    QList<QColor> colors = createCurveColors(nVars+1);
+    QString color = colors.at(nVars).name();
+
+    QString yunit = curveModels.at(0)->y()->unit();
+    if ( nCurves > 0 ) {
+        // Multiple vars on plot
+        QModelIndex curveIdx0 = getIndex(curvesIdx,"Curve", "Curves");
+        QString u0 = getDataString(curveIdx0,"CurveYUnit","Curve");
+        if ( Unit::canConvert(u0,yunit) ) {
+            yunit = u0;
+        }
+    }
+    foreach ( QString overrideUnit, unitOverrides ) {
+        Unit mUnit = Unit::map(yunit,overrideUnit);
+        if ( !mUnit.isEmpty() ) {
+            // No break if found, so last override in list used
+            yunit = mUnit.name();
+        }
+    }
+
+    int nStats = stats.size();
+    for ( int i = 0; i < nStats; ++i ) {
+
+        QString stat = stats.at(i).trimmed();
+        CurveModel* curveModel = curveModels.at(i);
+
+        // Center line solid, envelopes dashed
+        QString style = "plain";
+        if ( stat.endsWith("sigma") ) {
+            style = "dash";
+        } else if ( stat == "min" || stat == "max" ) {
+            style = "fine_dash";
+        } else if ( stat.startsWith("p") && stat != "p50" ) {
+            style = "long_dash";
+        }
+
+        QStandardItem* curvesItem = itemFromIndex(curvesIdx);
+        QStandardItem *curveItem = addChild(curvesItem,"Curve");
+
+        addChild(curveItem, "CurveRunID", 0);
+        addChild(curveItem, "CurveTimeName", timeName);
+        addChild(curveItem, "CurveTimeUnit", curveModel->t()->unit());
+        addChild(curveItem, "CurveXName", timeName);
+        addChild(curveItem, "CurveXUnit", curveModel->t()->unit()); // yes,t
+        addChild(curveItem, "CurveYName", yName);
+        addChild(curveItem, "CurveXMinRange", -DBL_MAX);
+        addChild(curveItem, "CurveXMaxRange",  DBL_MAX);
+        addChild(curveItem, "CurveYMinRange", -DBL_MAX);
+        addChild(curveItem, "CurveYMaxRange",  DBL_MAX);
+        addChild(curveItem, "CurveSymbolSize", "");
+        addChild(curveItem, "CurveYUnit", yunit);
+        addChild(curveItem, "CurveXScale", curveModel->x()->scale());
+        addChild(curveItem, "CurveXBias", curveModel->x()->bias());
+        addChild(curveItem, "CurveYScale", curveModel->y()->scale());
+        addChild(curveItem, "CurveYBias", curveModel->y()->bias());
+        addChild(curveItem, "CurveYLabel", yName + " (" + stat + ")");
+        addChild(curveItem, "CurveColor", color);
+        addChild(curveItem, "CurveLineStyle",style);
+        addChild(curveItem, "CurveSymbolStyle", "none");
+
+        // Add actual curve model data
+        if ( i == nStats-1 ) {
+            // Turn signals on for last curve for pixmap update
+            blockSignals(false);
+        }
+        QVariant v = PtrToQVariant<CurveModel>::convert(curveModel);
+        addChild(curveItem, "CurveData", v);
+        if ( i == nStats-1 ) {
+            blockSignals(true);
+        }
+    }
+
+    blockSignals(block);
+    _isCreatingCurves = false;
+
+    _initPlotMathRect(curvesIdx);
+
+    // If curves are still loading, the math rect is redone when they land
+    QPersistentModelIndex plotIdx(curvesIdx.parent());
+    if ( _plot2pendingCnt.contains(plotIdx) ) {
+        _plot2pendingRect.insert(plotIdx,getPlotMathRect(plotIdx));
+    }
+}
+
+// Initialize plot math rect
+void PlotBookModel::_initPlotMathRect(const QModelIndex &curvesIdx)
+{
     QRectF bbox = calcCurvesBBox(curvesIdx);
     QModelIndex plotIdx = curvesIdx.parent();
     QModelIndex pageIdx = plotIdx.parent().parent();
@@ -3164,3 +3798,37 @@ QList<double> PlotBookModel::__minorTics(double a, double b,
 
     return Minors;
 }
+
+void CurvePointsJob::run()
+{
+    QMutexLocker locker(&_runMutex);
+
+    if ( !isCanceled() ) {
+        CurvePoints* points = 0;
+        bool isPinned = false;
+        try {
+            _curveModel->pin();
+            isPinned = true;
+            _nrows = _curveModel->rowCount(); // pinned models do not grow
+            points = PlotBookModel::_calcCurvePoints(_curveModel,
+                                                     _startTime,_stopTime,
+                                                     _xs,_xb,_ys,_yb,
+                                                     _isXLogScale,_isYLogScale,
+                                                     _frequency,&_isCancel);
+        } catch (std::exception &e) {
+            fprintf(stderr,"\n%s\n",e.what());
+            points = new CurvePoints; // shows up as "Empty"
+        }
+        if ( isPinned ) {
+            _curveModel->unpin(); // a model left pinned never grows again
+        }
+        if ( isCanceled() ) {
+            delete points;
+        } else {
+            _points = points;
+            _lod = new CurveLOD(points);
+        }
+    }
+
+    emit finished();
+}
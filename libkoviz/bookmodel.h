@@ -12,6 +12,12 @@
 #include <QStringList>
 #include <QWidget>
 #include <QProgressDialog>
+#include <QPersistentModelIndex>
+#include <QMap>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QMutex>
 #include "timeit_linux.h"
 #if QT_VERSION >= 0x050000
 #include <QRegularExpressionMatch>
@@ -21,15 +27,59 @@
 #include "unit.h"
 #include "utils.h"
 #include "curvemodel.h"
+#include "curvemodel_ensemble.h"
+#include "curvepoints.h"
+#include "curvelod.h"
 
 #include <QList>
 #include <QColor>
 #include <cmath>
 #include <string.h>
 
+class CurvePointsJob;
+
+// Typed copy of the curve tags read when painting a curve, so painters
+// need not search the item tree by tag text for each one every paint
+// (see PlotBookModel::curveProps())
+struct CurveProps
+{
+    CurveModel* curveModel;
+    QColor color;
+    QString lineStyle;             // lower case
+    QVector<qreal> linePattern;
+    QString symbolStyle;           // lower case
+    int runID;
+    double xScale;                 // unit scale times CurveXScale
+    double xBias;                  // unit bias plus CurveXBias
+    double yScale;
+    double yBias;
+
+    CurveProps() :
+        curveModel(0), runID(0),
+        xScale(1.0), xBias(0.0), yScale(1.0), yBias(0.0)
+    {
+    }
+};
+
+// Typed copy of the plot tags read when painting a plot
+struct PlotProps
+{
+    QString xScale;                // "linear" or "log"
+    QString yScale;
+    bool isXLogScale;
+    bool isYLogScale;
+    bool isGrid;
+    QString presentation;          // PlotPresentation (may be empty)
+
+    PlotProps() : isXLogScale(false), isYLogScale(false), isGrid(false) {}
+};
+
 class PlotBookModel : public QStandardItemModel
 {
     Q_OBJECT
+
+    friend class CurvePointsJob;
+
 public:
     explicit PlotBookModel(const QStringList &timeNames, Runs* runs,
                             QObject *parent = 0);
@@ -46,6 +96,7 @@ public:
     double xBias(const QModelIndex& curveIdx, CurveModel* curveModelIn=0) const;
     double yBias(const QModelIndex& curveIdx) const;
     QRectF calcCurvesBBox(const QModelIndex& curvesIdx) const;
+    bool isCurveDataEmpty(const QModelIndex& curveIdx) const;
 
     QStandardItem* addChild(QStandardItem* parentItem,
                             const QString& childTitle,
@@ -97,8 +148,33 @@ public:
     CurveModel* getCurveModel(const QModelIndex& curvesIdx, int i) const;
     CurveModel* getCurveModel(const QModelIndex& curveIdx) const;
 
-    QPainterPath* getPainterPath(const QModelIndex& curveIdx) const;
-    QPainterPath* getCurvesErrorPath(const QModelIndex& curvesIdx);
+    CurvePoints* getCurvePoints(const QModelIndex& curveIdx) const;
+    CurveLOD* getCurveLOD(const QModelIndex& curveIdx) const;
+
+    // Cached on first use and dropped when a tag under the curve/plot
+    // changes.  Safe to call from BookPrinter worker threads.
+    CurveProps curveProps(const QModelIndex& curveIdx) const;
+    PlotProps plotProps(const QModelIndex& plotIdx) const;
+
+    // Asynchronous curve loading.  When on, createCurves() returns with
+    // empty placeholder points and the real points arrive from a thread
+    // pool (each curve's CurveData is signaled changed as it lands).
+    void setAsyncCurves(bool isAsync);
+    bool isCurvePointsPending(const QModelIndex& curveIdx) const;
+    void setCurvesPriorityPage(const QModelIndex& pageIdx);
+    void waitForCurves();
+
+    // Live mode (see TailFollower).  Curves whose models have grown get
+    // the new rows appended to their points.  Plots showing the end of
+    // their curves keep showing it.
+    void growCurves();
+
+    // BookPrinter reads curve points and math rects on its page workers,
+    // so growth is held off (and growCurves() deferred) while printing
+    void setPrinting(bool isPrinting);
+    bool isPrinting() const { return _isPrinting; }
+
+    CurvePoints* getCurvesErrorPoints(const QModelIndex& curvesIdx);
     QString getCurvesXUnit(const QModelIndex& curvesIdx);
     QString getCurvesYUnit(const QModelIndex& curvesIdx);
     bool isXTime(const QModelIndex& plotIdx) const;
@@ -122,6 +198,10 @@ public:
     QRectF getPlotMathRect(const QModelIndex &plotIdx) const;
     void setPlotMathRect(const QRectF& mathRect, const QModelIndex &plotIdx);
 
+    // Give the other x-time plots plotIdx's x range, as plot views do when
+    // a PlotMathRect changes (for books printed without views)
+    void syncXTimePlots(const QModelIndex& plotIdx);
+
     // Consolodating things views use
     QList<double> majorXTics(const QModelIndex& plotIdx) const;
     QList<double> minorXTics(const QModelIndex& plotIdx) const;
@@ -164,6 +244,13 @@ signals:
     
 public slots:
 
+private slots:
+    void _curvePointsJobFinished();
+    void _propsDataChanged(const QModelIndex& topLeft,
+                           const QModelIndex& bottomRight);
+    void _propsRowsInserted(const QModelIndex& pidx, int start, int end);
+    void _clearProps();
+
 private:
     QStringList _timeNames;
     Runs* _runs;
@@ -174,7 +261,14 @@ private:
                         const QString& ancestorText,
                         const QString &expectedStartIdxText=QString()) const;
 
-    QHash<CurveModel*,QPainterPath*> _curve2path;
+    QHash<CurveModel*,CurvePoints*> _curve2points;
+    QHash<CurveModel*,CurveLOD*> _curve2lod;
+    QHash<CurveModel*,int> _curve2nrows;  // model rows points were made from
+
+    mutable QMutex _propsMutex;
+    mutable QHash<const QStandardItem*,CurveProps> _curveProps;
+    mutable QHash<const QStandardItem*,PlotProps> _plotProps;
+    void _invalidateProps(const QModelIndex& idx);
     void _createPainterPath(const QModelIndex& curveIdx,
                             bool isUseStartTimeIn, double startTimeIn,
                             bool isUseStopTimeIn, double stopTimeIn,
@@ -186,14 +280,53 @@ private:
                             const QString& yUnitIn=QString(""),
                             const QString& plotXScaleIn=QString(""),
                             const QString& plotYScaleIn=QString(""),
-                            CurveModel* curveModelIn=0);
-    QPainterPath* __createPainterPath(CurveModel *curveModel,
-                                      double startTime, double stopTime,
-                                      double xs, double xb,
-                                      double ys, double yb,
-                                      const QString& plotXScale,
-                                      const QString& plotYScale);
-    QPainterPath* _createCurvesErrorPath(const QModelIndex& curvesIdx) const;
+                            CurveModel* curveModelIn=0,
+                            bool isGrow=false);
+    CurvePoints* __createCurvePoints(CurveModel *curveModel,
+                                     double startTime, double stopTime,
+                                     double xs, double xb,
+                                     double ys, double yb,
+                                     const QString& plotXScale,
+                                     const QString& plotYScale);
+    static CurvePoints* _calcCurvePoints(const CurveModel* curveModel,
+                                         double startTime, double stopTime,
+                                         double xs, double xb,
+                                         double ys, double yb,
+                                         bool isXLogScale, bool isYLogScale,
+                                         double frequency,
+                                         const QAtomicInt* isCancel=0);
+    static void _appendCurvePoints(CurvePoints* points,
+                                   const CurveModel* curveModel,
+                                   int rowBeg, int rowEnd,
+                                   double startTime, double stopTime,
+                                   double xs, double xb,
+                                   double ys, double yb,
+                                   bool isXLogScale, bool isYLogScale,
+                                   double frequency,
+                                   const QAtomicInt* isCancel=0);
+
+    bool _isAsyncCurves;
+    bool _isCreatingCurves;
+    bool _isPrinting;
+    bool _isGrowPending;  // growCurves() called while printing
+    QThreadPool _curvePool;
+    QHash<CurveModel*,CurvePointsJob*> _curve2job;    // pending jobs
+    QList<CurvePointsJob*> _curveJobs;  // all live jobs (incl. stale ones)
+    QMap<QPersistentModelIndex,int> _plot2pendingCnt;
+    QMap<QPersistentModelIndex,QRectF> _plot2pendingRect;
+    QPersistentModelIndex _curvesPriorityPageIdx;
+    CurvePoints* _pendingPoints;  // placeholder handed out while pending
+    void _startCurvePointsJob(CurvePointsJob* job);
+    void _cancelCurvePointsJob(CurveModel* curveModel);
+    CurvePointsJob* _takeCurvePointsJob(CurveModel* curveModel);
+    void _initPlotMathRect(const QModelIndex& curvesIdx);
+    void _createEnsembleCurves(const QModelIndex& curvesIdx,
+                               const QString& timeName,
+                               const QString& yName,
+                               const QStringList& unitOverrides,
+                               const QStringList& stats);
+    CurvePoints* _createCurvesErrorPoints(const QModelIndex& curvesIdx) const;
+    QRectF _curveStatsBBox(const QModelIndex& curveIdx) const;
 
     QString _commonRootName(const QStringList& names, const QString& sep) const;
     QString __commonRootName(const QString& a, const QString& b,
@@ -303,4 +436,84 @@ inline uint qHash(const PlotBookModel::LegendElement &key, uint seed)
 }
 #endif
 
+// Builds one curve's points (and level of detail) on a pool thread.
+// All parameters are gathered on the GUI thread by _createPainterPath()
+// so that run() reads nothing but the curve model's data.
+class CurvePointsJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    CurvePointsJob(const QModelIndex& curveIdx, CurveModel* curveModel,
+                   double startTime, double stopTime,
+                   double xs, double xb, double ys, double yb,
+                   bool isXLogScale, bool isYLogScale, double frequency) :
+        _curveIdx(curveIdx),
+        _plotIdx(curveIdx.parent().parent()),
+        _curveModel(curveModel),
+        _startTime(startTime), _stopTime(stopTime),
+        _xs(xs), _xb(xb), _ys(ys), _yb(yb),
+        _isXLogScale(isXLogScale), _isYLogScale(isYLogScale),
+        _frequency(frequency),
+        _isCancel(0),
+        _nrows(0),
+        _isDeferred(false),
+        _points(0),
+        _lod(0)
+    {
+        setAutoDelete(false); // PlotBookModel owns (and may rerun) jobs
+    }
+
+    ~CurvePointsJob()
+    {
+        delete _lod;
+        delete _points;
+    }
+
+    void run();
+
+    // Cancel is safe from any thread, wait() blocks until run() is out
+    void cancel() { _isCancel.store(1); }
+    void uncancel() { _isCancel.store(0); }
+    bool isCanceled() const { return _isCancel.load() != 0; }
+    void wait() { QMutexLocker locker(&_runMutex); }
+
+    // Only touched on the GUI thread (after finished() is delivered)
+    bool isDeferred() const { return _isDeferred; }
+    void setDeferred(bool isDeferred) { _isDeferred = isDeferred; }
+    bool hasResult() const { return _points != 0; }
+    CurvePoints* takePoints() { CurvePoints* p = _points; _points = 0; return p;}
+    CurveLOD* takeLOD() { CurveLOD* lod = _lod; _lod = 0; return lod; }
+
+    CurveModel* curveModel() const { return _curveModel; }
+    int nrows() const { return _nrows; } // model rows the points cover
+    QModelIndex curveIdx() const { return _curveIdx; }
+    QModelIndex plotIdx() const { return _plotIdx; }
+    QModelIndex pageIdx() const { return _plotIdx.parent().parent(); }
+
+signals:
+    void finished();
+
+private:
+    QPersistentModelIndex _curveIdx;
+    QPersistentModelIndex _plotIdx;
+    CurveModel* _curveModel;
+    double _startTime;
+    double _stopTime;
+    double _xs;
+    double _xb;
+    double _ys;
+    double _yb;
+    bool _isXLogScale;
+    bool _isYLogScale;
+    double _frequency;
+
+    QAtomicInt _isCancel;
+    QMutex _runMutex;
+    int _nrows;
+    bool _isDeferred;
+    CurvePoints* _points;
+    CurveLOD* _lod;
+};
+
 #endif // PLOTBOOKMODEL_H
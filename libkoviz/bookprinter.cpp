@@ -0,0 +1,271 @@
+#include "bookprinter.h"
+
+BookPrinter::BookPrinter(PlotBookModel *bookModel) :
+    _bookModel(bookModel),
+    _nThreads(0),
+    _progressCallback(0),
+    _progressData(0)
+{
+}
+
+bool BookPrinter::savePdf(const QString &fname,
+                          const QModelIndexList &pageIdxs)
+{
+    // Curves may still be loading in the background
+    _bookModel->waitForCurves();
+
+    //
+    // Setup printer
+    //
+    QPrinter printer(QPrinter::HighResolution);
+    printer.setCreator("Koviz");
+    printer.setDocName(fname);
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setPageSize(QPrinter::Letter);
+    printer.setOutputFileName(fname);
+    QString orient = _bookModel->getDataString(QModelIndex(),"Orientation");
+    if ( orient == "landscape" ) {
+        printer.setOrientation(QPrinter::Landscape);
+    } else if ( orient == "portrait" ) {
+        printer.setOrientation(QPrinter::Portrait);
+    } else {
+        fprintf(stderr, "koviz [bad scoobs]: savePdf! Aborting!\n");
+        exit(-1);
+    }
+
+    //
+    // Begin Printing
+    //
+    QPainter painter;
+    if (! painter.begin(&printer)) {
+        return false;
+    }
+    painter.save();
+
+    // Progress dialogs pump events while pages print, hold off -follow
+    _bookModel->setPrinting(true);
+
+    //
+    // Set pen
+    //
+    QPen pen((QColor(Qt::black)));
+    double pointSize = printer.logicalDpiX()/72.0;
+    pen.setWidthF(pointSize);
+    painter.setPen(pen);
+
+    //
+    // Print pages
+    //
+    int nPages = pageIdxs.size();
+    int nThreads = _nThreads;
+    if ( nThreads <= 0 ) {
+        nThreads = QThread::idealThreadCount();
+    }
+    if ( nThreads > 1 && nPages > 1 ) {
+        _recordPages(&painter,&printer,pageIdxs,nThreads);
+    } else {
+        for ( int i = 0; i < nPages; ++i ) {
+            if ( i > 0 ) {
+                printer.newPage();
+            }
+            printPage(&painter,pageIdxs.at(i));
+            if ( _progressCallback ) {
+                _progressCallback(i+1,nPages,_progressData);
+            }
+        }
+    }
+
+    //
+    // End printing
+    //
+    painter.restore();
+    painter.end();
+
+    _bookModel->setPrinting(false);
+
+    return true;
+}
+
+// Pages are recorded on a pool and replayed into the printer in order as
+// soon as they are ready
+void BookPrinter::_recordPages(QPainter *painter, QPrinter *printer,
+                               const QModelIndexList &pageIdxs, int nThreads)
+{
+    int nPages = pageIdxs.size();
+    QVector<PagePicture*> pictures(nPages,0);
+    PagePicture blank(printer);
+    QAtomicInt next(0);
+    QSemaphore slots(2*nThreads); // max pages recorded but not yet printed
+    QMutex mutex;
+    QWaitCondition recorded;
+    double penWidth = painter->pen().widthF();
+
+    QThreadPool pool;
+    int nWorkers = qMin(nThreads,nPages);
+    pool.setMaxThreadCount(nWorkers);
+    for ( int w = 0; w < nWorkers; ++w ) {
+        pool.start(new PageRecorder(this,&blank,pageIdxs,&pictures,
+                                    &next,&slots,&mutex,&recorded,
+                                    penWidth));
+    }
+
+    for ( int i = 0; i < nPages; ++i ) {
+        mutex.lock();
+        while ( pictures.at(i) == 0 ) {
+            recorded.wait(&mutex);
+        }
+        PagePicture* picture = pictures.at(i);
+        pictures[i] = 0;
+        mutex.unlock();
+
+        if ( i > 0 ) {
+            printer->newPage();
+        }
+        painter->drawPicture(0,0,*picture);
+        delete picture;
+        slots.release();
+
+        if ( _progressCallback ) {
+            _progressCallback(i+1,nPages,_progressData);
+        }
+    }
+
+    pool.waitForDone();
+}
+
+void BookPrinter::printPage(QPainter *painter, const QModelIndex& pageIdx)
+{
+    QPaintDevice* paintDevice = painter->device();
+    if ( !paintDevice ) return;
+
+    painter->save();
+
+    // Foreground
+    QPen origPen = painter->pen();
+    QColor fg = _bookModel->pageForegroundColor(pageIdx);
+    QPen pagePen = painter->pen();
+    pagePen.setColor(fg);
+    painter->setPen(pagePen);
+
+    // Background
+    QColor bg = _bookModel->pageBackgroundColor(pageIdx);
+    painter->fillRect(QRect(0,0,paintDevice->width(),paintDevice->height()),bg);
+
+    // Load page and plot layouts
+    PageLayout pageLayout;
+    pageLayout.setModelIndex(_bookModel,pageIdx);
+    PageTitleLayoutItem* pageTitleLayoutItem = new PageTitleLayoutItem(
+                                                  _bookModel,pageIdx,
+                                                  painter->font());
+    pageLayout.addItem(pageTitleLayoutItem);
+    QModelIndex plotsIdx = _bookModel->getIndex(pageIdx,"Plots", "Page");
+    QModelIndexList plotIdxs = _bookModel->plotIdxs(pageIdx);
+    int nPlots = _bookModel->rowCount(plotsIdx);
+    QHash<QLayout*,QRectF> plotlayout2mathrect;
+    QFontMetrics fm = painter->fontMetrics();
+    QFont font8 = painter->font();
+    font8.setPointSizeF(8);
+    QFontMetrics fm8(font8);
+    for ( int i = 0; i < nPlots; ++i ) {
+        PlotLayout* plotLayout = new PlotLayout;
+        pageLayout.addItem(plotLayout);
+
+        // PlotLayout expects items to be added in a specific order!!!
+        QModelIndex plotIdx = plotIdxs.at(i);
+        QString plotRatio = _bookModel->getDataString(plotIdx,
+                                                        "PlotRatio","Plot");
+        plotLayout->setPlotRatio(plotRatio);
+        QRectF M = _bookModel->getPlotMathRect(plotIdx);
+        plotlayout2mathrect.insert(plotLayout,M);
+        QLayoutItem* item = new YAxisLabelLayoutItem(fm,_bookModel,plotIdx);
+        plotLayout->addItem(item);  // yAxisLabel
+        item = new TicLabelsLayoutItem(fm,fm8,_bookModel,plotIdx);
+        item->setAlignment(Qt::AlignLeft);
+        plotLayout->addItem(item);  // yTicLabels
+        item = new PlotTitleLayoutItem(fm,_bookModel,plotIdx);
+        plotLayout->addItem(item);  // plottitle
+        item = new CurvesLayoutItem(_bookModel,plotIdx,0);
+        plotLayout->addItem(item);  // curves
+        item = new PlotCornerLayoutItem(fm,Qt::TopLeftCorner);
+        plotLayout->addItem(item);  // tlcorner
+        item = new PlotCornerLayoutItem(fm,Qt::TopRightCorner);
+        plotLayout->addItem(item);  // trcorner
+        item = new PlotCornerLayoutItem(fm,Qt::BottomRightCorner);
+        plotLayout->addItem(item);  // brcorner
+        item = new PlotCornerLayoutItem(fm,Qt::BottomLeftCorner);
+        plotLayout->addItem(item);  // blcorner
+        item = new PlotTicsLayoutItem(fm,_bookModel,plotIdx);
+        item->setAlignment(Qt::AlignLeft);
+        plotLayout->addItem(item);  // ltics
+        item = new PlotTicsLayoutItem(fm,_bookModel,plotIdx);
+        item->setAlignment(Qt::AlignTop);
+        plotLayout->addItem(item);  // ttics
+        item = new PlotTicsLayoutItem(fm,_bookModel,plotIdx);
+        item->setAlignment(Qt::AlignRight);
+        plotLayout->addItem(item);  // rtics
+        item = new PlotTicsLayoutItem(fm,_bookModel,plotIdx);
+        item->setAlignment(Qt::AlignBottom);
+        plotLayout->addItem(item);  // btics
+        item = new TicLabelsLayoutItem(fm,fm8,_bookModel,plotIdx);
+        item->setAlignment(Qt::AlignBottom);
+        plotLayout->addItem(item);  // xticlabels
+        item = new XAxisLabelLayoutItem(fm,_bookModel,plotIdx);
+        plotLayout->addItem(item);  // xaxislabel
+    }
+    double pixelRatio = paintDevice->devicePixelRatio();
+    int ww = qRound((double)paintDevice->width()/pixelRatio);
+    int hh = qRound((double)paintDevice->height()/pixelRatio);
+    pageLayout.setGeometry(QRect(0,0,ww,hh));
+
+    // Print layouts
+    //QColor green(0,255,0);
+    //QPen greenPen(green);
+    painter->setPen(pagePen);
+    int nItems = pageLayout.count();
+    for ( int i = 0; i < nItems; ++i ) {
+        QLayoutItem* item = pageLayout.itemAt(i);
+        QRect parentRect = item->geometry();
+        //painter->setPen(greenPen);
+        //painter->drawRect(parentRect);
+        //painter->setPen(pagePen);
+        if ( item->layout() && item->layout()->count() == 14 ) {
+            // It's a plotlayout since it has 14 elements!
+            QLayout* plotLayout= item->layout();
+            QRect C = plotLayout->itemAt(3)->geometry();
+            C.translate(parentRect.x(),parentRect.y());
+            QRectF M = plotlayout2mathrect.value(plotLayout);
+            for ( int j = 0; j < plotLayout->count(); ++j ) {
+                QLayoutItem* childItem = plotLayout->itemAt(j);
+                QRect R = childItem->geometry();
+                R.translate(parentRect.x(),parentRect.y());
+                //painter->setPen(greenPen);
+                //painter->drawRect(R);
+                //painter->setPen(pagePen);
+                PaintableLayoutItem* paintItem =
+                                  dynamic_cast<PaintableLayoutItem*>(childItem);
+                if ( paintItem ) {
+                    paintItem->paint(painter,R,R,C,M);
+                }
+            }
+        }
+    }
+    QRect R = pageTitleLayoutItem->geometry();
+    QRect RG;
+    QRect C;
+    QRect M;
+    pageTitleLayoutItem->paint(painter,R,RG,C,M);
+
+    // Clean up
+    for ( int i = 0; i < nItems; ++i ) {
+        QLayoutItem* item = pageLayout.itemAt(i);
+        if ( item->layout() ) {
+            for ( int j = 0; j < item->layout()->count(); ++j ) {
+                delete item->layout()->itemAt(j);
+            }
+        }
+        delete item;
+    }
+
+    painter->setPen(origPen);
+    painter->restore();
+}
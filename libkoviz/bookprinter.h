@@ -0,0 +1,147 @@
+#ifndef BOOKPRINTER_H
+#define BOOKPRINTER_H
+
+#include <QPainter>
+#include <QPrinter>
+#include <QPen>
+#include <QFont>
+#include <QFontMetrics>
+#include <QString>
+#include <QHash>
+#include <QModelIndex>
+#include <QPicture>
+#include <QPaintDevice>
+#include <QVector>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSemaphore>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bookmodel.h"
+#include "pagepicture.h"
+#include "pagelayout.h"
+#include "plotlayout.h"
+#include "layoutitem_pagetitle.h"
+#include "layoutitem_paintable.h"
+#include "layoutitem_yaxislabel.h"
+#include "layoutitem_plotcorner.h"
+#include "layoutitem_plottics.h"
+#include "layoutitem_plottitle.h"
+#include "layoutitem_ticlabels.h"
+#include "layoutitem_xaxislabel.h"
+#include "layoutitem_curves.h"
+
+//
+// Prints book pages straight from the PlotBookModel with the layoutitem_*
+// painters.  No views/widgets are involved, so a book can be printed
+// without a PlotMainWindow (e.g. -pdf with -platform offscreen).
+//
+// Pdf pages may be recorded concurrently (see setThreadCount()), each
+// into a PagePicture on a worker thread, then replayed into the printer
+// in page order.  The book model must not change while printing.
+//
+class BookPrinter
+{
+  public:
+    explicit BookPrinter(PlotBookModel* bookModel);
+
+    // Called on the printing thread as each page is put in the pdf
+    typedef void (*ProgressCallback)(int nPagesDone, int nPages, void* data);
+
+    // Threads used to record pdf pages, 0 (default) for all cores and
+    // 1 to print serially
+    void setThreadCount(int nThreads) { _nThreads = nThreads; }
+    void setProgressCallback(ProgressCallback cb, void* data=0)
+    {
+        _progressCallback = cb;
+        _progressData = data;
+    }
+
+    void printPage(QPainter* painter, const QModelIndex& pageIdx);
+
+    // Print pageIdxs (in list order) into pdf fname
+    bool savePdf(const QString& fname, const QModelIndexList& pageIdxs);
+
+  private:
+    PlotBookModel* _bookModel;
+    int _nThreads;
+    ProgressCallback _progressCallback;
+    void* _progressData;
+
+    void _recordPages(QPainter* painter, QPrinter* printer,
+                      const QModelIndexList& pageIdxs, int nThreads);
+};
+
+//
+// Pool worker for BookPrinter::_recordPages().  Workers claim pages in
+// order off a shared counter.  A page is claimed only after taking a
+// slot, and slots are given back as pages are replayed, so only a window
+// of recorded pages is held in memory at a time.
+//
+class PageRecorder : public QRunnable
+{
+  public:
+    PageRecorder(BookPrinter* bookPrinter,
+                 const PagePicture* blank,
+                 const QModelIndexList& pageIdxs,
+                 QVector<PagePicture*>* pictures,
+                 QAtomicInt* next,
+                 QSemaphore* slots,
+                 QMutex* mutex,
+                 QWaitCondition* recorded,
+                 double penWidth) :
+        _bookPrinter(bookPrinter),
+        _blank(blank),
+        _pageIdxs(pageIdxs),
+        _pictures(pictures),
+        _next(next),
+        _slots(slots),
+        _mutex(mutex),
+        _recorded(recorded),
+        _penWidth(penWidth)
+    {
+    }
+
+    void run()
+    {
+        while ( 1 ) {
+            _slots->acquire();
+            int i = _next->fetchAndAddOrdered(1);
+            if ( i >= _pageIdxs.size() ) {
+                _slots->release();
+                break;
+            }
+
+            PagePicture* picture = new PagePicture(*_blank);
+            QPainter painter(picture);
+            QPen pen((QColor(Qt::black)));
+            pen.setWidthF(_penWidth);
+            painter.setPen(pen);
+            _bookPrinter->printPage(&painter,_pageIdxs.at(i));
+            painter.end();
+
+            _mutex->lock();
+            (*_pictures)[i] = picture;
+            _recorded->wakeAll();
+            _mutex->unlock();
+        }
+    }
+
+  private:
+    BookPrinter* _bookPrinter;
+    const PagePicture* _blank;
+    QModelIndexList _pageIdxs;
+    QVector<PagePicture*>* _pictures;
+    QAtomicInt* _next;
+    QSemaphore* _slots;
+    QMutex* _mutex;
+    QWaitCondition* _recorded;
+    double _penWidth;
+};
+
+#endif // BOOKPRINTER_H
@@ -13,6 +13,8 @@ BookView::BookView(QWidget *parent) :
 
     connect(_nb,SIGNAL(tabCloseRequested(int)),
             this,SLOT(_nbCloseRequested(int)));
+    connect(_nb,SIGNAL(currentChanged(int)),
+            this,SLOT(_nbCurrentChanged(int)));
 
     _mainLayout->addWidget(_nb);
 
@@ -137,73 +139,40 @@ QModelIndex BookView::_tabIdToModelIdx(int tabId)
 }
 
 
-void BookView::savePdf(const QString &fname)
+static void _savePdfProgress(int nPagesDone, int nPages, void* data)
 {
-    //
-    // Setup printer
-    //
-    QPrinter printer(QPrinter::HighResolution);
-    printer.setCreator("Koviz");
-    printer.setDocName(fname);
-    printer.setOutputFormat(QPrinter::PdfFormat);
-    printer.setPageSize(QPrinter::Letter);
-    printer.setOutputFileName(fname);
-    QString orient = _bookModel()->getDataString(QModelIndex(),"Orientation");
-    if ( orient == "landscape" ) {
-        printer.setOrientation(QPrinter::Landscape);
-    } else if ( orient == "portrait" ) {
-        printer.setOrientation(QPrinter::Portrait);
-    } else {
-        fprintf(stderr, "koviz [bad scoobs]: savePdf! Aborting!\n");
-        exit(-1);
-    }
-
-    //
-    // Begin Printing
-    //
-    QPainter painter;
-    if (! painter.begin(&printer)) {
-        return;
-    }
-    painter.save();
+    Q_UNUSED(nPages);
+    QProgressDialog* progress = static_cast<QProgressDialog*>(data);
+    progress->setValue(nPagesDone);
+}
 
-    //
-    // Set pen
-    //
-    QPen pen((QColor(Qt::black)));
-    double pointSize = printer.logicalDpiX()/72.0;
-    pen.setWidthF(pointSize);
-    painter.setPen(pen);
-
-    //
-    // Print pages
-    //
-    bool isFirst = true;
+void BookView::savePdf(const QString &fname)
+{
+    // Print pages (not tables) in tab order
+    QModelIndexList pageIdxs;
     int nTabs = _nb->count();
     for ( int i = 0; i < nTabs; ++i) {
-
         QModelIndex idx = _tabIdToModelIdx(i);
         QString tag = model()->data(idx).toString();
-        if ( tag != "Page") {
-            continue; // only print pages (i.e. not tables)
+        if ( tag == "Page") {
+            pageIdxs << idx;
         }
-        if ( isFirst ) {
-            isFirst = false;
-        } else {
-            printer.newPage();
-        }
-        _printPage(&painter,idx);
     }
 
-    //
-    // End printing
-    //
-    painter.restore();
-    painter.end();
+    QProgressDialog progress("Printing pdf...", QString(),
+                             0, pageIdxs.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+
+    BookPrinter bookPrinter(_bookModel());
+    bookPrinter.setProgressCallback(_savePdfProgress,&progress);
+    bookPrinter.savePdf(fname,pageIdxs);
 }
 
 void BookView::saveJpg(const QString &fname)
 {
+    _bookModel()->waitForCurves();
+
     QWidget* page = _nb->currentWidget();
     int    image_dpi = page->logicalDpiX()*2; // arbitrary factor 2 for highdef
     double image_width_inches =(double)page->size().width()/page->logicalDpiX();
@@ -224,7 +193,8 @@ void BookView::saveJpg(const QString &fname)
 
     // Print current page onto pixmap
     QModelIndex pageIdx = _tabIdToModelIdx(_nb->currentIndex());
-    _printPage(&painter,pageIdx);
+    BookPrinter bookPrinter(_bookModel());
+    bookPrinter.printPage(&painter,pageIdx);
 
     // Save the pixmap to a *.jpg
     pixmap.save(fname,"JPG");
@@ -234,143 +204,6 @@ void BookView::saveJpg(const QString &fname)
     painter.end();
 }
 
-void BookView::_printPage(QPainter *painter, const QModelIndex& pageIdx)
-{
-    QPaintDevice* paintDevice = painter->device();
-    if ( !paintDevice ) return;
-
-    painter->save();
-
-    // Foreground
-    QPen origPen = painter->pen();
-    QColor fg = _bookModel()->pageForegroundColor(pageIdx);
-    QPen pagePen = painter->pen();
-    pagePen.setColor(fg);
-    painter->setPen(pagePen);
-
-    // Background
-    QColor bg = _bookModel()->pageBackgroundColor(pageIdx);
-    painter->fillRect(QRect(0,0,paintDevice->width(),paintDevice->height()),bg);
-
-    // Load page and plot layouts
-    PageLayout pageLayout;
-    pageLayout.setModelIndex(_bookModel(),pageIdx);
-    PageTitleLayoutItem* pageTitleLayoutItem = new PageTitleLayoutItem(
-                                                  _bookModel(),pageIdx,
-                                                  painter->font());
-    pageLayout.addItem(pageTitleLayoutItem);
-    QModelIndex plotsIdx = _bookModel()->getIndex(pageIdx,"Plots", "Page");
-    QModelIndexList plotIdxs = _bookModel()->plotIdxs(pageIdx);
-    int nPlots = model()->rowCount(plotsIdx);
-    QHash<QLayout*,QRectF> plotlayout2mathrect;
-    QFontMetrics fm = painter->fontMetrics();
-    QFont font8 = painter->font();
-    font8.setPointSizeF(8);
-    QFontMetrics fm8(font8);
-    for ( int i = 0; i < nPlots; ++i ) {
-        PlotLayout* plotLayout = new PlotLayout;
-        pageLayout.addItem(plotLayout);
-
-        // PlotLayout expects items to be added in a specific order!!!
-        QModelIndex plotIdx = plotIdxs.at(i);
-        QString plotRatio = _bookModel()->getDataString(plotIdx,
-                                                        "PlotRatio","Plot");
-        plotLayout->setPlotRatio(plotRatio);
-        QRectF M = _bookModel()->getPlotMathRect(plotIdx);
-        plotlayout2mathrect.insert(plotLayout,M);
-        QLayoutItem* item = new YAxisLabelLayoutItem(fm,_bookModel(),plotIdx);
-        plotLayout->addItem(item);  // yAxisLabel
-        item = new TicLabelsLayoutItem(fm,fm8,_bookModel(),plotIdx);
-        item->setAlignment(Qt::AlignLeft);
-        plotLayout->addItem(item);  // yTicLabels
-        item = new PlotTitleLayoutItem(fm,_bookModel(),plotIdx);
-        plotLayout->addItem(item);  // plottitle
-        item = new CurvesLayoutItem(_bookModel(),plotIdx,0);
-        plotLayout->addItem(item);  // curves
-        item = new PlotCornerLayoutItem(fm,Qt::TopLeftCorner);
-        plotLayout->addItem(item);  // tlcorner
-        item = new PlotCornerLayoutItem(fm,Qt::TopRightCorner);
-        plotLayout->addItem(item);  // trcorner
-        item = new PlotCornerLayoutItem(fm,Qt::BottomRightCorner);
-        plotLayout->addItem(item);  // brcorner
-        item = new PlotCornerLayoutItem(fm,Qt::BottomLeftCorner);
-        plotLayout->addItem(item);  // blcorner
-        item = new PlotTicsLayoutItem(fm,_bookModel(),plotIdx);
-        item->setAlignment(Qt::AlignLeft);
-        plotLayout->addItem(item);  // ltics
-        item = new PlotTicsLayoutItem(fm,_bookModel(),plotIdx);
-        item->setAlignment(Qt::AlignTop);
-        plotLayout->addItem(item);  // ttics
-        item = new PlotTicsLayoutItem(fm,_bookModel(),plotIdx);
-        item->setAlignment(Qt::AlignRight);
-        plotLayout->addItem(item);  // rtics
-        item = new PlotTicsLayoutItem(fm,_bookModel(),plotIdx);
-        item->setAlignment(Qt::AlignBottom);
-        plotLayout->addItem(item);  // btics
-        item = new TicLabelsLayoutItem(fm,fm8,_bookModel(),plotIdx);
-        item->setAlignment(Qt::AlignBottom);
-        plotLayout->addItem(item);  // xticlabels
-        item = new XAxisLabelLayoutItem(fm,_bookModel(),plotIdx);
-        plotLayout->addItem(item);  // xaxislabel
-    }
-    double pixelRatio = paintDevice->devicePixelRatio();
-    int ww = qRound((double)paintDevice->width()/pixelRatio);
-    int hh = qRound((double)paintDevice->height()/pixelRatio);
-    pageLayout.setGeometry(QRect(0,0,ww,hh));
-
-    // Print layouts
-    //QColor green(0,255,0);
-    //QPen greenPen(green);
-    painter->setPen(pagePen);
-    int nItems = pageLayout.count();
-    for ( int i = 0; i < nItems; ++i ) {
-        QLayoutItem* item = pageLayout.itemAt(i);
-        QRect parentRect = item->geometry();
-        //painter->setPen(greenPen);
-        //painter->drawRect(parentRect);
-        //painter->setPen(pagePen);
-        if ( item->layout() && item->layout()->count() == 14 ) {
-            // It's a plotlayout since it has 14 elements!
-            QLayout* plotLayout= item->layout();
-            QRect C = plotLayout->itemAt(3)->geometry();
-            C.translate(parentRect.x(),parentRect.y());
-            QRectF M = plotlayout2mathrect.value(plotLayout);
-            for ( int j = 0; j < plotLayout->count(); ++j ) {
-                QLayoutItem* childItem = plotLayout->itemAt(j);
-                QRect R = childItem->geometry();
-                R.translate(parentRect.x(),parentRect.y());
-                //painter->setPen(greenPen);
-                //painter->drawRect(R);
-                //painter->setPen(pagePen);
-                PaintableLayoutItem* paintItem =
-                                  dynamic_cast<PaintableLayoutItem*>(childItem);
-                if ( paintItem ) {
-                    paintItem->paint(painter,R,R,C,M);
-                }
-            }
-        }
-    }
-    QRect R = pageTitleLayoutItem->geometry();
-    QRect RG;
-    QRect C;
-    QRect M;
-    pageTitleLayoutItem->paint(painter,R,RG,C,M);
-
-    // Clean up
-    for ( int i = 0; i < nItems; ++i ) {
-        QLayoutItem* item = pageLayout.itemAt(i);
-        if ( item->layout() ) {
-            for ( int j = 0; j < item->layout()->count(); ++j ) {
-                delete item->layout()->itemAt(j);
-            }
-        }
-        delete item;
-    }
-
-    painter->setPen(origPen);
-    painter->restore();
-}
-
 void BookView::_nbCloseRequested(int tabId)
 {
     if ( model() == 0 ) return;
@@ -379,6 +212,19 @@ void BookView::_nbCloseRequested(int tabId)
     model()->removeRow(pageIdx.row(),pageIdx.parent()); // rowsAboutToBeRemoved deletes page
 }
 
+// Curves on the page being looked at get loaded first
+void BookView::_nbCurrentChanged(int tabId)
+{
+    if ( model() == 0 || tabId < 0 ) return;
+
+    // Tab text/tooltip may not be set yet (addTab), so use the view's root
+    QAbstractItemView* view = qobject_cast<QAbstractItemView*>(
+                                                        _nb->widget(tabId));
+    if ( view && _bookModel()->isIndex(view->rootIndex(),"Page") ) {
+        _bookModel()->setCurvesPriorityPage(view->rootIndex());
+    }
+}
+
 void BookView::_pageViewCurrentChanged(const QModelIndex &currIdx,
                                        const QModelIndex &prevIdx)
 {
@@ -4,6 +4,7 @@
 #include <QVBoxLayout>
 #include <QFileInfo>
 #include <QPrinter>
+#include <QProgressDialog>
 #include <QLineF>
 #include <QPointF>
 #include <QPen>
@@ -24,6 +25,7 @@
 #include "bookview_page.h"
 #include "bookview_tablepage.h"
 #include "bookmodel.h"
+#include "bookprinter.h"
 #include "pagelayout.h"
 #include "bookview_plot.h"
 #include "plotlayout.h"
@@ -56,15 +58,13 @@ private:
     int _modelIdxToTabId(const QModelIndex& idx);
     QModelIndex _tabIdToModelIdx(int tabId);
 
-private:
-    void _printPage(QPainter* painter, const QModelIndex& pageIdx);
-
 public slots:
     void savePdf(const QString& fname);
     void saveJpg(const QString& fname);
 
 protected slots:
     void _nbCloseRequested(int tabId);
+    void _nbCurrentChanged(int tabId);
     void _pageViewCurrentChanged(const QModelIndex& currIdx,
                                  const QModelIndex& prevIdx);
     virtual void dataChanged(const QModelIndex &topLeft,
@@ -2,7 +2,11 @@
 
 CurvesView::CurvesView(QWidget *parent) :
     BookIdxView(parent),
-    _pixmap(0),
+    _isCurvesLayerStale(true),
+    _isSelectionLayerStale(true),
+    _isLegendLayerStale(true),
+    _layerJob(0),
+    _layerGeneration(0),
     _isMeasure(false),
     _isLastPoint(false),
     _bw_frame(0),
@@ -11,6 +15,7 @@ CurvesView::CurvesView(QWidget *parent) :
     _sg_frame(0),
     _sg_window(0),
     _sg_slider(0),
+    _filterGeneration(0),
     _integ_frame(0)
 {
     setFocusPolicy(Qt::StrongFocus);
@@ -18,11 +23,16 @@ CurvesView::CurvesView(QWidget *parent) :
 
     // Set mouse tracking to receive mouse move events when button not pressed
     setMouseTracking(true);
+
+    _layerPool.setMaxThreadCount(1);
 }
 
 CurvesView::~CurvesView()
 {
-    delete _pixmap;
+    _cancelLayerJob();
+    _cancelFilterJobs();
+    _filterPool.waitForDone();
+    qDeleteAll(_filterJobs);
 
     foreach ( TimeAndIndex* marker, _markers ) {
         delete marker;
@@ -114,103 +124,270 @@ void CurvesView::paintEvent(QPaintEvent *event)
 
     if ( !model() ) return;
 
-    QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
-    int nCurves = model()->rowCount(curvesIdx);
+    if ( _isCurvesLayerStale || _curvesLayer.size() != viewport()->size() ) {
+        _updateCurvesLayer();
+    }
+    if ( _isSelectionLayerStale ) {
+        _updateSelectionLayer();
+    }
+    if ( _isLegendLayerStale ) {
+        _updateLegendLayer();
+    }
 
     QPainter painter(viewport());
-    painter.save();
 
+    // Curves, while a new curve layer is in the works the last one is
+    // mapped into the current math rect (e.g. it moves with a pan)
+    if ( !_curvesLayer.isNull() ) {
+        painter.save();
+        QTransform T = _coordToPixelTransform();
+        bool isInvertible = false;
+        QTransform I = _curvesLayerT.inverted(&isInvertible);
+        if ( isInvertible && T != _curvesLayerT ) {
+            QModelIndex pageIdx = rootIndex().parent().parent();
+            painter.fillRect(viewport()->rect(),
+                             _bookModel()->pageBackgroundColor(pageIdx));
+            painter.setTransform(I*T);
+        }
+        painter.drawImage(0,0,_curvesLayer);
+        painter.restore();
+    }
+
+    if ( !_selectionLayer.isNull() ) {
+        painter.drawImage(0,0,_selectionLayer);
+    }
+
+    if ( !_legendLayer.isNull() ) {
+        painter.drawImage(0,0,_legendLayer);
+    }
+
+    // Overlay
     painter.setRenderHint(QPainter::Antialiasing);
+    QPen pen;
+    pen.setWidthF(0.0);
+    painter.setPen(pen);
+
+    _paintMarkers(painter);
+
+    if ( _isMeasure ) {
+        painter.drawEllipse(_mousePressPos,3,3);
+        painter.drawEllipse(_mouseCurrPos,2,2);
+        painter.drawLine(_mousePressPos,_mouseCurrPos);
+    }
+#endif
+}
+
+
+QString CurvesView::_plotPresentation()
+{
+    PlotProps plotProps = _bookModel()->plotProps(rootIndex());
+    QString plotPresentation = plotProps.presentation;
+    if ( plotPresentation.isEmpty() ) {
+        plotPresentation = _bookModel()->getDataString(QModelIndex(),
+                                                       "Presentation");
+    }
+    return plotPresentation;
+}
+
+bool CurvesView::_isCurrentCurveInPlot()
+{
+    QModelIndex gpidx = currentIndex().parent().parent();
+    QString tag = model()->data(currentIndex()).toString();
+    return ( currentIndex().isValid() && tag == "Curve" &&
+             gpidx == rootIndex() );
+}
+
+void CurvesView::_invalidateLayers()
+{
+    _isCurvesLayerStale = true;
+    _isSelectionLayerStale = true;
+    _isLegendLayerStale = true;
+}
+
+// Record the curve layer and hand it off to be rasterized.  One job at a
+// time, if the layer goes stale while rasterizing, the next paint after
+// the job finishes starts another.
+void CurvesView::_updateCurvesLayer()
+{
+    QSize size = viewport()->size();
+    if ( size.width() == 0 || size.height() == 0 ) {
+        _curvesLayer = QImage();
+        _isCurvesLayerStale = false;
+        return;
+    }
+    bool isCurves  = _bookModel()->isChildIndex(rootIndex(),"Plot","Curves");
+    if ( !isCurves ) {
+        _curvesLayer = QImage();
+        _isCurvesLayerStale = false;
+        return;
+    }
+
+    bool isSizeChanged = ( _curvesLayer.size() != size );
+    if ( _layerJob && !isSizeChanged ) {
+        return;
+    }
+    _cancelLayerJob();
+    _isCurvesLayerStale = false;
 
     QTransform T = _coordToPixelTransform();
-    double ptSizeCurve = 0.0;
+    PagePicture* picture = new PagePicture(viewport());
+    QPainter painter(picture);
+    _paintCurvesLayer(painter,T);
+    painter.end();
+
+    if ( isSizeChanged ) {
+        // Nothing to show in the meantime, rasterize here
+        _curvesLayer = CurvesLayerJob::render(*picture,size);
+        _curvesLayerT = T;
+        _isSelectionLayerStale = true;
+        delete picture;
+        return;
+    }
+
+    _layerJob = new CurvesLayerJob(picture,size,++_layerGeneration);
+    _layerJobT = T;
+    connect(_layerJob,SIGNAL(finished(int)),
+            this,SLOT(_curvesLayerFinished(int)));
+    _layerPool.start(_layerJob);
+}
+
+// Jobs can't be stopped partway, wait for run() and let the generation
+// check in _curvesLayerFinished() drop a finished() that is still queued
+void CurvesView::_cancelLayerJob()
+{
+    if ( !_layerJob ) return;
+    _layerPool.waitForDone();
+    delete _layerJob;
+    _layerJob = 0;
+}
+
+void CurvesView::_curvesLayerFinished(int generation)
+{
+    if ( generation != _layerGeneration || !_layerJob ) return;
+
+    _layerPool.waitForDone(); // job is out of run()
+    QImage image = _layerJob->image();
+    delete _layerJob;
+    _layerJob = 0;
+
+    if ( image.size() == viewport()->size() ) {
+        _curvesLayer = image;
+        _curvesLayerT = _layerJobT;
+    }
+    viewport()->update();
+}
+
+void CurvesView::_paintCurvesLayer(QPainter &painter, const QTransform &T)
+{
+    painter.setRenderHint(QPainter::Antialiasing);
     QPen pen;
-    pen.setWidthF(ptSizeCurve);
+    pen.setWidthF(0.0);
     painter.setPen(pen);
 
-    // Draw curves
-    if ( nCurves == 2 ) {
-        QString plotPresentation = _bookModel()->getDataString(rootIndex(),
-                                                     "PlotPresentation","Plot");
-        if ( plotPresentation.isEmpty() ) {
-            plotPresentation = _bookModel()->getDataString(QModelIndex(),
-                                                           "Presentation");
-        }
+    QModelIndex pageIdx = rootIndex().parent().parent();
+    QColor bg = _bookModel()->pageBackgroundColor(pageIdx);
+    painter.fillRect(viewport()->rect(),bg);
 
-        // Plot background
-        QModelIndex pageIdx = rootIndex().parent().parent();
-        QColor bg = _bookModel()->pageBackgroundColor(pageIdx);
-        painter.fillRect(viewport()->rect(),bg);
+    _paintGrid(painter,rootIndex());
 
-        _paintGrid(painter,rootIndex());
+    QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
+    int nCurves = model()->rowCount(curvesIdx);
 
+    bool isCoplot = true;
+    bool isErrorplot = false;
+    if ( nCurves == 2 ) {
+        QString plotPresentation = _plotPresentation();
         if ( plotPresentation == "compare" ) {
-            _paintCoplot(T,painter,pen);
+            isCoplot = true;
         } else if ( plotPresentation == "error" ) {
-            _paintErrorplot(T,painter,pen,rootIndex());
+            isCoplot = false;
+            isErrorplot = true;
         } else if ( plotPresentation == "error+compare" ) {
-            _paintCoplot(T,painter,pen);
-            _paintErrorplot(T,painter,pen,rootIndex()); // overlay err on coplot
+            isErrorplot = true;
         } else {
-            fprintf(stderr,"koviz [bad scoobs]: paintEvent() : "
+            fprintf(stderr,"koviz [bad scoobs]: _paintCurvesLayer() : "
                            "PlotPresentation=\"%s\" not recognized.\n",
                            plotPresentation.toLatin1().constData());
             exit(-1);
         }
-    } else {
-        _paintCoplot(T,painter,pen);
     }
 
-    // Restore the painter state off the painter stack
-    painter.restore();
-
-    // Draw legend (if needed)
-    _paintCurvesLegend(viewport()->rect(),curvesIdx,painter);
-
-    // Draw markers
-    _paintMarkers(painter);
-
-    if ( _isMeasure ) {
-        painter.drawEllipse(_mousePressPos,3,3);
-        painter.drawEllipse(_mouseCurrPos,2,2);
-        painter.drawLine(_mousePressPos,_mouseCurrPos);
+    if ( isCoplot ) {
+        for ( int i = 0; i < nCurves; ++i ) {
+            QModelIndex curveIdx = model()->index(i,0,curvesIdx);
+            _paintCurve(curveIdx,T,painter,false);
+        }
+    }
+    if ( isErrorplot ) {
+        _paintErrorplot(T,painter,pen,rootIndex()); // overlay err on coplot
     }
-#endif
 }
 
-
-void CurvesView::_paintCoplot(const QTransform &T,QPainter &painter,QPen &pen)
+// Unselected curves are lightened with a semi-transparent bg and the
+// current curve is painted highlighted on top
+void CurvesView::_updateSelectionLayer()
 {
-    Q_UNUSED(pen);
+    _isSelectionLayerStale = false;
+    _selectionLayer = QImage();
 
-    if ( !_pixmap ) return;
+    if ( _curvesLayer.isNull() || !_isCurrentCurveInPlot() ) {
+        return;
+    }
+    QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
+    int nCurves = model()->rowCount(curvesIdx);
+    QString plotPresentation;
+    if ( nCurves == 2 ) {
+        plotPresentation = _plotPresentation();
+        if ( plotPresentation == "error" ) {
+            return;
+        }
+    }
 
-    painter.save();
+    _selectionLayer = QImage(viewport()->size(),
+                             QImage::Format_ARGB32_Premultiplied);
+    _selectionLayer.fill(Qt::transparent);
+    QPainter painter(&_selectionLayer);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QPen pen;
+    pen.setWidthF(0.0);
+    painter.setPen(pen);
 
-    // Draw pixmap of all curves
-    QTransform I;
-    painter.setTransform(I);
-    painter.drawPixmap(viewport()->rect(),*_pixmap);
+    QModelIndex pageIdx = rootIndex().parent().parent();
+    QColor bg = _bookModel()->pageBackgroundColor(pageIdx);
+    bg.setAlpha(190);
+    painter.fillRect(viewport()->rect(),bg);
 
-    // If curve is selected
-    QModelIndex gpidx = currentIndex().parent().parent();
-    QString tag = model()->data(currentIndex()).toString();
-    if ( currentIndex().isValid() && tag == "Curve" && gpidx == rootIndex()) {
+    // Since grid is too light with semi-transparent bg, paint it
+    _paintGrid(painter,rootIndex());
 
-        // Lighten unselected curves to semi-transparent bg
-        QModelIndex pageIdx = rootIndex().parent().parent();
-        QColor bg = _bookModel()->pageBackgroundColor(pageIdx);
-        bg.setAlpha(190);
-        painter.fillRect(viewport()->rect(),bg);
+    // Paint curve (possibly with linestyle, symbols etc.)
+    QTransform T = _coordToPixelTransform();
+    _paintCurve(currentIndex(),T,painter,true);
 
-        // Since grid is too light with semi-transparent bg, paint it
-        _paintGrid(painter,rootIndex());
+    if ( plotPresentation == "error+compare" ) {
+        _paintErrorplot(T,painter,pen,rootIndex());
+    }
+}
 
-        // Paint curve (possibly with linestyle, symbols etc.)
-        _paintCurve(currentIndex(),T,painter,true);
+void CurvesView::_updateLegendLayer()
+{
+    _isLegendLayerStale = false;
+    _legendLayer = QImage();
+
+    QSize size = viewport()->size();
+    if ( size.width() == 0 || size.height() == 0 ) {
+        return;
+    }
+    bool isCurves  = _bookModel()->isChildIndex(rootIndex(),"Plot","Curves");
+    if ( !isCurves ) {
+        return;
     }
 
-    painter.restore();
+    _legendLayer = QImage(size,QImage::Format_ARGB32_Premultiplied);
+    _legendLayer.fill(Qt::transparent);
+    QPainter painter(&_legendLayer);
+    QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
+    _paintCurvesLegend(viewport()->rect(),curvesIdx,painter);
 }
 
 void CurvesView::_paintCurve(const QModelIndex& curveIdx,
@@ -220,15 +397,14 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
     painter.save();
     QPen origPen = painter.pen();
 
-    CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
+    CurveProps props = _bookModel()->curveProps(curveIdx);
 
-    if ( curveModel ) {
+    if ( props.curveModel ) {
 
         // Line color
         QPen pen;
         pen.setWidth(0);
-        QColor color(_bookModel()->getDataString(curveIdx,
-                                                 "CurveColor","Curve"));
+        QColor color(props.color);
         if ( isHighlight ) {
             QModelIndex pageIdx = curveIdx.parent().parent().parent().parent();
             QColor bg = _bookModel()->pageBackgroundColor(pageIdx);
@@ -241,23 +417,18 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
         pen.setColor(color);
 
         // Line style pattern
-        QString linestyle =  _bookModel()->getDataString(curveIdx,
-                                                      "CurveLineStyle","Curve");
-        QVector<qreal> pattern = _bookModel()->getLineStylePattern(linestyle);
+        QVector<qreal> pattern = props.linePattern;
         pen.setDashPattern(pattern);
 
         // Set pen
         painter.setPen(pen);
 
-        // Get painter path
-        QPainterPath* path = _bookModel()->getPainterPath(curveIdx);
+        // Get curve points
+        CurvePoints* points = _bookModel()->getCurvePoints(curveIdx);
 
         // Get plot scale
         QModelIndex plotIdx = curveIdx.parent().parent();
-        QString plotXScale = _bookModel()->getDataString(plotIdx,
-                                                         "PlotXScale","Plot");
-        QString plotYScale = _bookModel()->getDataString(plotIdx,
-                                                         "PlotYScale","Plot");
+        PlotProps plotProps = _bookModel()->plotProps(plotIdx);
 
         // Scale transform (e.g. for unit axis scaling)
         // If logscale, scale/bias done in _createPainterPath
@@ -265,13 +436,13 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
         double ys = 1.0;
         double xb = 0.0;
         double yb = 0.0;
-        if ( plotXScale == "linear" ) {
-            xs = _bookModel()->xScale(curveIdx);
-            xb = _bookModel()->xBias(curveIdx);
+        if ( plotProps.xScale == "linear" ) {
+            xs = props.xScale;
+            xb = props.xBias;
         }
-        if ( plotYScale == "linear" ) {
-            ys = _bookModel()->yScale(curveIdx);
-            yb = _bookModel()->yBias(curveIdx);
+        if ( plotProps.yScale == "linear" ) {
+            ys = props.yScale;
+            yb = props.yBias;
         }
         QTransform Tscaled(T);
         Tscaled = Tscaled.scale(xs,ys);
@@ -279,10 +450,10 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
         painter.setTransform(Tscaled);
 
         // Draw "Flatline=#" label if curve is flat (constant)
-        QRectF cbox = path->boundingRect();
-        if ( cbox.height() == 0.0 && path->elementCount() > 0 ) {
+        QRectF cbox = points->boundingRect();
+        if ( cbox.height() == 0.0 && points->count() > 0 ) {
             double y = cbox.y()*ys+yb;
-            if (plotYScale=="log") {
+            if ( plotProps.isYLogScale ) {
                 y = pow(10,y) ;
             }
             QString yString = QString("Flatline=%1").arg(y);
@@ -300,7 +471,9 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
                                  +QPointF(0,5),yString);
             }
             painter.setTransform(Tscaled);
-        } else if ( path->elementCount() == 0 ) {
+        } else if ( points->count() == 0 &&
+                    ( !_bookModel()->isCurvePointsPending(curveIdx) ||
+                      _bookModel()->isCurveDataEmpty(curveIdx) ) ) {
             // Empty plot
             QTransform I;
             painter.setTransform(I);
@@ -312,9 +485,7 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
         }
 
         // Line style
-        QString lineStyle = _bookModel()->getDataString(curveIdx,
-                                                      "CurveLineStyle","Curve");
-        lineStyle = lineStyle.toLower();
+        const QString& lineStyle = props.lineStyle;
 
         // Draw curve!
         if ( lineStyle == "thick_line" || lineStyle == "x_thick_line" ) {
@@ -333,10 +504,9 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
             }
             painter.setPen(pen);
             QPointF pLast;
-            for ( int i = 0; i < path->elementCount(); ++i ) {
-                QPainterPath::Element el = path->elementAt(i);
-                QPointF p(el.x,el.y);
-                p = Tscaled.map(p);
+            int n = points->count();
+            for ( int i = 0; i < n; ++i ) {
+                QPointF p = Tscaled.map(points->at(i));
                 if  ( i > 0 ) {
                     painter.drawLine(pLast,p);
                 }
@@ -356,10 +526,9 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
             brush.setColor(color);
             painter.setBrush(brush);
             double r = pen.widthF();
-            for ( int i = 0; i < path->elementCount(); ++i ) {
-                QPainterPath::Element el = path->elementAt(i);
-                QPointF p(el.x,el.y);
-                p = Tscaled.map(p);
+            int n = points->count();
+            for ( int i = 0; i < n; ++i ) {
+                QPointF p = Tscaled.map(points->at(i));
                 painter.drawEllipse(p,r,r);
             }
             pen.setWidthF(w);
@@ -367,13 +536,22 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
             painter.setBrush(origBrush);
             painter.setTransform(Tscaled);
         } else {
-            painter.drawPath(*path);
+            CurveLOD* lod = _bookModel()->getCurveLOD(curveIdx);
+            if ( lod ) {
+                // Only draw the visible part of the curve at about
+                // the resolution of the viewport
+                QRectF R(viewport()->rect());
+                QRectF V = Tscaled.inverted().mapRect(R);
+                QPainterPath lodPath = lod->path(V.left(),V.right(),
+                                                 viewport()->width());
+                painter.drawPath(lodPath);
+            } else {
+                painter.drawPath(points->toPainterPath());
+            }
         }
 
         // Draw symbols on curve (if there are any)
-        QString symbolStyle = _bookModel()->getDataString(curveIdx,
-                                               "CurveSymbolStyle", "Curve");
-        symbolStyle = symbolStyle.toLower();
+        const QString& symbolStyle = props.symbolStyle;
         if ( !symbolStyle.isEmpty() && symbolStyle != "none" ) {
             pattern.clear();
             pen.setDashPattern(pattern); // plain lines for drawing symbols
@@ -383,10 +561,9 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
             pen.setWidthF(0.0);
             painter.setPen(pen);
             QPointF pLast;
-            for ( int i = 0; i < path->elementCount(); ++i ) {
-                QPainterPath::Element el = path->elementAt(i);
-                QPointF p(el.x,el.y);
-                p = Tscaled.map(p);
+            int n = points->count();
+            for ( int i = 0; i < n; ++i ) {
+                QPointF p = Tscaled.map(points->at(i));
                 if ( i > 0 ) {
                     double r = 32.0;
                     double x = pLast.x()-r/2.0;
@@ -511,20 +688,20 @@ void CurvesView::_paintMarkers(QPainter &painter)
             }
         }
 
-        // Get path
-        QPainterPath* path = 0;
+        // Get curve points
+        CurvePoints* points = 0;
         if ( tag == "Curve" ) {
             QModelIndex curveIdx = marker->modelIdx();
-            path = _bookModel()->getPainterPath(curveIdx);
+            points = _bookModel()->getCurvePoints(curveIdx);
         } else if ( tag == "Plot" ) {
             QModelIndex plotIdx = marker->modelIdx();
             QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,
                                                            "Curves","Plot");
-            path = _bookModel()->getCurvesErrorPath(curvesIdx);
+            points = _bookModel()->getCurvesErrorPoints(curvesIdx);
         }
-        if ( path->elementCount() == 0 ) {
+        if ( points->count() == 0 ) {
             if ( tag == "Plot" ) {
-                delete path; // error path created on the fly!
+                delete points; // error points created on the fly!
             }
             continue;
         }
@@ -542,13 +719,13 @@ void CurvesView::_paintMarkers(QPainter &painter)
         }
 
         // Get element index (i) for time (t)
-        int high = path->elementCount()-1;
-        int i = _idxAtTimeBinarySearch(path,0,high,t);
+        int high = points->count()-1;
+        int i = _idxAtTimeBinarySearch(points,0,high,t);
 
         /* There may be duplicate timestamps in sequence - go to first */
-        double elementTime = path->elementAt(i).x;
+        double elementTime = points->x(i);
         while ( i > 0 ) {
-            if ( path->elementAt(i-1).x == elementTime ) {
+            if ( points->x(i-1) == elementTime ) {
                 --i;
             } else {
                 break;
@@ -564,7 +741,7 @@ void CurvesView::_paintMarkers(QPainter &painter)
             CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
             curveModel->map();
             QModelIndex plotIdx = marker->modelIdx().parent().parent();
-            int nels = path->elementCount();
+            int nels = points->count();
             int npts = curveModel->rowCount();
             if ( !_bookModel()->isXTime(plotIdx) || nels != npts ) {
                 // If X is not time, then x is e.g. xpos in ball xy orbit
@@ -610,8 +787,7 @@ void CurvesView::_paintMarkers(QPainter &painter)
                     }
                     int j = (i < nels) ? i : nels - 1;
                     while ( j >= 0 ) {
-                        QPainterPath::Element el = path->elementAt(j);
-                        if ( el.x == x && el.y == y ) {
+                        if ( points->x(j) == x && points->y(j) == y ) {
                             i = j;
                             break;
                         }
@@ -648,8 +824,7 @@ void CurvesView::_paintMarkers(QPainter &painter)
         }
 
         // Element/coord at live time
-        QPainterPath::Element el = path->elementAt(i);
-        QPointF coord(el.x*xs+xb,el.y*ys+yb);
+        QPointF coord(points->x(i)*xs+xb,points->y(i)*ys+yb);
 
         // Init arrow struct
         CoordArrow arrow;
@@ -658,12 +833,12 @@ void CurvesView::_paintMarkers(QPainter &painter)
         // Set arrow text (special syntax for extremums)
         QString x=isXLogScale ? _format(pow(10,coord.x())) : _format(coord.x());
         QString y=isYLogScale ? _format(pow(10,coord.y())) : _format(coord.y());
-        int rc = path->elementCount();
+        int rc = points->count();
         if ( i > 0 && i < rc-1) {
             // First and last point not considered
-            double yPrev = path->elementAt(i-1).y*ys+yb;
-            double yi = path->elementAt(i).y*ys+yb;
-            double yNext = path->elementAt(i+1).y*ys+yb;
+            double yPrev = points->y(i-1)*ys+yb;
+            double yi = points->y(i)*ys+yb;
+            double yNext = points->y(i+1)*ys+yb;
             if ( (yi>yPrev && yi>yNext) || (yi<yPrev && yi<yNext) ) {
                 arrow.txt = QString("<%1, %2>").arg(x).arg(y);
             } else if ( yPrev == yi && yi != yNext ) {
@@ -720,7 +895,7 @@ void CurvesView::_paintMarkers(QPainter &painter)
         }
 
         if ( tag == "Plot" ) {
-            delete path; // error path created on the fly, so it must be freed
+            delete points; // error points created on the fly, so it must be freed
         }
     }
 
@@ -731,24 +906,24 @@ void CurvesView::_paintMarkers(QPainter &painter)
     }
 }
 
-int CurvesView::_idxAtTimeBinarySearch(QPainterPath* path,
+int CurvesView::_idxAtTimeBinarySearch(CurvePoints* points,
                                        int low, int high, double time)
 {
-        if (high <= 0 ) {
-                return 0;
-        }
-        if (low >= high) {
-                return ( path->elementAt(high).x > time ) ? high-1 : high;
-        } else {
+        const double* x = points->xData();
+        while ( true ) {
+                if (high <= 0 ) {
+                        return 0;
+                }
+                if (low >= high) {
+                        return ( x[high] > time ) ? high-1 : high;
+                }
                 int mid = (low + high)/2;
-                if (time == path->elementAt(mid).x ) {
+                if (time == x[mid] ) {
                         return mid;
-                } else if ( time < path->elementAt(mid).x ) {
-                        return _idxAtTimeBinarySearch(path,
-                                                      low, mid-1, time);
+                } else if ( time < x[mid] ) {
+                        high = mid-1;
                 } else {
-                        return _idxAtTimeBinarySearch(path,
-                                                      mid+1, high, time);
+                        low = mid+1;
                 }
         }
 }
@@ -945,9 +1120,9 @@ void CurvesView::_paintErrorplot(const QTransform &T,
     painter.save();
 
     QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,"Curves","Plot");
-    QPainterPath* errorPath = _bookModel()->getCurvesErrorPath(curvesIdx);
+    CurvePoints* errorPoints = _bookModel()->getCurvesErrorPoints(curvesIdx);
 
-    QRectF ebox = errorPath->boundingRect();
+    QRectF ebox = errorPoints->boundingRect();
     QPen ePen(pen);
     if ( ebox.height() == 0.0 && ebox.y() == 0.0 ) {
         // Color green if error plot is flatline zero
@@ -956,7 +1131,7 @@ void CurvesView::_paintErrorplot(const QTransform &T,
         ePen.setColor(_bookModel()->errorLineColor());
     }
     painter.setPen(ePen);
-    if ( ebox.height() == 0.0 && errorPath->elementCount() > 0 ) {
+    if ( ebox.height() == 0.0 && errorPoints->count() > 0 ) {
         // Flatline
         QString yval;
         if ( ebox.y() == 0.0 ) {
@@ -968,7 +1143,7 @@ void CurvesView::_paintErrorplot(const QTransform &T,
         painter.setTransform(I);
         QRectF tbox = T.mapRect(ebox);
         painter.drawText(tbox.topLeft()-QPointF(0,5),yval);
-    } else if ( errorPath->elementCount() == 0 ) {
+    } else if ( errorPoints->count() == 0 ) {
         // Empty plot
         QTransform I;
         painter.setTransform(I);
@@ -978,9 +1153,9 @@ void CurvesView::_paintErrorplot(const QTransform &T,
         painter.drawText(R.center()+QPointF(-bb.width()/2,0),lbl);
     }
     painter.setTransform(T);
-    painter.drawPath(*errorPath);
+    painter.drawPath(errorPoints->toPainterPath());
 
-    delete errorPath;
+    delete errorPoints;
 
     painter.setPen(pen);
     painter.restore();
@@ -1012,13 +1187,10 @@ void CurvesView::dataChanged(const QModelIndex &topLeft,
         QRectF M = model()->data(topLeft).toRectF();
 
         if ( M.size().width() > 0 && M.size().height() != 0 && _lastM != M ) {
-            if ( _pixmap ) {
-                delete _pixmap;
-            }
-            _pixmap = _createLivePixmap();
+            _invalidateLayers();
         }
 
-        _lastM = M;  // Saved so that pixmap is not recreated if M unchanged
+        _lastM = M;  // Saved so that layers are not redone if M unchanged
 
     } else if ( tag == "PlotMathRect" && topLeft.parent() != rootIndex() ) {
         // Another plot has changed its PlotMathRect.
@@ -1064,77 +1236,33 @@ void CurvesView::dataChanged(const QModelIndex &topLeft,
             }
         }
     } else if ( topLeft.parent().parent().parent() == rootIndex() ) {
-        if ( tag == "CurveXBias" ) {
-            if ( _pixmap ) {
-                delete _pixmap;
-            }
-            _pixmap = _createLivePixmap();
-        } else if ( tag == "CurveYBias" ) {
-            if ( _pixmap ) {
-                delete _pixmap;
-            }
-            _pixmap = _createLivePixmap();
-        } else if ( tag == "CurveColor") {
-            if ( _pixmap ) {
-                delete _pixmap;
-            }
-            _pixmap = _createLivePixmap();
-        } else if ( tag == "CurveData") {
-            if ( _pixmap ) {
-                delete _pixmap;
-            }
-            _pixmap = _createLivePixmap();
-        }
+        // Curve bias, color, data, linestyle etc.
+        _invalidateLayers();
     } else if ( topLeft.parent() == rootIndex() ) {
+        _invalidateLayers();
         if ( tag == "PlotXScale" || tag == "PlotYScale" ) {
-            if ( _pixmap ) {
-                delete _pixmap;
-            }
-            _pixmap = _createLivePixmap();
             QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),
                                                            "Curves","Plot");
             QRectF bbox = _bookModel()->calcCurvesBBox(curvesIdx);
             _bookModel()->setPlotMathRect(bbox,rootIndex());
         }
+    } else if ( topLeft.parent() == rootIndex().parent().parent() ) {
+        // Page background/foreground color
+        _invalidateLayers();
+    } else if ( !topLeft.parent().isValid() ) {
+        // Presentation, legend, colors etc. but not what changes as
+        // the mouse moves, which is painted on the overlay
+        if ( tag != "LiveCoordTime" && tag != "LiveCoordTimeIndex" &&
+             tag != "IsShowLiveCoord" && tag != "StatusBarMessage" &&
+             !tag.startsWith("Button") ) {
+            _invalidateLayers();
+        }
     }
 
     viewport()->update();
     update();
 }
 
-QPixmap* CurvesView::_createLivePixmap()
-{
-    if ( viewport()->rect().size().width() == 0 ||
-         viewport()->rect().size().height() == 0 ) {
-        return 0;
-    }
-    bool isCurves  = _bookModel()->isChildIndex(rootIndex(),"Plot","Curves");
-    if ( !isCurves ) {
-        return 0;
-    }
-
-    QPixmap* livePixmap = new QPixmap(viewport()->rect().size());
-
-    QPainter painter(livePixmap);
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    QModelIndex pageIdx = rootIndex().parent().parent();
-    QColor bg = _bookModel()->pageBackgroundColor(pageIdx);
-    painter.fillRect(viewport()->rect(),bg);
-
-    _paintGrid(painter, rootIndex());
-
-    QTransform T = _coordToPixelTransform();
-    QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
-    int rc = model()->rowCount(curvesIdx);
-    for ( int i = 0; i < rc; ++i ) {
-        QModelIndex curveIdx = model()->index(i,0,curvesIdx);
-        _paintCurve(curveIdx,T,painter,false);
-    }
-
-    return livePixmap;
-}
-
 QString CurvesView::_format(double d)
 {
     QString s;
@@ -1353,14 +1481,14 @@ QModelIndex CurvesView::_chooseCurveNearMousePoint(const QPoint &pt)
         // fill image with white (see help for QImage::fill(int))
         img.fill(1);
 
-        // Get underlying path that goes with curve
+        // Get underlying points that go with curve
         QModelIndex curveIdx = model()->index(i,0,curvesIdx);
-        QPainterPath* path = _bookModel()->getPainterPath(curveIdx);
-        if ( !path ) {
+        CurvePoints* points = _bookModel()->getCurvePoints(curveIdx);
+        if ( !points ) {
             continue;
         }
 
-        // Get xy scale/bias (logscale path is already biased/scaled)
+        // Get xy scale/bias (logscale points are already biased/scaled)
         double xs = 1.0;
         double xb = 0.0;
         double ys = 1.0;
@@ -1378,18 +1506,25 @@ QModelIndex CurvesView::_chooseCurveNearMousePoint(const QPoint &pt)
         Tscaled = Tscaled.translate(xb/xs,yb/ys);
         painter.setTransform(Tscaled);
 
-        // Ignore paths whose bounding box does not intersect
+        // Ignore curves whose bounding box does not intersect
         // math click rect. This speeds up a special case of
         // selecting a spike which falls outside most other curves
         if ( xs == 1.0 && ys == 1.0 && xb == 0 && yb == 0 ) {
             // TODO: Lazily checking for xs==ys==1.0 because of scaling issues
-            if ( !path->intersects(M) ) {
+            if ( !points->isBoundingRectIntersects(M) ) {
                 continue;
             }
         }
 
         // Draw curve onto monochrome image (clipped to small square)
-        painter.drawPath(*path);
+        // Only the part of the curve under the square is needed
+        CurveLOD* lod = _bookModel()->getCurveLOD(curveIdx);
+        if ( lod ) {
+            QRectF V = Tscaled.inverted().mapRect(R);
+            painter.drawPath(lod->path(V.left(),V.right(),s));
+        } else {
+            painter.drawPath(points->toPainterPath());
+        }
 
         // Check, pixel by pixel, to see if the curve
         // is in small rectangle around mouse click
@@ -1452,18 +1587,18 @@ bool CurvesView::_isErrorCurveNearMousePoint(const QPoint &pt)
     M = U.mapRect(R);
 
     QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
-    QPainterPath* path = _bookModel()->getCurvesErrorPath(curvesIdx);
-    if ( path ) {
+    CurvePoints* points = _bookModel()->getCurvesErrorPoints(curvesIdx);
+    if ( points ) {
 
         // fill image with white (see help for QImage::fill(int))
         img.fill(1);
 
         painter.setTransform(T);
 
-        if ( path->intersects(M) ) {
+        if ( points->isBoundingRectIntersects(M) ) {
 
             // Draw curve onto monochrome image (clipped to small square)
-            painter.drawPath(*path);
+            painter.drawPath(points->toPainterPath());
 
             // Check, pixel by pixel, to see if the curve
             // is in small rectangle around mouse click
@@ -1486,7 +1621,7 @@ bool CurvesView::_isErrorCurveNearMousePoint(const QPoint &pt)
             }
         }
 
-        delete path;
+        delete points;
     }
 
     return isNear;
@@ -1541,8 +1676,8 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                                                                  QModelIndex(),
                                                                "LiveCoordTime");
 
-                QPainterPath* path = _bookModel()->getPainterPath(curveIdx);
-                int rc = path->elementCount();
+                CurvePoints* points = _bookModel()->getCurvePoints(curveIdx);
+                int rc = points->count();
 
                 QString plotXScale = _bookModel()->getDataString(plotIdx,
                                                            "PlotXScale","Plot");
@@ -1573,14 +1708,11 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
 
                     } else if ( rc == 1 ) {
 
-                        QPainterPath::Element el = path->elementAt(0);
-                        liveCoord = QPointF(el.x,el.y);
+                        liveCoord = points->at(0);
 
                     } else if ( rc == 2 ) {
-                        QPainterPath::Element el0 = path->elementAt(0);
-                        QPainterPath::Element el1 = path->elementAt(1);
-                        QPointF p0(el0.x*xs+xb,el0.y*ys+yb);
-                        QPointF p1(el1.x*xs+xb,el1.y*ys+yb);
+                        QPointF p0(points->x(0)*xs+xb,points->y(0)*ys+yb);
+                        QPointF p1(points->x(1)*xs+xb,points->y(1)*ys+yb);
                         QLineF l0(p0,mPt);
                         QLineF l1(p1,mPt);
                         if ( l0.length() < l1.length() ) {
@@ -1591,10 +1723,9 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
 
                     } else if ( rc >= 3 ) {
 
-                        int i =  _idxAtTimeBinarySearch(path,0,rc-1,
+                        int i =  _idxAtTimeBinarySearch(points,0,rc-1,
                                                         (mPt.x()-xb)/xs);
-                        QPainterPath::Element el = path->elementAt(i);
-                        QPointF p(el.x*xs+xb,el.y*ys+yb);
+                        QPointF p(points->x(i)*xs+xb,points->y(i)*ys+yb);
 
                         //
                         // Make "neighborhood" around mouse point
@@ -1607,12 +1738,12 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                         // Set j/k for finding min/maxs in next block of code
                         int j = i;
                         int k = i;
-                        int nels = path->elementCount();
-                        double iTime = path->elementAt(i).x;
+                        int nels = points->count();
+                        double iTime = points->x(i);
                         double startTime = iTime - Mr;
                         double endTime = iTime + Mr;
                         for ( int l = i ; l >= 0; --l ) {
-                            double lTime = path->elementAt(l).x;
+                            double lTime = points->x(l);
                             if ( lTime > startTime ) {
                                 j = l;
                             } else {
@@ -1620,7 +1751,7 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                             }
                         }
                         for ( int l = i ; l < nels; ++l ) {
-                            double lTime = path->elementAt(l).x;
+                            double lTime = points->x(l);
                             if ( lTime < endTime ) {
                                 k = l;
                             } else {
@@ -1635,12 +1766,12 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                         QList<QPointF> localMins;
                         QList<QPointF> flatChangePOIs;
                         for (int m = j; m <= k; ++m ) {
-                            QPointF pt(path->elementAt(m).x*xs+xb,
-                                       path->elementAt(m).y*ys+yb);
+                            QPointF pt(points->x(m)*xs+xb,
+                                       points->y(m)*ys+yb);
                             if ( m > 0 && m < k ) {
-                                double yPrev = path->elementAt(m-1).y*ys+yb;
-                                double y  = path->elementAt(m).y*ys+yb;
-                                double yNext = path->elementAt(m+1).y*ys+yb;
+                                double yPrev = points->y(m-1)*ys+yb;
+                                double y  = points->y(m)*ys+yb;
+                                double yNext = points->y(m+1)*ys+yb;
                                 if ( y > yPrev && y > yNext ) {
                                     if ( localMaxs.isEmpty() ) {
                                         localMaxs << pt;
@@ -1682,13 +1813,13 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                         if ( j == 0 || wPt.x()/W.width() < 0.02 ) {
                             // Mouse near curve start or left 2% of window,
                             // set to start pt
-                            liveCoord = QPointF(path->elementAt(0).x*xs+xb,
-                                                path->elementAt(0).y*ys+yb);
+                            liveCoord = QPointF(points->x(0)*xs+xb,
+                                                points->y(0)*ys+yb);
                         } else if ( k == rc-1 || wPt.x()/W.width() > 0.98 ) {
                             // Mouse near curve end or right 2% of window,
                             // set to last pt
-                            liveCoord = QPointF(path->elementAt(k).x*xs+xb,
-                                                path->elementAt(k).y*ys+yb);
+                            liveCoord = QPointF(points->x(k)*xs+xb,
+                                                points->y(k)*ys+yb);
                         } else {
                             bool isMaxs = localMaxs.isEmpty() ? false : true;
                             bool isMins = localMins.isEmpty() ? false : true;
@@ -1744,22 +1875,22 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                         if ( plotXScale == "log") {
                             time = log10(time);
                         }
-                        int i =  _idxAtTimeBinarySearch(path,0,
+                        int i =  _idxAtTimeBinarySearch(points,0,
                                                         rc-1,(time-xb)/xs);
-                        double iTime = path->elementAt(i).x;
+                        double iTime = points->x(i);
                         int j = i;  // j is start index of identical timestamps
                         for ( int l = i; l >= 0; --l ) {
-                            double lTime = path->elementAt(l).x;
+                            double lTime = points->x(l);
                             if ( iTime != lTime ) {
                                 break;
                             } else {
                                 j = l;
                             }
                         }
-                        int nels = path->elementCount();
+                        int nels = points->count();
                         int k = j; // k is last index of identical timestamps
                         for (int l = j; l < nels; ++l) {
-                            double lTime = path->elementAt(l).x;
+                            double lTime = points->x(l);
                             if ( iTime != lTime ) {
                                 break;
                             } else {
@@ -1775,8 +1906,8 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                             double maxY = -DBL_MAX;
                             int m = 0 ;
                             for (int l = j; l <= k; ++l) {
-                                double x = path->elementAt(l).x;
-                                double y = path->elementAt(l).y;
+                                double x = points->x(l);
+                                double y = points->y(l);
                                 if ( y > maxY ) {
                                     maxY = y;
                                     liveCoordTimeIdx = m;
@@ -1872,15 +2003,15 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
 
             // TODO: This code block is almost a duplicate of the code block
             //       above for compare plot.  The difference is that the
-            //       error data is an unscaled/biased QPainterPath.
+            //       error data is unscaled/biased CurvePoints.
             QModelIndex curvesIdx =  _bookModel()->getIndex(rootIndex(),
                                                             "Curves","Plot");
-            QPainterPath* path = _bookModel()->getCurvesErrorPath(curvesIdx);
+            CurvePoints* points = _bookModel()->getCurvesErrorPoints(curvesIdx);
             QModelIndex liveTimeIdx = _bookModel()->getDataIndex(
                                                                QModelIndex(),
                                                                "LiveCoordTime");
 
-            int rc = path->elementCount();
+            int rc = points->count();
             QPointF liveCoord(DBL_MAX,DBL_MAX);
 
             if ( rc == 0 ) {
@@ -1890,15 +2021,12 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
 
             } else if ( rc == 1 ) {
 
-                QPainterPath::Element el = path->elementAt(0);
-                liveCoord = QPointF(el.x,el.y);
+                liveCoord = points->at(0);
 
             } else if ( rc == 2 ) {
 
-                QPainterPath::Element el0 = path->elementAt(0);
-                QPainterPath::Element el1 = path->elementAt(1);
-                QPointF p0(el0.x,el0.y);
-                QPointF p1(el1.x,el1.y);
+                QPointF p0 = points->at(0);
+                QPointF p1 = points->at(1);
                 QLineF l0(p0,mPt);
                 QLineF l1(p1,mPt);
                 if ( l0.length() < l1.length() ) {
@@ -1909,9 +2037,8 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
 
             } else if ( rc >= 3 ) {
 
-                int i =  _idxAtTimeBinarySearch(path,0,rc-1,mPt.x());
-                QPainterPath::Element el = path->elementAt(i);
-                QPointF p(el.x,el.y);
+                int i =  _idxAtTimeBinarySearch(points,0,rc-1,mPt.x());
+                QPointF p = points->at(i);
 
                 //
                 // Make "neighborhood" around mouse point
@@ -1924,12 +2051,12 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                 // Set j and k for finding min/maxs
                 int j = i;
                 int k = i;
-                int nels = path->elementCount();
-                double iTime = path->elementAt(i).x;
+                int nels = points->count();
+                double iTime = points->x(i);
                 double startTime = iTime - Mr;
                 double endTime = iTime + Mr;
                 for ( int l = i ; l >= 0; --l ) {
-                    double lTime = path->elementAt(l).x;
+                    double lTime = points->x(l);
                     if ( lTime > startTime ) {
                         j = l;
                     } else {
@@ -1937,7 +2064,7 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                     }
                 }
                 for ( int l = i ; l < nels; ++l ) {
-                    double lTime = path->elementAt(l).x;
+                    double lTime = points->x(l);
                     if ( lTime < endTime ) {
                         k = l;
                     } else {
@@ -1951,11 +2078,11 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                 QList<QPointF> localMaxs;
                 QList<QPointF> localMins;
                 for (int m = j; m <= k; ++m ) {
-                    QPointF pt(path->elementAt(m).x,path->elementAt(m).y);
+                    QPointF pt = points->at(m);
                     if ( m > 0 && m < k ) {
-                        double yPrev = path->elementAt(m-1).y;
-                        double y  = path->elementAt(m).y;
-                        double yNext = path->elementAt(m+1).y;
+                        double yPrev = points->y(m-1);
+                        double y  = points->y(m);
+                        double yNext = points->y(m+1);
                         if ( y > yPrev && y > yNext ) {
                             if ( localMaxs.isEmpty() ) {
                                 localMaxs << pt;
@@ -1986,12 +2113,12 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                 //
                 if ( j == 0 ) {
                     // Mouse near start of curve, set to start pt
-                    liveCoord = QPointF(path->elementAt(0).x,
-                                        path->elementAt(0).y);
+                    liveCoord = QPointF(points->x(0),
+                                        points->y(0));
                 } else if ( k == rc-1 ) {
                     // Mouse near end of curve, set to last pt
-                    liveCoord = QPointF(path->elementAt(k).x,
-                                        path->elementAt(k).y);
+                    liveCoord = QPointF(points->x(k),
+                                        points->y(k));
                 } else {
                     bool isMaxs = localMaxs.isEmpty() ? false : true;
                     bool isMins = localMins.isEmpty() ? false : true;
@@ -2017,6 +2144,7 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
                     }
                 }
             }
+            delete points; // error points are created on the fly
 
             // Set live coord in model
             double start = _bookModel()->getDataDouble(QModelIndex(),
@@ -2285,7 +2413,9 @@ void CurvesView::keyPressEvent(QKeyEvent *event)
     case Qt::Key_Right: _keyPressArrow(Qt::RightArrow);break;
     case Qt::Key_Comma: _keyPressComma();break;
     case Qt::Key_Escape: _keyPressEscape();break;
-    case Qt::Key_F: _keyPressF();break;
+    case Qt::Key_F:
+        _keyPressF(event->modifiers() & Qt::ShiftModifier);
+        break;
     case Qt::Key_B: _keyPressB();break;
     case Qt::Key_G: _keyPressG();break;
     case Qt::Key_D: _keyPressD();break;
@@ -2325,15 +2455,13 @@ void CurvesView::currentChanged(const QModelIndex &current,
             _bookModel()->setData(liveIdx, "");
         }
     }
+    _isSelectionLayerStale = true;
     viewport()->update();
 }
 
 void CurvesView::resizeEvent(QResizeEvent *event)
 {
-    if ( _pixmap ) {
-        delete _pixmap;
-    }
-    _pixmap = _createLivePixmap();
+    _invalidateLayers();  // curve layer is redone on the next paint
 
     QAbstractItemView::resizeEvent(event);
 }
@@ -2484,8 +2612,11 @@ void CurvesView::_keyPressEscape()
 }
 
 // Toggle between Time and Frequency domain
-void CurvesView::_keyPressF()
+// Shift+F shows Welch power spectral densities instead of DFT magnitudes
+void CurvesView::_keyPressF(bool isWelch)
 {
+    _cancelFilterJobs(); // curves are about to be replaced
+
     QModelIndex plotIdx = rootIndex();
     QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,"Curves","Plot");
     QModelIndexList curveIdxs = _bookModel()->getIndexList(curvesIdx,
@@ -2542,7 +2673,9 @@ void CurvesView::_keyPressF()
         _fftCache.start = _bookModel()->data(startTimeIdx).toDouble();
         _fftCache.stop = _bookModel()->data(stopTimeIdx).toDouble();
         _fftCache.curveCaches.clear();
-        bool block = _bookModel()->blockSignals(true);
+        QList<CurveModel*> curveModels;
+        QVector<double> xbs;
+        QVector<double> xss;
         foreach ( QModelIndex curveIdx, curveIdxs ) {
             CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
             double xb = _bookModel()->getDataDouble(curveIdx,
@@ -2551,10 +2684,17 @@ void CurvesView::_keyPressF()
                                                     "CurveXScale","Curve");
             FFTCurveCache* cache = new FFTCurveCache(xb,xs,curveModel);
             _fftCache.curveCaches.append(cache);
-
-            CurveModel* fft = new CurveModelFFT(curveModel,
-                                                xb,xs,
-                                                M.left(),M.right());
+            curveModels.append(curveModel);
+            xbs.append(xb);
+            xss.append(xs);
+        }
+        QList<CurveModel*> ffts = CurveModelFFT::createCurves(
+                                  curveModels,xbs,xss,M.left(),M.right(),
+                                  isWelch ? CurveModelFFT::WelchPSD :
+                                            CurveModelFFT::Magnitude);
+        bool block = _bookModel()->blockSignals(true);
+        foreach ( QModelIndex curveIdx, curveIdxs ) {
+            CurveModel* fft = ffts.at(i);
             QVariant v = PtrToQVariant<CurveModel>::convert(fft);
             QModelIndex curveDataIdx = _bookModel()->getDataIndex(curveIdx,
                                                            "CurveData","Curve");
@@ -2569,10 +2709,9 @@ void CurvesView::_keyPressF()
             _bookModel()->setData(xScaleIdx,1.0);
             _bookModel()->setData(curveDataIdx,v);
 
+            // Transforms are done, no stopping partway (curves would not
+            // match the frequency domain cache)
             progress.setValue(i++);
-            if (progress.wasCanceled()) {
-                break;
-            }
             QString msg = QString("Loaded %1 of %2 curves")
                              .arg(i).arg(curveIdxs.size());
             progress.setLabelText(msg);
@@ -2754,31 +2893,11 @@ void CurvesView::_keyPressB()
                 return;
             }
 
-            // Cache off original data for later filtering (use _real as cache)
-            curveModel->_real = (double*)malloc(N*sizeof(double));
-
-            it = it->at(0);
-            double goodVal = 0.0;
-            while ( !it->isDone() ) {
-                if ( std::isnan(it->y()) ) {
-                    it->next();
-                    continue;
-                }
-                goodVal = it->y();
-                break;
-            }
+            delete it;
+            curveModel->unmap();
 
-            int i = 0;
-            it = it->at(0);
-            while ( !it->isDone() ) {
-                curveModel->_real[i] = it->y();
-                if ( std::isnan(curveModel->_real[i]) ) {
-                    curveModel->_real[i] = goodVal;
-                }
-                goodVal = curveModel->_real[i];
-                it->next();
-                ++i;
-            }
+            // Cache off original data for later filtering
+            _bwSources.append(_filterSource(curveIdx,curveModel));
         }
     }
     int maxFilterFreq = 0; // Nyquist frequency - 1
@@ -2805,31 +2924,7 @@ void CurvesView::_keyPressB()
 
 void CurvesView::_keyPressBSliderChanged(int value)
 {
-    QModelIndex plotIdx = rootIndex();
-    QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,"Curves","Plot");
-    QModelIndexList curveIdxs = _bookModel()->getIndexList(curvesIdx,
-                                                           "Curve","Curves");
-
-    bool block = _bookModel()->blockSignals(true);
-    foreach ( QModelIndex curveIdx, curveIdxs ) {
-        CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
-        if ( curveModel ) {
-            CurveModel* bw = new CurveModelBW(curveModel,value);
-            QVariant v = PtrToQVariant<CurveModel>::convert(bw);
-            QModelIndex curveDataIdx = _bookModel()->getDataIndex(curveIdx,
-                                                           "CurveData","Curve");
-            _bookModel()->setData(curveDataIdx,v);
-            curveModel->_real = 0; // Zero out cache since bw now owns it
-            delete curveModel;
-        }
-    }
-    _bookModel()->blockSignals(block);
-
-    // Reset bounding box so that plot refreshes (optimizing redraw)
-    QRectF Z; // Empty
-    QRectF M = _bookModel()->getPlotMathRect(plotIdx);
-    _bookModel()->setPlotMathRect(Z,plotIdx);
-    _bookModel()->setPlotMathRect(M,plotIdx);
+    _filterCurves(FilterJob::Butterworth,_bwSources,value,0,0);
 
     // Update lineedit label
     QString s = QString("%1").arg(value);
@@ -2976,31 +3071,11 @@ void CurvesView::_keyPressG()
                 return;
             }
 
-            // Cache off original data for later filtering (use _real as cache)
-            curveModel->_real = (double*)malloc(N*sizeof(double));
-
-            it = it->at(0);
-            double goodVal = 0.0;
-            while ( !it->isDone() ) {
-                if ( std::isnan(it->y()) ) {
-                    it->next();
-                    continue;
-                }
-                goodVal = it->y();
-                break;
-            }
+            delete it;
+            curveModel->unmap();
 
-            int i = 0;
-            it = it->at(0);
-            while ( !it->isDone() ) {
-                curveModel->_real[i] = it->y();
-                if ( std::isnan(curveModel->_real[i]) ) {
-                    curveModel->_real[i] = goodVal;
-                }
-                goodVal = curveModel->_real[i];
-                it->next();
-                ++i;
-            }
+            // Cache off original data for later filtering
+            _sgSources.append(_filterSource(curveIdx,curveModel));
         }
     }
     int maxRange = (int)((1.0/dtMin)/5.0);
@@ -3024,6 +3099,8 @@ void CurvesView::_keyPressG()
 
 void CurvesView::_keyPressD()
 {
+    _cancelFilterJobs(); // curves are about to be replaced
+
     QModelIndex plotIdx = rootIndex();
     QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,"Curves","Plot");
     QModelIndexList curveIdxs = _bookModel()->getIndexList(curvesIdx,
@@ -3205,6 +3282,8 @@ void CurvesView::_keyPressD()
 // Integrate
 void CurvesView::_keyPressI()
 {
+    _cancelFilterJobs(); // curves are about to be replaced
+
     QModelIndex plotIdx = rootIndex();
     QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,"Curves","Plot");
     QModelIndexList curveIdxs = _bookModel()->getIndexList(curvesIdx,
@@ -3396,60 +3475,12 @@ void CurvesView::_keyPressI()
 
 void CurvesView::_keyPressGChange(int window, int degree)
 {
-    QModelIndex plotIdx = rootIndex();
-    QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,"Curves","Plot");
-    QModelIndexList curveIdxs = _bookModel()->getIndexList(curvesIdx,
-                                                           "Curve","Curves");
-
-    bool block = _bookModel()->blockSignals(true);
-    foreach ( QModelIndex curveIdx, curveIdxs ) {
-        CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
-        if ( curveModel ) {
-            CurveModel* sg = new CurveModelSG(curveModel,window,degree);
-            QVariant v = PtrToQVariant<CurveModel>::convert(sg);
-            QModelIndex curveDataIdx = _bookModel()->getDataIndex(curveIdx,
-                                                           "CurveData","Curve");
-            _bookModel()->setData(curveDataIdx,v);
-            curveModel->_real = 0; // Zero out cache since sg now owns it
-            delete curveModel;
-        }
-    }
-    _bookModel()->blockSignals(block);
-
-    // Reset bounding box so that plot refreshes (optimizing redraw)
-    QRectF Z; // Empty
-    QRectF M = _bookModel()->getPlotMathRect(plotIdx);
-    _bookModel()->setPlotMathRect(Z,plotIdx);
-    _bookModel()->setPlotMathRect(M,plotIdx);
+    _filterCurves(FilterJob::SGolay,_sgSources,0.0,window,degree);
 }
 
 void CurvesView::_keyPressGSliderChanged(int value)
 {
-    QModelIndex plotIdx = rootIndex();
-    QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,"Curves","Plot");
-    QModelIndexList curveIdxs = _bookModel()->getIndexList(curvesIdx,
-                                                           "Curve","Curves");
-
-    bool block = _bookModel()->blockSignals(true);
-    foreach ( QModelIndex curveIdx, curveIdxs ) {
-        CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
-        if ( curveModel ) {
-            CurveModel* sg = new CurveModelSG(curveModel,value,3);
-            QVariant v = PtrToQVariant<CurveModel>::convert(sg);
-            QModelIndex curveDataIdx = _bookModel()->getDataIndex(curveIdx,
-                                                           "CurveData","Curve");
-            _bookModel()->setData(curveDataIdx,v);
-            curveModel->_real = 0; // Zero out cache since sg now owns it
-            delete curveModel;
-        }
-    }
-    _bookModel()->blockSignals(block);
-
-    // Reset bounding box so that plot refreshes (optimizing redraw)
-    QRectF Z; // Empty
-    QRectF M = _bookModel()->getPlotMathRect(plotIdx);
-    _bookModel()->setPlotMathRect(Z,plotIdx);
-    _bookModel()->setPlotMathRect(M,plotIdx);
+    _filterCurves(FilterJob::SGolay,_sgSources,0.0,value,3);
 
     // Update lineedit label
     QString s = QString("%1").arg(value);
@@ -3480,6 +3511,254 @@ void CurvesView::_keyPressGDegreeReturnPressed()
     }
 }
 
+// Original samples of a curve for the B and G filters, NaNs are replaced
+// with the last good value
+QSharedPointer<FilterSource> CurvesView::_filterSource(
+                                                  const QModelIndex& curveIdx,
+                                                  CurveModel* curveModel)
+{
+    QSharedPointer<FilterSource> source(new FilterSource);
+    source->curveIdx = curveIdx;
+
+    curveModel->map();
+    int N = curveModel->rowCount();
+    source->ys.resize(N);
+    curveModel->values(0,N,0,0,source->ys.data());
+    if ( N > 0 ) {
+        double t0 = 0.0;
+        double tN = 0.0;
+        curveModel->values(0,1,&t0,0,0);
+        curveModel->values(N-1,N,&tN,0,0);
+        source->beginTime = t0;
+        if ( N > 1 ) {
+            source->dt = (tN-t0)/(N-1);
+        }
+    }
+    curveModel->unmap();
+
+    double* ys = source->ys.data();
+    double goodVal = 0.0;
+    for ( int i = 0; i < N; ++i ) {
+        if ( !std::isnan(ys[i]) ) {
+            goodVal = ys[i];
+            break;
+        }
+    }
+    for ( int i = 0; i < N; ++i ) {
+        if ( std::isnan(ys[i]) ) {
+            ys[i] = goodVal;
+        }
+        goodVal = ys[i];
+    }
+
+    return source;
+}
+
+// Preview the filter here and start a job for curves the preview did
+// not cover in full.  Jobs of earlier slider values are canceled.
+void CurvesView::_filterCurves(FilterJob::Filter filter,
+                          const QList<QSharedPointer<FilterSource> >& sources,
+                          double frequency, int window, int degree)
+{
+    _cancelFilterJobs();
+
+    QList<QSharedPointer<FilterSource> > jobSources;
+    bool block = _bookModel()->blockSignals(true);
+    foreach ( QSharedPointer<FilterSource> source, sources ) {
+        if ( !source->curveIdx.isValid() ) {
+            continue;
+        }
+        CurveModel* curveModel = _bookModel()->getCurveModel(source->curveIdx);
+        if ( !curveModel ) {
+            continue;
+        }
+        bool isFull = false;
+        CurveModel* preview = _filterPreview(filter,*source,curveModel,
+                                             frequency,window,degree,&isFull);
+        if ( preview ) {
+            _setFilteredCurve(source->curveIdx,preview);
+        }
+        if ( !isFull ) {
+            jobSources.append(source);
+        }
+    }
+    _bookModel()->blockSignals(block);
+    _refreshFilteredPlot();
+
+    if ( !jobSources.isEmpty() ) {
+        FilterJob* job = new FilterJob(filter,jobSources,frequency,
+                                       window,degree,_filterGeneration);
+        connect(job,SIGNAL(finished(int)),
+                this,SLOT(_filterJobFinished(int)));
+        _filterJobs.append(job);
+        _filterPool.start(job);
+    }
+}
+
+// Filter the visible samples of the source (plus a margin so the filter
+// has settled, or has a full window, at the plot's edges) decimated to a
+// few samples per pixel.  Returns 0 if there is nothing to preview.
+// isFull is set if the preview is the full resolution filtered curve.
+CurveModel* CurvesView::_filterPreview(FilterJob::Filter filter,
+                                       const FilterSource& source,
+                                       CurveModel* curveModel,
+                                       double frequency, int window,
+                                       int degree, bool* isFull)
+{
+    int N = source.ys.size();
+    double dt = source.dt;
+    *isFull = false;
+    if ( N == 0 || dt <= 0.0 ) {
+        return 0;
+    }
+
+    int i0 = 0;
+    int i1 = N;
+    CurveProps curveProps = _bookModel()->curveProps(source.curveIdx);
+    PlotProps plotProps = _bookModel()->plotProps(rootIndex());
+    if ( !plotProps.isXLogScale && curveProps.xScale != 0.0 ) {
+        QRectF M = _bookModel()->getPlotMathRect(rootIndex());
+        double tl = (M.left()-curveProps.xBias)/curveProps.xScale;
+        double tr = (M.right()-curveProps.xBias)/curveProps.xScale;
+        if ( tl > tr ) {
+            qSwap(tl,tr);
+        }
+        double margin = window;
+        if ( filter == FilterJob::Butterworth ) {
+            margin = 4.0/(frequency*dt);  // four periods of cutoff frequency
+        }
+        double l = floor((tl-source.beginTime)/dt) - margin;
+        double r = ceil((tr-source.beginTime)/dt) + 1.0 + margin;
+        i0 = (int)qBound(0.0,l,(double)N);
+        i1 = (int)qBound((double)i0,r,(double)N);
+    }
+    int n = i1-i0;
+    if ( n <= 0 ) {
+        return 0;
+    }
+
+    int nPixels = qMax(1024,viewport()->width());
+    int stride = qMax(1,n/(4*nPixels));
+    if ( filter == FilterJob::SGolay ) {
+        // Keep enough points in the decimated window to fit the polynomial
+        stride = qMin(stride,qMax(1,window/qMax(1,degree)));
+    }
+    *isFull = ( i0 == 0 && i1 == N && stride == 1 );
+
+    QVector<double> ys((n+stride-1)/stride);
+    for ( int k = 0; k < ys.size(); ++k ) {
+        ys[k] = source.ys.at(i0+k*stride);
+    }
+    double previewDt = dt*stride;
+    double previewFrequency = frequency;
+    if ( filter == FilterJob::Butterworth ) {
+        // Cutoff must stay below the decimated data's Nyquist frequency
+        previewFrequency = qMin(frequency,0.45/previewDt);
+    }
+    int previewWindow = qMax(1,window/stride);
+
+    if ( !FilterJob::filter(filter,ys.data(),ys.size(),previewDt,
+                            previewFrequency,previewWindow,degree) ) {
+        *isFull = false;
+        return 0;
+    }
+
+    return _filteredCurveModel(filter,curveModel,frequency,window,degree,
+                               source.beginTime+i0*dt,previewDt,ys);
+}
+
+CurveModel* CurvesView::_filteredCurveModel(FilterJob::Filter filter,
+                                            CurveModel* curveModel,
+                                            double frequency,
+                                            int window, int degree,
+                                            double beginTime, double dt,
+                                            const QVector<double>& ys)
+{
+    if ( filter == FilterJob::Butterworth ) {
+        return new CurveModelBW(curveModel,frequency,beginTime,dt,
+                                ys.constData(),ys.size());
+    } else {
+        return new CurveModelSG(curveModel,window,degree,beginTime,dt,
+                                ys.constData(),ys.size());
+    }
+}
+
+// Model signals should be blocked, see _refreshFilteredPlot()
+void CurvesView::_setFilteredCurve(const QModelIndex &curveIdx,
+                                   CurveModel *filtered)
+{
+    CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
+    QVariant v = PtrToQVariant<CurveModel>::convert(filtered);
+    QModelIndex curveDataIdx = _bookModel()->getDataIndex(curveIdx,
+                                                          "CurveData","Curve");
+    _bookModel()->setData(curveDataIdx,v);
+    delete curveModel;
+}
+
+void CurvesView::_refreshFilteredPlot()
+{
+    // Reset bounding box so that plot refreshes (optimizing redraw)
+    QModelIndex plotIdx = rootIndex();
+    QRectF Z; // Empty
+    QRectF M = _bookModel()->getPlotMathRect(plotIdx);
+    _bookModel()->setPlotMathRect(Z,plotIdx);
+    _bookModel()->setPlotMathRect(M,plotIdx);
+}
+
+// Jobs stop at their next cancel check and are deleted when their
+// finished() arrives.  Bumping the generation drops results of jobs that
+// finished before the cancel.
+void CurvesView::_cancelFilterJobs()
+{
+    foreach ( FilterJob* job, _filterJobs ) {
+        job->cancel();
+    }
+    ++_filterGeneration;
+}
+
+void CurvesView::_filterJobFinished(int generation)
+{
+    FilterJob* job = 0;
+    foreach ( FilterJob* filterJob, _filterJobs ) {
+        if ( filterJob->generation() == generation ) {
+            job = filterJob;
+            break;
+        }
+    }
+    if ( !job ) return;
+
+    job->wait(); // job is out of run()
+    _filterJobs.removeOne(job);
+
+    if ( generation == _filterGeneration && job->isDone() ) {
+        bool block = _bookModel()->blockSignals(true);
+        for ( int i = 0; i < job->sources().size(); ++i ) {
+            const FilterSource& source = *job->sources().at(i);
+            const QVector<double>& ys = job->results().at(i);
+            if ( ys.isEmpty() || !source.curveIdx.isValid() ) {
+                continue;
+            }
+            CurveModel* curveModel = _bookModel()->getCurveModel(
+                                                             source.curveIdx);
+            if ( !curveModel ) {
+                continue;
+            }
+            CurveModel* filtered = _filteredCurveModel(job->filterType(),
+                                                       curveModel,
+                                                       job->frequency(),
+                                                       job->window(),
+                                                       job->degree(),
+                                                       source.beginTime,
+                                                       source.dt, ys);
+            _setFilteredCurve(source.curveIdx,filtered);
+        }
+        _bookModel()->blockSignals(block);
+        _refreshFilteredPlot();
+    }
+
+    delete job;
+}
+
 // Re-integrate using initial value from entry box
 void CurvesView::_keyPressIInitValueReturnPressed()
 {
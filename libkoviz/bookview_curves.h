@@ -25,6 +25,8 @@
 #include <QLineEdit>
 #include <QIntValidator>
 #include <QProgressDialog>
+#include <QThreadPool>
+#include <QTransform>
 #include <stdlib.h>
 #include <float.h>
 #include <math.h>
@@ -40,6 +42,8 @@
 #include "curvemodel_sg.h"
 #include "curvemodel_deriv.h"
 #include "curvemodel_integ.h"
+#include "curveslayer.h"
+#include "filterjob.h"
 
 class TimeAndIndex
 {
@@ -188,7 +192,6 @@ private:
 
     QList<TimeAndIndex*> _markers;
 
-    void _paintCoplot(const QTransform& T, QPainter& painter,QPen& pen);
     void _paintErrorplot(const QTransform& T,
                          QPainter& painter, const QPen &pen,
                          const QModelIndex &plotIdx);
@@ -200,18 +203,42 @@ private:
     QModelIndex _chooseCurveNearMousePoint(const QPoint& pt);
     bool _isErrorCurveNearMousePoint(const QPoint& pt);
 
-    QPixmap* _pixmap;
+    // Paint is composed of cached layers, only markers and the measure
+    // line (the overlay) are painted on every paint event:
+    //     curves    - background, grid and curves (or error plot),
+    //                 rasterized on _layerPool
+    //     selection - dimmed background with the current curve on top
+    //     legend
+    QImage _curvesLayer;
+    QTransform _curvesLayerT;  // coord to pixel transform it was made with
+    QImage _selectionLayer;
+    QImage _legendLayer;
+    bool _isCurvesLayerStale;
+    bool _isSelectionLayerStale;
+    bool _isLegendLayerStale;
+    QThreadPool _layerPool;
+    CurvesLayerJob* _layerJob;
+    QTransform _layerJobT;
+    int _layerGeneration;
+    void _invalidateLayers();
+    void _updateCurvesLayer();
+    void _paintCurvesLayer(QPainter& painter, const QTransform& T);
+    void _updateSelectionLayer();
+    void _updateLegendLayer();
+    void _cancelLayerJob();
+    bool _isCurrentCurveInPlot();
+    QString _plotPresentation();
+
     QRectF _lastM;
     bool _isMeasure;
     QPoint _mouseCurrPos;
-    QPixmap* _createLivePixmap();
 
     double _mousePressXBias;
     double _mousePressYBias;
 
     QString _format(double d);
 
-    int _idxAtTimeBinarySearch(QPainterPath* path,
+    int _idxAtTimeBinarySearch(CurvePoints* points,
                                int low, int high, double time);
 
     // Key Events
@@ -224,7 +251,7 @@ private:
     void _keyPressArrow(const Qt::ArrowType& arrow);
     void _keyPressComma();
     void _keyPressEscape();
-    void _keyPressF();
+    void _keyPressF(bool isWelch);
     void _keyPressB();
     void _keyPressG();
     void _keyPressD();
@@ -241,6 +268,34 @@ private:
     QSlider* _sg_slider;
     void _keyPressGChange(int window, int degree);
 
+    // Filter slider changes are previewed on the visible part of the
+    // curves, decimated to about the plot's pixel width, and the full
+    // resolution filter is run on _filterPool.  Its result replaces the
+    // preview unless the slider has moved on (see FilterJob).
+    QList<QSharedPointer<FilterSource> > _bwSources;
+    QList<QSharedPointer<FilterSource> > _sgSources;
+    QThreadPool _filterPool;
+    QList<FilterJob*> _filterJobs;   // started, canceled or not
+    int _filterGeneration;
+    QSharedPointer<FilterSource> _filterSource(const QModelIndex& curveIdx,
+                                               CurveModel* curveModel);
+    void _filterCurves(FilterJob::Filter filter,
+                       const QList<QSharedPointer<FilterSource> >& sources,
+                       double frequency, int window, int degree);
+    CurveModel* _filterPreview(FilterJob::Filter filter,
+                               const FilterSource& source,
+                               CurveModel* curveModel,
+                               double frequency, int window, int degree,
+                               bool* isFull);
+    CurveModel* _filteredCurveModel(FilterJob::Filter filter,
+                                    CurveModel* curveModel,
+                                    double frequency, int window, int degree,
+                                    double beginTime, double dt,
+                                    const QVector<double>& ys);
+    void _setFilteredCurve(const QModelIndex& curveIdx, CurveModel* filtered);
+    void _refreshFilteredPlot();
+    void _cancelFilterJobs();
+
     QFrame* _integ_frame;
     QLineEdit* _integ_ival;
 
@@ -255,6 +310,8 @@ private slots:
     void _keyPressGLineEditReturnPressed();
     void _keyPressGDegreeReturnPressed();
     void _keyPressIInitValueReturnPressed();
+    void _curvesLayerFinished(int generation);
+    void _filterJobFinished(int generation);
 
 protected slots:
     virtual void dataChanged(const QModelIndex &topLeft,
@@ -5,9 +5,25 @@ BookTableView::BookTableView(QWidget *parent) :
     _mTop(3),
     _mBot(3),
     _mLft(3),
-    _mRgt(3)
+    _mRgt(3),
+    _isColumnsStale(true),
+    _rowIndex(0),
+    _rowIndexJob(0),
+    _rowIndexGeneration(0),
+    _isRowIndexStale(false),
+    _isLiveTimePending(false),
+    _cacheTop(-1),
+    _cacheRowCount(0)
 {
     setFrameShape(QFrame::Box);
+    _rowIndexPool.setMaxThreadCount(1);
+}
+
+BookTableView::~BookTableView()
+{
+    _cancelRowIndexJob();
+    delete _rowIndex;
+    _adviseModels(false);
 }
 
 void BookTableView::paintEvent(QPaintEvent *event)
@@ -21,6 +37,13 @@ void BookTableView::paintEvent(QPaintEvent *event)
         return;
     }
 
+    // Table vars changed since the last index build, so rebuild it.
+    // Until the new index is in, the old one (if any) is shown
+    if ( _isRowIndexStale ) {
+        _startRowIndexJob();
+    }
+    _updateColumns();
+
     QPainter painter(viewport());
     painter.save();
     QPen penOrig = painter.pen();
@@ -34,41 +57,8 @@ void BookTableView::paintEvent(QPaintEvent *event)
     QPen penLight(palette.midlight().color());
     QPen penTxt(palette.text().color());
 
-    // Per table variable, make list of curve models, units, scalefactors etc.
-    QList<CurveModel*> curveModels;
-    QStringList units;
-    QModelIndex tableVarsIdx = _bookModel()->getIndex(rootIndex(),
-                                                      "TableVars","Table");
-    QModelIndexList tableVarIdxs = _bookModel()->getIndexList(tableVarsIdx,
-                                                        "TableVar","TableVars");
-    QList<double> scaleFactors;
-    QList<double> biases;
-    foreach (QModelIndex tableVarIdx, tableVarIdxs) {
-        QModelIndex curveIdx = _bookModel()->getDataIndex(tableVarIdx,
-                                                     "TableVarData","TableVar");
-        QVariant v = _bookModel()->data(curveIdx);
-        CurveModel* curveModel = QVariantToPtr<CurveModel>::convert(v);
-        curveModels << curveModel;
-
-        double sf = _bookModel()->getDataDouble(tableVarIdx,
-                                                "TableVarScale","TableVar");
-
-        QString unit = _bookModel()->getDataString(tableVarIdx,
-                                                   "TableVarUnit","TableVar");
-        if ( unit.isEmpty() ) {
-            unit = curveModel->y()->unit();
-        } else {
-            sf *= Unit::scale(curveModel->y()->unit(),unit);
-        }
-        units << unit;
-        scaleFactors << sf;
-
-        double bias = _bookModel()->getDataDouble(tableVarIdx,
-                                                  "TableVarBias","TableVar");
-        bias += Unit::bias(curveModel->y()->unit(),unit);  // for temperature
-        biases << bias;
-    }
     QStringList labels = _columnLabels();
+    int nStamps = _rowIndex ? _rowIndex->rowCount() : 0;
 
     // Calculate column width
     int w = fm.width("0123456789");
@@ -86,57 +76,27 @@ void BookTableView::paintEvent(QPaintEvent *event)
 
     int h = _mTop + fm.height() + _mBot;
     int nRows = W.height()/h;
-    if ( nRows > _timeStamps.size() ) {
-        nRows = _timeStamps.size()+1;   //+1 for header
+    if ( nRows > nStamps ) {
+        nRows = nStamps+1;   //+1 for header
     }
 
     double x   = verticalScrollBar()->value();
     double xmax = verticalScrollBar()->maximum();
-    int p = (x/xmax)*_timeStamps.size();
-    if ( p > _timeStamps.size()-nRows+1 ) {
-        p = _timeStamps.size()-nRows+1;
+    int p = (xmax > 0) ? (x/xmax)*nStamps : 0;
+    if ( p > nStamps-nRows+1 ) {
+        p = nStamps-nRows+1;
     }
 
     double y   = horizontalScrollBar()->value();
     double ymax = horizontalScrollBar()->maximum();
-    int q = (y/ymax)*labels.size();
+    int q = (ymax > 0) ? (y/ymax)*labels.size() : 0;
     if ( q > labels.size()-nCols ) {
         q = labels.size()-nCols;
     }
 
-    // Make list of values (per column)
-    QHash<int,QStringList> col2svals;
-    for (int j = 0; j < nCols; ++j) {
-        double sf   = scaleFactors.at(q+j);
-        double bias = biases.at(q+j);
-        CurveModel* curveModel = curveModels.at(q+j);
-        curveModel->map();
-        ModelIterator* it = curveModel->begin();
-        QList<double> vals;
-        for ( int i = 1; i < nRows; ++i ) {
-            double t = _timeStamps.at(p+i-1);
-            if ( j == 0 ) {
-                vals << t*sf + bias;
-            } else {
-                int k = curveModel->indexAtTime(t);
-                if ( it->at(k)->t() == t ) {
-                    vals << it->at(k)->y()*sf + bias;
-                } else {
-                    vals << 0; // place holder for blank data
-                }
-            }
-        }
-        QStringList svals = _format(vals);
-        col2svals.insert(j,svals);
-        delete it;
-        curveModel->unmap();
-    }
-
     // Draw the table
     for (int j = 0; j < nCols; ++j) {
-        CurveModel* curveModel = curveModels.at(q+j);
-        curveModel->map();
-        ModelIterator* it = curveModel->begin();
+        QStringList svals = _columnValues(q+j,p,nRows-1);
         for ( int i = 0; i < nRows; ++i ) {
             int hline = h*(i+1);
             int baseline = hline - _mBot - fm.descent();
@@ -146,29 +106,15 @@ void BookTableView::paintEvent(QPaintEvent *event)
             QString s;
             if ( i == 0 ) {
                 s = labels.at(q+j);
-                int l = fm.width(labels.at(q+j));
-                painter.drawText(w*j+(w-l),baseline,s);
             } else {
-                if ( j == 0 ) {
-                    s = col2svals.value(j).at(i-1);
-                } else {
-                    double t = _timeStamps.at(p+i-1);
-                    int k = curveModel->indexAtTime(t);
-                    if ( it->at(k)->t() == t ) {
-                        s = col2svals.value(j).at(i-1);
-                    } else {
-                        // s is an empty string since no corresponding time
-                    }
-                }
-                int l = fm.width(s);
-                painter.drawText(w*j+(w-l),baseline,s);
+                s = svals.at(i-1); // empty if no corresponding time
             }
+            int l = fm.width(s);
+            painter.drawText(w*j+(w-l),baseline,s);
         }
         int vline = w*(j+1);
         painter.setPen(penLight);
         painter.drawLine(vline,0,vline,W.height());
-        delete it;
-        curveModel->unmap();
     }
 
     painter.setPen(penOrig);
@@ -176,6 +122,231 @@ void BookTableView::paintEvent(QPaintEvent *event)
     painter.end();
 }
 
+// Formatted values of column col for rows [top,top+nRows).  Cells are
+// formatted per column over the visible rows (see _format()), so the
+// cache holds the visible window and is dropped when the window moves.
+QStringList BookTableView::_columnValues(int col, int top, int nRows)
+{
+    if ( !_rowIndex ) {
+        // First paint, the index job has just been started
+        QStringList svals;
+        for ( int i = 0; i < nRows; ++i ) {
+            svals << QString();
+        }
+        return svals;
+    }
+
+    if ( top != _cacheTop || nRows != _cacheRowCount ) {
+        _col2svals.clear();
+        _cacheTop = top;
+        _cacheRowCount = nRows;
+    }
+    if ( _col2svals.contains(col) ) {
+        return _col2svals.value(col);
+    }
+
+    const Column& column = _columns.at(col);
+    CurveModel* curveModel = column.curveModel;
+    curveModel->map(); // a pool lookup, see MapPool
+    ModelIterator* it = curveModel->begin();
+
+    // Vars added, removed or replaced since the index was built shift
+    // columns, so a column is shown only if the index was built from its
+    // curve.  Others are blank until the index is rebuilt.
+    bool isIndexed = ( col < _rowIndex->columnCount() &&
+                       _rowIndex->curve(col) == curveModel );
+    int nModelRows = curveModel->rowCount();
+    QList<int> rows;     // table rows with a value
+    QList<double> vals;
+    for ( int i = 0; i < nRows; ++i ) {
+        int row = top+i;
+        double t = _rowIndex->time(row);
+        if ( col == 0 ) {
+            rows << i;
+            vals << t*column.scale + column.bias;
+        } else if ( isIndexed ) {
+            int k = _rowIndex->modelRow(col,row);
+            if ( k >= 0 && k < nModelRows ) {
+                rows << i;
+                vals << it->at(k)->y()*column.scale + column.bias;
+            }
+        }
+    }
+    delete it;
+    curveModel->unmap();
+
+    QStringList svals;
+    for ( int i = 0; i < nRows; ++i ) {
+        svals << QString();
+    }
+    QStringList formatted = _format(vals);
+    for ( int i = 0; i < rows.size(); ++i ) {
+        svals.replace(rows.at(i),formatted.at(i));
+    }
+
+    _col2svals.insert(col,svals);
+    return svals;
+}
+
+void BookTableView::_clearValuesCache()
+{
+    _col2svals.clear();
+    _cacheTop = -1;
+    _cacheRowCount = 0;
+}
+
+// Per table variable, curve model and unit scale/bias
+void BookTableView::_updateColumns()
+{
+    if ( !_isColumnsStale ) return;
+    _isColumnsStale = false;
+    _columns.clear();
+
+    QModelIndex tableVarsIdx = _bookModel()->getIndex(rootIndex(),
+                                                      "TableVars","Table");
+    QModelIndexList tableVarIdxs = _bookModel()->getIndexList(tableVarsIdx,
+                                                        "TableVar","TableVars");
+    foreach (QModelIndex tableVarIdx, tableVarIdxs) {
+        QModelIndex curveIdx = _bookModel()->getDataIndex(tableVarIdx,
+                                                     "TableVarData","TableVar");
+        QVariant v = _bookModel()->data(curveIdx);
+        CurveModel* curveModel = QVariantToPtr<CurveModel>::convert(v);
+
+        double sf = _bookModel()->getDataDouble(tableVarIdx,
+                                                "TableVarScale","TableVar");
+
+        QString unit = _bookModel()->getDataString(tableVarIdx,
+                                                   "TableVarUnit","TableVar");
+        if ( unit.isEmpty() ) {
+            unit = curveModel->y()->unit();
+        } else {
+            sf *= Unit::scale(curveModel->y()->unit(),unit);
+        }
+
+        double bias = _bookModel()->getDataDouble(tableVarIdx,
+                                                  "TableVarBias","TableVar");
+        bias += Unit::bias(curveModel->y()->unit(),unit);  // for temperature
+
+        Column column;
+        column.curveModel = curveModel;
+        column.scale = sf;
+        column.bias = bias;
+        _columns << column;
+    }
+}
+
+void BookTableView::_startRowIndexJob()
+{
+    _cancelRowIndexJob();
+    _isRowIndexStale = false;
+    _updateColumns();
+
+    QList<CurveModel*> curveModels;
+    foreach ( Column column, _columns ) {
+        curveModels << column.curveModel;
+    }
+    double startTime = _bookModel()->getDataDouble(QModelIndex(),"StartTime");
+    double stopTime = _bookModel()->getDataDouble(QModelIndex(),"StopTime");
+
+    TableRowIndex* rowIndex = new TableRowIndex(curveModels,
+                                                startTime,stopTime);
+    _rowIndexJob = new TableRowIndexJob(rowIndex,++_rowIndexGeneration);
+    connect(_rowIndexJob,SIGNAL(finished(int)),
+            this,SLOT(_rowIndexFinished(int)));
+    _rowIndexPool.start(_rowIndexJob);
+}
+
+// Canceled jobs return right away, the generation check in
+// _rowIndexFinished() drops a finished() that is still queued
+void BookTableView::_cancelRowIndexJob()
+{
+    if ( !_rowIndexJob ) return;
+    _rowIndexJob->cancel();
+    _rowIndexPool.waitForDone();
+    delete _rowIndexJob;
+    _rowIndexJob = 0;
+}
+
+void BookTableView::_rowIndexFinished(int generation)
+{
+    if ( generation != _rowIndexGeneration || !_rowIndexJob ) return;
+
+    _rowIndexPool.waitForDone(); // job is out of run()
+    bool isDone = _rowIndexJob->isDone();
+    if ( isDone ) {
+        delete _rowIndex;
+        _rowIndex = _rowIndexJob->takeRowIndex();
+    }
+    delete _rowIndexJob;
+    _rowIndexJob = 0;
+    if ( !isDone ) return;
+
+    _clearValuesCache();
+    if ( isVisible() ) {
+        _adviseModels(true); // vars may have been added
+    }
+
+    // Based on number of rows, set vertical scrollbar range
+    int max = _rowIndex->rowCount()+1; // +1 for header
+    verticalScrollBar()->setRange(0,max);
+
+    // Based on column labels, set horizontal scrollbar range
+    int nCols = _columnLabels().size();
+    horizontalScrollBar()->setRange(0,nCols);
+
+    if ( _isLiveTimePending ) {
+        _scrollToLiveTime();
+    }
+
+    viewport()->update();
+}
+
+void BookTableView::_scrollToLiveTime()
+{
+    if ( !_rowIndex || _isRowIndexStale || _rowIndexJob ) {
+        _isLiveTimePending = true; // scroll once rows are in
+        return;
+    }
+    _isLiveTimePending = false;
+
+    double liveTime = _bookModel()->getDataDouble(QModelIndex(),
+                                                  "LiveCoordTime");
+    int i = _rowIndex->rowAtTime(liveTime);
+    verticalScrollBar()->setValue(i+1);
+}
+
+void BookTableView::_adviseModels(bool isVisible)
+{
+    QList<CurveModel*> curveModels;
+    if ( isVisible && model() ) {
+        _updateColumns();
+        foreach ( Column column, _columns ) {
+            column.curveModel->map();
+            column.curveModel->advise(MapPool::Random);
+            column.curveModel->unmap();
+            curveModels << column.curveModel;
+        }
+    }
+    foreach ( CurveModel* curveModel, _randomModels ) {
+        if ( !curveModels.contains(curveModel) ) {
+            curveModel->advise(MapPool::Sequential);
+        }
+    }
+    _randomModels = curveModels;
+}
+
+void BookTableView::showEvent(QShowEvent *event)
+{
+    _adviseModels(true);
+    QAbstractItemView::showEvent(event);
+}
+
+void BookTableView::hideEvent(QHideEvent *event)
+{
+    _adviseModels(false);
+    QAbstractItemView::hideEvent(event);
+}
+
 QStringList BookTableView::_format(const QList<double> &vals)
 {
     QStringList list;
@@ -333,73 +504,30 @@ void BookTableView::dataChanged(const QModelIndex &topLeft,
     if ( topLeft.column() != 1 ) return;
     if ( topLeft != bottomRight ) return;
 
-    QModelIndex dataIdx = topLeft;
     QModelIndex tagIdx = model()->index(topLeft.row(),0,topLeft.parent());
     QString tag = model()->data(tagIdx).toString();
 
-    if ( tag == "TableVarData") {
-
-        // Get curve model
-        QVariant v = _bookModel()->data(dataIdx);
-        CurveModel* curveModel =QVariantToPtr<CurveModel>::convert(v);
-
-        if ( curveModel ) {
-
-            double startTime = _bookModel()->getDataDouble(QModelIndex(),
-                                                           "StartTime");
-            double stopTime = _bookModel()->getDataDouble(QModelIndex(),
-                                                          "StopTime");
-
-            curveModel->map();
-            ModelIterator* it = curveModel->begin();
-
-            int i = 0;
-            while ( !it->isDone() ) {
-
-                double t = it->t();
-
-                if ( t < startTime ) {
-                    it->next();
-                    continue;
-                }
-                if ( t > stopTime ) {
-                    break;
-                }
-                if ( i >= _timeStamps.size() ) {
-                    _timeStamps.append(t);
-                    it->next();
-                    ++i;
-                    continue;
-                }
-
-                double timeStamp = _timeStamps.at(i);
-                if ( t == timeStamp ) {
-                    it->next();
-                } else if ( t < timeStamp ) {
-                    _timeStamps.insert(i,t);
-                    it->next();
-                }
-                ++i;
-            }
-
-            delete it;
-            curveModel->unmap();
+    if ( tag == "LiveCoordTime" ) {
+        _scrollToLiveTime();
+    } else if ( tag == "StartTime" || tag == "StopTime" ) {
+        if ( _rowIndex || _rowIndexJob ) {
+            _isRowIndexStale = true;
+            _cancelRowIndexJob();
+        }
+    } else if ( tag.startsWith("TableVar") ) {
+
+        // Only vars of this table
+        QModelIndex tableIdx = topLeft.parent().parent().parent();
+        if ( tableIdx != rootIndex() ) return;
+
+        _isColumnsStale = true;
+        _clearValuesCache();
+        if ( tag == "TableVarData" ) {
+            // Index is built on next paint so that vars added in a batch
+            // make a single build
+            _isRowIndexStale = true;
+            _cancelRowIndexJob();
         }
-
-        // Based on number of _timeStamps, set vertical scrollbar range
-        int max = _timeStamps.count()+1; // +1 for header
-        verticalScrollBar()->setRange(0,max);
-
-        // Based on column labels, set horizontal scrollbar range
-        int nCols = _columnLabels().size();
-        horizontalScrollBar()->setRange(0,nCols);
-
-    } else if ( tag == "LiveCoordTime" ) {
-
-        double liveTime = _bookModel()->getDataDouble(QModelIndex(),
-                                                      "LiveCoordTime");
-        int i = TimeStamps::idxAtTime(_timeStamps,liveTime);
-        verticalScrollBar()->setValue(i+1);
     }
 
     viewport()->update();
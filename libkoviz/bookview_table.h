@@ -15,6 +15,9 @@
 #include <QString>
 #include <QStringList>
 #include <QKeyEvent>
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QThreadPool>
 #include <limits.h>
 
 #include <QtGlobal>
@@ -27,13 +30,14 @@
 #include "bookmodel.h"
 #include "curvemodel.h"
 #include "unit.h"
-#include "timestamps.h"
+#include "tablerowindex.h"
 
 class BookTableView : public QAbstractItemView
 {
     Q_OBJECT
 public:
     explicit BookTableView(QWidget *parent = 0);
+    ~BookTableView();
 
 public:
     virtual QModelIndex indexAt( const QPoint& point) const;
@@ -58,6 +62,8 @@ protected:
                               const QItemSelection &selection) const;
     virtual void keyPressEvent(QKeyEvent *event);
     void wheelEvent(QWheelEvent *e);
+    virtual void showEvent(QShowEvent* event);
+    virtual void hideEvent(QHideEvent* event);
 
 protected slots:
     virtual void dataChanged(const QModelIndex &topLeft,
@@ -65,14 +71,49 @@ protected slots:
                              const QVector<int> &roles = QVector<int>());
     virtual void rowsInserted(const QModelIndex &parent, int start, int end);
 
+private slots:
+    void _rowIndexFinished(int generation);
+
 private:
     PlotBookModel* _bookModel() const;
-    QList<double> _timeStamps;
     int _mTop;
     int _mBot;
     int _mLft;
     int _mRgt;
 
+    // Per table variable, gathered from the book once (not per paint)
+    struct Column
+    {
+        CurveModel* curveModel;
+        double scale;
+        double bias;
+    };
+    QList<Column> _columns;
+    bool _isColumnsStale;
+    void _updateColumns();
+
+    // Merged rows of all table vars, built on _rowIndexPool
+    TableRowIndex* _rowIndex;
+    TableRowIndexJob* _rowIndexJob;
+    QThreadPool _rowIndexPool;
+    int _rowIndexGeneration;
+    bool _isRowIndexStale;
+    bool _isLiveTimePending;
+    void _startRowIndexJob();
+    void _cancelRowIndexJob();
+    void _scrollToLiveTime();
+
+    // Cells are looked up a row at a time while the table is visible
+    QList<CurveModel*> _randomModels;
+    void _adviseModels(bool isVisible);
+
+    // Formatted cells of the visible rows, per column
+    int _cacheTop;
+    int _cacheRowCount;
+    QHash<int,QStringList> _col2svals;
+    QStringList _columnValues(int col, int top, int nRows);
+    void _clearValuesCache();
+
     QStringList _columnLabels() const;
 
     QStringList _format(const QList<double>& vals);
@@ -0,0 +1,86 @@
+#include "curvedecimator.h"
+
+CurveDecimator::CurveDecimator(CurvePoints *out, double columnWidth) :
+    _out(out),
+    _columnWidth(columnWidth),
+    _isRun(false),
+    _column(0.0),
+    _n(0),
+    _iMin(0),
+    _iMax(0),
+    _x0(0.0), _y0(0.0),
+    _xMin(0.0), _yMin(0.0),
+    _xMax(0.0), _yMax(0.0),
+    _xN(0.0), _yN(0.0)
+{
+}
+
+CurveDecimator::~CurveDecimator()
+{
+    finish();
+}
+
+void CurveDecimator::append(double x, double y)
+{
+    if ( _columnWidth <= 0.0 ) {
+        _out->append(x,y);
+        return;
+    }
+
+    double column = floor(x/_columnWidth);
+    if ( _isRun && column != _column ) {
+        _flush();
+    }
+
+    if ( !_isRun ) {
+        _isRun = true;
+        _column = column;
+        _n = 0;
+        _iMin = 0;
+        _iMax = 0;
+        _x0 = x;    _y0 = y;
+        _xMin = x;  _yMin = y;
+        _xMax = x;  _yMax = y;
+    } else {
+        if ( y < _yMin ) {
+            _xMin = x; _yMin = y; _iMin = _n;
+        }
+        if ( y > _yMax ) {
+            _xMax = x; _yMax = y; _iMax = _n;
+        }
+    }
+    _xN = x; _yN = y;
+    ++_n;
+}
+
+void CurveDecimator::gap()
+{
+    _flush();
+}
+
+void CurveDecimator::finish()
+{
+    _flush();
+}
+
+// Emit first, extrema (in sample order) and last, skipping repeats
+void CurveDecimator::_flush()
+{
+    if ( !_isRun ) {
+        return;
+    }
+    _isRun = false;
+
+    int last = _n-1;
+    _out->append(_x0,_y0);
+    if ( _iMin < _iMax ) {
+        if ( _iMin != 0 ) _out->append(_xMin,_yMin);
+        if ( _iMax != last ) _out->append(_xMax,_yMax);
+    } else if ( _iMax < _iMin ) {
+        if ( _iMax != 0 ) _out->append(_xMax,_yMax);
+        if ( _iMin != last ) _out->append(_xMin,_yMin);
+    }
+    if ( last > 0 ) {
+        _out->append(_xN,_yN);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef CURVE_DECIMATOR_H
+#define CURVE_DECIMATOR_H
+
+#include <math.h>
+#include "curvepoints.h"
+
+//
+// Streaming pixel column min/max decimation for printing.
+//
+// Points are appended in device coordinates (e.g. printer dots).  Each
+// run of consecutive points that falls in the same pixel column is
+// reduced to at most four points: first, min y, max y and last (kept in
+// sample order).  A line through the reduced points covers the same
+// pixels as a line through all of them, so spikes survive and the page
+// looks the same at the device resolution, but a 10 inch wide plot
+// costs at most ~4*dpi*10 points regardless of log length.
+//
+// Since runs are consecutive samples, x need not be monotonic (phase
+// plots decimate too).  gap() marks a non-finite sample.  It ends the
+// current run, so no run spans a gap and the points either side of a
+// gap are the same as with exact output.
+//
+// A columnWidth <= 0 disables decimation (every point is kept).
+//
+class CurveDecimator
+{
+  public:
+    CurveDecimator(CurvePoints* out, double columnWidth=1.0);
+    ~CurveDecimator();
+
+    void append(double x, double y);
+    void gap();
+    void finish();
+
+  private:
+    CurvePoints* _out;
+    double _columnWidth;
+    bool _isRun;
+    double _column;
+    int _n;        // number of points in run
+    int _iMin;     // run indices of extrema
+    int _iMax;
+    double _x0, _y0;
+    double _xMin, _yMin;
+    double _xMax, _yMax;
+    double _xN, _yN;
+
+    void _flush();
+};
+
+#endif // CURVE_DECIMATOR_H
@@ -0,0 +1,176 @@
+#include "curvelod.h"
+
+static const int LOD_GROUP_SIZE = 16;     // points reduced per bucket
+static const int LOD_MIN_LEVEL_SIZE = 64; // stop building below this
+
+CurveLOD::CurveLOD(const CurvePoints *points) :
+    _points(points),
+    _count(0),
+    _isMonotonic(true)
+{
+    _build(0);
+}
+
+void CurveLOD::grow()
+{
+    if ( _points->count() > _count ) {
+        _build(_count);
+    }
+}
+
+// Levels are made for points [beginPoint,count).  Groups before the one
+// holding beginPoint are complete and were made by an earlier _build().
+void CurveLOD::_build(int beginPoint)
+{
+    int n = _points->count();
+    _count = n;
+    if ( !_isMonotonic ) {
+        return;
+    }
+
+    const double* x = _points->xData();
+    for ( int i = qMax(beginPoint,1); i < n; ++i ) {
+        if ( x[i] < x[i-1] ) {
+            _isMonotonic = false;
+            _levels.clear();
+            return;
+        }
+    }
+
+    if ( n < LOD_MIN_LEVEL_SIZE ) {
+        return;
+    }
+    if ( _levels.isEmpty() ) {
+        beginPoint = 0; // too few points for a pyramid last time
+        _levels.append(Level());
+    }
+
+    // Redo the (possibly partial) last group of each level and on up
+    int beginGroup = beginPoint/LOD_GROUP_SIZE;
+    _reduce(x,_points->yData(),n,_levels[0],beginGroup);
+    int k = 0;
+    while ( _levels.at(k).x.size() >= LOD_MIN_LEVEL_SIZE ) {
+        int beginIdx = 4*beginGroup; // first changed point of level k
+        beginGroup = beginIdx/LOD_GROUP_SIZE;
+        if ( k+1 == _levels.size() ) {
+            _levels.append(Level());
+            beginGroup = 0;
+        }
+        const Level& prev = _levels.at(k);
+        _reduce(prev.x.constData(),prev.y.constData(),prev.x.size(),
+                _levels[k+1],beginGroup);
+        ++k;
+    }
+}
+
+// Four points (first,min,max,last) per group of LOD_GROUP_SIZE points.
+// Groups line up with the buckets of the level below, so the extrema of
+// a group are the extrema of the raw points it covers.
+void CurveLOD::_reduce(const double *x, const double *y, int n, Level &out,
+                       int beginGroup)
+{
+    int nGroups = (n+LOD_GROUP_SIZE-1)/LOD_GROUP_SIZE;
+    out.x.resize(4*nGroups);
+    out.y.resize(4*nGroups);
+
+    int k = 4*beginGroup;
+    for ( int beg = beginGroup*LOD_GROUP_SIZE; beg < n; beg += LOD_GROUP_SIZE ) {
+        int end = qMin(beg+LOD_GROUP_SIZE,n);
+        int iMin = beg;
+        int iMax = beg;
+        for ( int i = beg+1; i < end; ++i ) {
+            if ( y[i] < y[iMin] ) iMin = i;
+            if ( y[i] > y[iMax] ) iMax = i;
+        }
+        int a = qMin(iMin,iMax);
+        int b = qMax(iMin,iMax);
+        int idxs[4] = { beg, a, b, end-1 };
+        for ( int j = 0; j < 4; ++j ) {
+            out.x[k] = x[idxs[j]];
+            out.y[k] = y[idxs[j]];
+            ++k;
+        }
+    }
+}
+
+// First point with x >= xVal
+int CurveLOD::_lowerBound(double xVal) const
+{
+    const double* x = _points->xData();
+    int lo = 0;
+    int hi = _points->count();
+    while ( lo < hi ) {
+        int mid = (lo+hi)/2;
+        if ( x[mid] < xVal ) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// First point with x > xVal
+int CurveLOD::_upperBound(double xVal) const
+{
+    const double* x = _points->xData();
+    int lo = 0;
+    int hi = _points->count();
+    while ( lo < hi ) {
+        int mid = (lo+hi)/2;
+        if ( x[mid] <= xVal ) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+QPainterPath CurveLOD::path(double xmin, double xmax, int nPixels) const
+{
+    QPainterPath p;
+
+    int n = _points->count();
+    if ( n == 0 ) {
+        return p;
+    }
+
+    if ( !_isMonotonic ) {
+        // No ordering on x (e.g. phase plot), draw all of it
+        return _points->toPainterPath();
+    }
+
+    // Visible range plus a point on either side so lines that leave
+    // the viewport are still drawn to the edge
+    int i0 = qMax(_lowerBound(xmin)-1,0);
+    int i1 = qMin(_upperBound(xmax)+1,n);
+    if ( i1 <= i0 ) {
+        return p;
+    }
+
+    double pointsPerPixel = (i1-i0)/(double)qMax(nPixels,1);
+    int level = 0;
+    qint64 bucket = LOD_GROUP_SIZE; // curve points per level 1 bucket
+    if ( isDecimatable() ) {
+        while ( level < _levels.size() && bucket <= pointsPerPixel ) {
+            ++level;
+            bucket *= 4;
+        }
+    }
+
+    if ( level == 0 ) {
+        p = _points->toPainterPath(i0,i1);
+    } else {
+        bucket /= 4; // bucket size of chosen level
+        const Level& L = _levels.at(level-1);
+        int j0 = 4*(int)(i0/bucket);
+        int j1 = qMin((int)(4*((i1-1)/bucket+1)),L.x.size());
+        p.moveTo(L.x.at(j0),L.y.at(j0));
+        for ( int j = j0+1; j < j1; ++j ) {
+            p.lineTo(L.x.at(j),L.y.at(j));
+        }
+    }
+
+    return p;
+}
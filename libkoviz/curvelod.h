@@ -0,0 +1,59 @@
+#ifndef CURVE_LOD_H
+#define CURVE_LOD_H
+
+#include <QPainterPath>
+#include "curvepoints.h"
+#include <QVector>
+#include <QList>
+
+//
+// Min/max level-of-detail pyramid over curve points.
+//
+// Level 1 splits the curve into buckets of 16 points and keeps four
+// points per bucket (first, min y, max y, last in index order).  Each
+// following level does the same over groups of 16 points of the level
+// below, so level k keeps four points per 4^(k+1) curve points.  Spikes
+// survive every level since bucket extrema are always kept.
+//
+// path() picks the coarsest level that still has a bucket per pixel
+// column for the visible x range, so a redraw costs O(pixels) points
+// and zooming in simply drops to finer levels.  Only curves whose x is
+// non-decreasing (e.g. time plots) are decimated, other curves are
+// drawn whole.
+//
+class CurveLOD
+{
+  public:
+    CurveLOD(const CurvePoints* points);
+
+    // Points were appended to the curve (see PlotBookModel::growCurves()),
+    // only the buckets they touch are redone
+    void grow();
+
+    bool isDecimatable() const { return _isMonotonic && !_levels.isEmpty(); }
+    int levelCount() const { return _levels.size(); }
+
+    QPainterPath path(double xmin, double xmax, int nPixels) const;
+
+  private:
+    struct Level
+    {
+        QVector<double> x;
+        QVector<double> y;
+    };
+
+    const CurvePoints* _points;
+    int _count;         // number of points the pyramid covers
+    bool _isMonotonic;
+    QList<Level> _levels;
+
+    void _build(int beginPoint);
+
+    int _lowerBound(double x) const;
+    int _upperBound(double x) const;
+
+    static void _reduce(const double* x, const double* y, int n,
+                        Level& out, int beginGroup=0);
+};
+
+#endif // CURVE_LOD_H
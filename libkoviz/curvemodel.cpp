@@ -1,3 +1,4 @@
+#include <QVector>
 #include "curvemodel.h"
 
 CurveModel::CurveModel() :
@@ -6,7 +7,8 @@ CurveModel::CurveModel() :
     _datamodel(0),
     _t(0),
     _x(0),
-    _y(0)
+    _y(0),
+    _timeIndex(0)
 {}
 
 CurveModel::CurveModel(DataModel *datamodel,
@@ -21,7 +23,8 @@ CurveModel::CurveModel(DataModel *datamodel,
     _ycol(ycol),
     _t(new CurveModelParameter),
     _x(new CurveModelParameter),
-    _y(new CurveModelParameter)
+    _y(new CurveModelParameter),
+    _timeIndex(0)
 {
     _t->setName(_datamodel->param(_tcol)->name());
     _t->setUnit(_datamodel->param(_tcol)->unit());
@@ -46,6 +49,7 @@ CurveModel::~CurveModel()
         _imag = 0;
     }
 
+    delete _timeIndex;
 }
 
 int CurveModel::rowCount(const QModelIndex &pidx) const
@@ -66,6 +70,86 @@ int CurveModel::columnCount(const QModelIndex &pidx) const
     }
 }
 
+void CurveModel::values(int beginRow, int endRow,
+                        double *t, double *x, double *y) const
+{
+    if ( endRow <= beginRow ) {
+        return;
+    }
+
+    if ( _datamodel ) {
+        if ( t ) _datamodel->columnValues(_tcol,beginRow,endRow,t);
+        if ( x ) _datamodel->columnValues(_xcol,beginRow,endRow,x);
+        if ( y ) _datamodel->columnValues(_ycol,beginRow,endRow,y);
+        return;
+    }
+
+    // Derived curve models hold their own data, walk their iterator
+    ModelIterator* it = begin();
+    it = it->at(beginRow);
+    for ( int i = 0; i < endRow-beginRow; ++i ) {
+        if ( t ) t[i] = it->t();
+        if ( x ) x[i] = it->x();
+        if ( y ) y[i] = it->y();
+        it->next();
+    }
+    delete it;
+}
+
+int CurveModel::indexAtTime(double time)
+{
+    if ( _datamodel ) {
+        return _datamodel->indexAtTime(time);
+    }
+
+    return timeIndex()->indexAtTime(time);
+}
+
+const TimeIndex* CurveModel::timeIndex() const
+{
+    if ( _datamodel ) {
+        return _datamodel->timeIndex(_tcol);
+    }
+
+    // Derived models decode their own time once
+    QMutexLocker locker(&_statsMutex);
+    if ( !_timeIndex ) {
+        int nrows = rowCount();
+        QVector<double> times(nrows);
+        values(0,nrows,times.data(),0,0);
+        _timeIndex = new TimeIndex(times);
+    }
+
+    return _timeIndex;
+}
+
+ColumnStats CurveModel::_stats(int col) const
+{
+    if ( _datamodel ) {
+        int dcol = ( col == 0 ) ? _tcol : ( col == 1 ) ? _xcol : _ycol;
+        return _datamodel->columnStats(dcol);
+    }
+
+    QMutexLocker locker(&_statsMutex);
+    if ( !_col2stats.contains(col) ) {
+        ColumnStats stats;
+        int nrows = rowCount();
+        const int chunkSize = 65536;
+        QVector<double> chunk(qMin(chunkSize,nrows));
+        double* t = ( col == 0 ) ? chunk.data() : 0;
+        double* x = ( col == 1 ) ? chunk.data() : 0;
+        double* y = ( col == 2 ) ? chunk.data() : 0;
+        for ( int row = 0; row < nrows; row += chunkSize ) {
+            int n = qMin(chunkSize,nrows-row);
+            values(row,row+n,t,x,y);
+            stats.accumulate(chunk.constData(),n);
+        }
+        _col2stats.insert(col,stats);
+    }
+
+    return _col2stats.value(col);
+}
+
 // TODO CurveModel::data() --- for now, return empty QVariant
 QVariant CurveModel::data (const QModelIndex & index, int role ) const
 
@@ -29,8 +29,29 @@ class CurveModel : public QAbstractTableModel
 
     virtual void map() { _datamodel->map(); }
     virtual void unmap() { _datamodel->unmap(); }
+    virtual void pin() { if ( _datamodel ) _datamodel->pin(); }
+    virtual void unpin() { if ( _datamodel ) _datamodel->unpin(); }
+    virtual void advise(MapPool::Advice advice)
+    {
+        if ( _datamodel ) _datamodel->advise(advice);
+    }
     virtual ModelIterator* begin() const { return _datamodel->begin(_tcol,_xcol,_ycol);}
-    virtual int indexAtTime(double time) { return _datamodel->indexAtTime(time); }
+    virtual int indexAtTime(double time);
+
+    // Index of the t column, safe to use from a worker thread.  Model
+    // must be mapped for the first request.
+    const TimeIndex* timeIndex() const;
+
+    // Bulk read of rows [beginRow,endRow) into t,x,y (any may be null)
+    virtual void values(int beginRow, int endRow,
+                        double* t, double* x, double* y) const;
+
+    // Column summaries (see DataModel::columnStats()), model must be
+    // mapped for the first request.  Derived models are summarized once
+    // from their own data.
+    ColumnStats tStats() const { return _stats(0); }
+    ColumnStats xStats() const { return _stats(1); }
+    ColumnStats yStats() const { return _stats(2); }
 
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
@@ -50,6 +71,10 @@ class CurveModel : public QAbstractTableModel
     CurveModelParameter* _x;
     CurveModelParameter* _y;
 
+    mutable QMutex _statsMutex;
+    mutable QHash<int,ColumnStats> _col2stats;  // derived models only
+    mutable TimeIndex* _timeIndex;               // derived models only
+    ColumnStats _stats(int col) const;
 };
 
 #endif // CURVE_MODEL_H
@@ -2,40 +2,36 @@
 
 CurveModelBW::CurveModelBW(CurveModel *curveModel, double frequency) :
     _freq(frequency),
+    _data(0),
     _ncols(3),
     _nrows(0),
     _t(new CurveModelParameter),
     _x(new CurveModelParameter),
-    _y(new CurveModelParameter),
-    _iteratorTimeIndex(0)
+    _y(new CurveModelParameter)
 {
-    if ( curveModel->x()->unit() != "s" ) {
-        fprintf(stderr,"koviz [bad scoobs]: CurveModelBW given curve with "
-                       "xunit=%s.  It must be in seconds.\n",
-                curveModel->x()->unit().toLatin1().constData());
-        exit(-1);
-    }
-
-    _fileName = curveModel->fileName();
-    _t->setName("time");
-    _t->setUnit("s");
-    _x->setName("time");
-    _x->setUnit("s");
-    _y->setName(curveModel->y()->name());
-    _y->setUnit(curveModel->y()->unit());
-
-    _iteratorTimeIndex = new BWModelIterator(this);
-
+    _setParams(curveModel);
     _init(curveModel);
 }
 
+CurveModelBW::CurveModelBW(CurveModel *curveModel, double frequency,
+                           double beginTime, double dt,
+                           const double *ys, int n) :
+    _freq(frequency),
+    _data(0),
+    _ncols(3),
+    _nrows(0),
+    _t(new CurveModelParameter),
+    _x(new CurveModelParameter),
+    _y(new CurveModelParameter)
+{
+    _setParams(curveModel);
+    _setData(beginTime,dt,ys,n);
+}
+
 // See ~CurveModel() too
 CurveModelBW::~CurveModelBW()
 {
-    if ( _iteratorTimeIndex ) {
-        delete _iteratorTimeIndex;
-        _iteratorTimeIndex = 0;
-    }
+    free(_data);
 }
 
 ModelIterator* CurveModelBW::begin() const
@@ -43,64 +39,6 @@ ModelIterator* CurveModelBW::begin() const
     return new BWModelIterator(this);
 }
 
-int CurveModelBW::indexAtTime(double time)
-{
-    return _idxAtTimeBinarySearch(_iteratorTimeIndex,0,rowCount()-1,time);
-}
-
-int CurveModelBW::_idxAtTimeBinarySearch (BWModelIterator* it,
-                                       int low, int high, double time)
-{
-        if (high <= 0 ) {
-                return 0;
-        }
-        if (low >= high) {
-                // Time not found, choose closest near high
-                double t1 = it->at(high-1)->t();
-                double t2 = it->at(high)->t();
-                double t3 = t2;
-                it = it->at(high+1);
-                if ( !it->isDone() ) {
-                    t3 = it->at(high+1)->t();
-                }
-
-                int i;
-                if ( qAbs(time-t1) < qAbs(time-t2) ) {
-                    if ( qAbs(time-t1) < qAbs(time-t3) ) {
-                        i = high-1;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                } else {
-                    if ( qAbs(time-t2) < qAbs(time-t3) ) {
-                        i = high;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                }
-                return i;
-        } else {
-                int mid = (low + high)/2;
-                if (time == it->at(mid)->t()) {
-                        return mid;
-                } else if ( time < it->at(mid)->t() ) {
-                        return _idxAtTimeBinarySearch(it,
-                                                      low, mid-1, time);
-                } else {
-                        return _idxAtTimeBinarySearch(it,
-                                                      mid+1, high, time);
-                }
-        }
-}
-
 int CurveModelBW::rowCount(const QModelIndex &pidx) const
 {
     if ( !pidx.isValid() ) {
@@ -187,3 +125,33 @@ void CurveModelBW::_init(CurveModel* curveModel)
     delete it;
     curveModel->unmap();
 }
+
+void CurveModelBW::_setParams(CurveModel* curveModel)
+{
+    if ( curveModel->x()->unit() != "s" ) {
+        fprintf(stderr,"koviz [bad scoobs]: CurveModelBW given curve with "
+                       "xunit=%s.  It must be in seconds.\n",
+                curveModel->x()->unit().toLatin1().constData());
+        exit(-1);
+    }
+
+    _fileName = curveModel->fileName();
+    _t->setName("time");
+    _t->setUnit("s");
+    _x->setName("time");
+    _x->setUnit("s");
+    _y->setName(curveModel->y()->name());
+    _y->setUnit(curveModel->y()->unit());
+}
+
+void CurveModelBW::_setData(double beginTime, double dt,
+                            const double* ys, int n)
+{
+    _nrows = n;
+    _data = (double*)malloc(_nrows*_ncols*sizeof(double));
+    for ( int i = 0; i < n; ++i ) {
+        _data[i*_ncols+0] = beginTime+dt*i;
+        _data[i*_ncols+1] = beginTime+dt*i;
+        _data[i*_ncols+2] = ys[i];
+    }
+}
@@ -22,6 +22,12 @@ class CurveModelBW : public CurveModel
 
     explicit CurveModelBW(CurveModel* curveModel, double frequency);
 
+    // Samples already filtered (see FilterJob), spaced dt apart from
+    // beginTime.  Names and units come from curveModel.
+    explicit CurveModelBW(CurveModel* curveModel, double frequency,
+                          double beginTime, double dt,
+                          const double* ys, int n);
+
     ~CurveModelBW();
 
     CurveModelParameter* t() { return _t; }
@@ -33,7 +39,6 @@ class CurveModelBW : public CurveModel
     void map() {}
     void unmap() {}
     ModelIterator* begin() const ;
-    int indexAtTime(double time);
 
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
@@ -53,11 +58,11 @@ class CurveModelBW : public CurveModel
     CurveModelParameter* _t;
     CurveModelParameter* _x;
     CurveModelParameter* _y;
-    BWModelIterator* _iteratorTimeIndex;
 
     void _init(CurveModel* curveModel);
-    int _idxAtTimeBinarySearch (BWModelIterator* it,
-                                int low, int high, double time);
+    void _setParams(CurveModel* curveModel);
+    void _setData(double beginTime, double dt,
+                  const double* ys, int n);
 };
 
 class BWModelIterator : public ModelIterator
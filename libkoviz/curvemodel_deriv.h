@@ -35,7 +35,6 @@ class CurveModelDerivative : public CurveModel
     void map() {}
     void unmap() {}
     ModelIterator* begin() const ;
-    int indexAtTime(double time);
 
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
@@ -55,11 +54,8 @@ class CurveModelDerivative : public CurveModel
     CurveModelParameter* _x;
     CurveModelParameter* _y;
 
-    DerivativeModelIterator* _iteratorTimeIndex;
 
     void _init(CurveModel *curveModel);
-    int _idxAtTimeBinarySearch (DerivativeModelIterator *it,
-                                int low, int high, double time);
 };
 
 class DerivativeModelIterator : public ModelIterator
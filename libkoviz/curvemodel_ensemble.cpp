@@ -0,0 +1,314 @@
+#include "curvemodel_ensemble.h"
+#include <QThreadPool>
+#include <QRegularExpression>
+#include <algorithm>
+
+CurveModelEnsemble::CurveModelEnsemble(CurveModel *curveModel,
+                                       const QString &stat, int nrows) :
+    _stat(stat),
+    _ncols(3),
+    _nrows(nrows),
+    _t(new CurveModelParameter),
+    _x(new CurveModelParameter),
+    _y(new CurveModelParameter)
+{
+    _fileName = curveModel->fileName();
+    _t->setName(curveModel->t()->name());
+    _t->setUnit(curveModel->t()->unit());
+    _x->setName(curveModel->t()->name());
+    _x->setUnit(curveModel->t()->unit());
+    _y->setName(curveModel->y()->name());
+    _y->setUnit(curveModel->y()->unit());
+
+    _data = (double*)malloc(_nrows*_ncols*sizeof(double));
+}
+
+CurveModelEnsemble::~CurveModelEnsemble()
+{
+    free(_data);
+}
+
+QList<CurveModel *> CurveModelEnsemble::createCurves(
+                                             const QList<CurveModel *> &curves,
+                                             const QStringList &stats)
+{
+    QList<CurveModel*> ensembleCurves;
+    if ( curves.isEmpty() || stats.isEmpty() ) {
+        return ensembleCurves;
+    }
+
+    QList<Stat> parsedStats;
+    foreach ( QString stat, stats ) {
+        Stat s;
+        if ( !_parseStat(stat,&s) ) {
+            fprintf(stderr,"koviz [bad scoobs]: CurveModelEnsemble given "
+                           "bad stat=\"%s\".\n", stat.toLatin1().constData());
+            exit(-1);
+        }
+        parsedStats.append(s);
+    }
+
+    // Timeline is the run with the most rows, runs are converted to
+    // its y unit (and have their own y scale/bias applied)
+    CurveModel* refCurve = curves.at(0);
+    foreach ( CurveModel* curve, curves ) {
+        curve->pin();
+        if ( curve->rowCount() > refCurve->rowCount() ) {
+            refCurve = curve;
+        }
+    }
+    QString yUnit = refCurve->y()->unit();
+    QVector<double> scales;
+    QVector<double> biases;
+    foreach ( CurveModel* curve, curves ) {
+        QString u = curve->y()->unit();
+        double s = 1.0;
+        double b = 0.0;
+        if ( u != yUnit && Unit::canConvert(u,yUnit) ) {
+            s = Unit::scale(u,yUnit);
+            b = Unit::bias(u,yUnit);
+        }
+        scales.append(s*curve->y()->scale());
+        biases.append(s*curve->y()->bias()+b);
+    }
+
+    int nrows = refCurve->rowCount();
+    QVector<double> times(nrows);
+    refCurve->values(0,nrows,times.data(),0,0);
+
+    QList<CurveModelEnsemble*> outs;
+    foreach ( QString stat, stats ) {
+        CurveModelEnsemble* out = new CurveModelEnsemble(refCurve,stat,nrows);
+        double* data = out->_data;
+        for ( int i = 0; i < nrows; ++i ) {
+            data[i*3+0] = times.at(i);
+            data[i*3+1] = times.at(i);
+        }
+        outs.append(out);
+        ensembleCurves.append(out);
+    }
+
+    // Blocks hold rows*runs values, a block per pool thread at a time
+    int nRuns = curves.size();
+    int blockRows = qBound(256,_blockValues/nRuns,65536);
+    QThreadPool pool;
+    for ( int beg = 0; beg < nrows; beg += blockRows ) {
+        int end = qMin(nrows,beg+blockRows);
+        pool.start(new EnsembleBlock(curves,scales,biases,times,
+                                     outs,parsedStats,beg,end));
+    }
+    pool.waitForDone();
+
+    foreach ( CurveModel* curve, curves ) {
+        curve->unpin();
+        curve->unmap();
+    }
+
+    return ensembleCurves;
+}
+
+bool CurveModelEnsemble::isStat(const QString &stat)
+{
+    Stat s;
+    return _parseStat(stat,&s);
+}
+
+bool CurveModelEnsemble::_parseStat(const QString &stat, Stat *out)
+{
+    QString s = stat.trimmed();
+    if ( s == "mean" ) {
+        out->type = Mean;
+        out->arg = 0.0;
+        return true;
+    } else if ( s == "min" ) {
+        out->type = Min;
+        out->arg = 0.0;
+        return true;
+    } else if ( s == "max" ) {
+        out->type = Max;
+        out->arg = 0.0;
+        return true;
+    }
+
+    QRegularExpression rxSigma("^([+-]\\d*\\.?\\d+)sigma$");
+    QRegularExpressionMatch match = rxSigma.match(s);
+    if ( match.hasMatch() ) {
+        out->type = Sigma;
+        out->arg = match.captured(1).toDouble();
+        return true;
+    }
+
+    QRegularExpression rxPercentile("^p(\\d*\\.?\\d+)$");
+    match = rxPercentile.match(s);
+    if ( match.hasMatch() ) {
+        double p = match.captured(1).toDouble();
+        if ( p < 0.0 || p > 100.0 ) {
+            return false;
+        }
+        out->type = Percentile;
+        out->arg = p;
+        return true;
+    }
+
+    return false;
+}
+
+ModelIterator* CurveModelEnsemble::begin() const
+{
+    return new EnsembleModelIterator(this);
+}
+
+int CurveModelEnsemble::rowCount(const QModelIndex &pidx) const
+{
+    if ( !pidx.isValid() ) {
+        return _nrows;
+    } else {
+        return 0;
+    }
+}
+
+int CurveModelEnsemble::columnCount(const QModelIndex &pidx) const
+{
+    if ( !pidx.isValid() ) {
+        return 3;
+    } else {
+        return 0;
+    }
+}
+
+// TODO CurveModel::data() --- for now, return empty QVariant
+QVariant CurveModelEnsemble::data (const QModelIndex & index, int role ) const
+{
+    Q_UNUSED(index);
+    Q_UNUSED(role);
+    QVariant v;
+    return v;
+}
+
+void EnsembleBlock::run()
+{
+    int n = _end-_beg;
+    int nRuns = _curves.size();
+    int nStats = _stats.size();
+
+    // Run values at block time stamps, a row of runs per time stamp
+    QVector<double> vals(n*nRuns,NAN);
+    for ( int r = 0; r < nRuns; ++r ) {
+        _readRun(r,vals.data());
+    }
+
+    bool isPercentile = false;
+    foreach ( CurveModelEnsemble::Stat stat, _stats ) {
+        if ( stat.type == CurveModelEnsemble::Percentile ) {
+            isPercentile = true;
+        }
+    }
+
+    QVector<double> samples(nRuns);
+    QVector<double> results(nStats);
+    for ( int i = 0; i < n; ++i ) {
+
+        // Finite samples at this time stamp
+        const double* v = vals.constData()+i*nRuns;
+        double* s = samples.data();
+        int cnt = 0;
+        double sum = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        for ( int r = 0; r < nRuns; ++r ) {
+            if ( std::isfinite(v[r]) ) {
+                if ( cnt == 0 || v[r] < min ) min = v[r];
+                if ( cnt == 0 || v[r] > max ) max = v[r];
+                s[cnt++] = v[r];
+                sum += v[r];
+            }
+        }
+
+        if ( cnt == 0 ) {
+            for ( int k = 0; k < nStats; ++k ) {
+                _outs.at(k)->_data[(_beg+i)*3+2] = NAN;
+            }
+            continue;
+        }
+
+        double mean = sum/cnt;
+        double sigma = 0.0;
+        if ( cnt > 1 ) {
+            double sumSquares = 0.0;
+            for ( int j = 0; j < cnt; ++j ) {
+                double d = s[j]-mean;
+                sumSquares += d*d;
+            }
+            sigma = std::sqrt(sumSquares/(cnt-1));
+        }
+        if ( isPercentile ) {
+            std::sort(s,s+cnt);
+        }
+
+        for ( int k = 0; k < nStats; ++k ) {
+            const CurveModelEnsemble::Stat& stat = _stats.at(k);
+            double y = 0.0;
+            switch ( stat.type ) {
+            case CurveModelEnsemble::Mean: y = mean; break;
+            case CurveModelEnsemble::Min: y = min; break;
+            case CurveModelEnsemble::Max: y = max; break;
+            case CurveModelEnsemble::Sigma: y = mean+stat.arg*sigma; break;
+            case CurveModelEnsemble::Percentile:
+            {
+                // Linear interpolation between closest ranks
+                double pos = stat.arg/100.0*(cnt-1);
+                int lo = (int)pos;
+                int hi = qMin(lo+1,cnt-1);
+                y = s[lo] + (pos-lo)*(s[hi]-s[lo]);
+                break;
+            }
+            }
+            _outs.at(k)->_data[(_beg+i)*3+2] = y;
+        }
+    }
+}
+
+// Stream run r's rows that fall in the block's time window into column r
+// of vals (time stamps the run did not log are left NaN)
+void EnsembleBlock::_readRun(int r, double *vals) const
+{
+    CurveModel* curve = _curves.at(r);
+    double scale = _scales.at(r);
+    double bias = _biases.at(r);
+    int nRuns = _curves.size();
+    int n = _end-_beg;
+    const double* times = _times.constData()+_beg;
+    double eps = TimeStamps::epsilon;
+
+    int nRows = curve->rowCount();
+    if ( nRows == 0 ) {
+        return;
+    }
+    int row = qMax(0,curve->indexAtTime(times[0])-1);
+
+    QVector<double> tbuf(_chunkSize);
+    QVector<double> ybuf(_chunkSize);
+    int bufBeg = row;
+    int bufEnd = row;
+    int i = 0;
+    while ( i < n ) {
+        if ( row >= bufEnd ) {
+            if ( row >= nRows ) {
+                break;
+            }
+            bufBeg = row;
+            bufEnd = qMin(nRows,row+_chunkSize);
+            curve->values(bufBeg,bufEnd,tbuf.data(),0,ybuf.data());
+        }
+        double t = tbuf.at(row-bufBeg);
+        if ( t < times[i]-eps ) {
+            ++row;
+        } else if ( t > times[i]+eps ) {
+            ++i;
+        } else {
+            vals[i*nRuns+r] = scale*ybuf.at(row-bufBeg)+bias;
+            ++i;
+            ++row;
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#ifndef CURVE_MODEL_ENSEMBLE_H
+#define CURVE_MODEL_ENSEMBLE_H
+
+#include <QAbstractTableModel>
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <cmath>
+#include "parameter.h"
+#include "datamodel.h"
+#include "curvemodelparameter.h"
+#include "curvemodel.h"
+#include "timestamps.h"
+#include "unit.h"
+
+class CurveModelEnsemble;
+class EnsembleModelIterator;
+class EnsembleBlock;
+
+//
+// Statistic of a parameter across an ensemble (e.g. Monte Carlo RUNs).
+//
+// createCurves() makes one curve per requested stat in a single pass over
+// the runs' curves.  Stat specs are:
+//
+//     mean, min, max       - per time stamp
+//     +Nsigma, -Nsigma     - mean +/- N sample standard deviations
+//     pN                   - Nth percentile, 0 <= N <= 100 (e.g. p5, p95)
+//
+// The timeline is the time column of the run with the most rows.  A run
+// contributes to a time stamp if it logged within TimeStamps::epsilon of
+// it, non-finite values are skipped.  Time stamps no run logged are NaN.
+//
+// Time is split into blocks which are done on a thread pool.  Each block
+// streams only its own window of every run, so memory is bounded by the
+// block size times the number of threads, not by the size of the runs.
+//
+class CurveModelEnsemble : public CurveModel
+{
+  Q_OBJECT
+
+  friend class EnsembleModelIterator;
+  friend class EnsembleBlock;
+
+  public:
+
+    static QList<CurveModel*> createCurves(const QList<CurveModel*>& curves,
+                                           const QStringList& stats);
+    static bool isStat(const QString& stat);
+
+    ~CurveModelEnsemble();
+
+    CurveModelParameter* t() { return _t; }
+    CurveModelParameter* x() { return _x; }
+    CurveModelParameter* y() { return _y; }
+
+    QString fileName() const { return _fileName; }
+    QString stat() const { return _stat; }
+
+    void map() {}
+    void unmap() {}
+    ModelIterator* begin() const ;
+
+    virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
+    virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
+    virtual QVariant data (const QModelIndex & index,
+                           int role = Qt::DisplayRole ) const ;
+
+  private:
+
+    enum StatType { Mean, Min, Max, Sigma, Percentile };
+
+    struct Stat
+    {
+        StatType type;
+        double arg;     // sigmas for Sigma, percent for Percentile
+    };
+
+    CurveModelEnsemble(CurveModel* curveModel, const QString& stat,
+                       int nrows);
+
+    QString _stat;
+    QString _fileName;
+    double* _data;
+    int _ncols;
+    int _nrows;
+    CurveModelParameter* _t;
+    CurveModelParameter* _x;
+    CurveModelParameter* _y;
+
+    static bool _parseStat(const QString& stat, Stat* out);
+
+    static const int _blockValues = 1024*1024; // per block, rows*runs
+};
+
+// Computes rows [beg,end) of all stat curves (see createCurves())
+class EnsembleBlock : public QRunnable
+{
+  public:
+    EnsembleBlock(const QList<CurveModel*>& curves,
+                  const QVector<double>& scales,
+                  const QVector<double>& biases,
+                  const QVector<double>& times,
+                  const QList<CurveModelEnsemble*>& outs,
+                  const QList<CurveModelEnsemble::Stat>& stats,
+                  int beg, int end) :
+        _curves(curves),
+        _scales(scales),
+        _biases(biases),
+        _times(times),
+        _outs(outs),
+        _stats(stats),
+        _beg(beg),
+        _end(end)
+    {
+    }
+
+    void run();
+
+  private:
+    const QList<CurveModel*>& _curves;
+    const QVector<double>& _scales;
+    const QVector<double>& _biases;
+    const QVector<double>& _times;
+    const QList<CurveModelEnsemble*>& _outs;
+    const QList<CurveModelEnsemble::Stat>& _stats;
+    int _beg;
+    int _end;
+
+    static const int _chunkSize = 4096;
+
+    void _readRun(int r, double* vals) const;
+};
+
+class EnsembleModelIterator : public ModelIterator
+{
+  public:
+
+    inline EnsembleModelIterator():
+        i(0),
+        _tcol(0),
+        _xcol(1),
+        _ycol(2)
+    {
+    }
+
+    inline EnsembleModelIterator(const CurveModelEnsemble* model) :
+        i(0),
+        _tcol(0),
+        _xcol(1),
+        _ycol(2),
+        _model(model)
+    {
+    }
+
+    virtual ~EnsembleModelIterator() {}
+
+    virtual void start()
+    {
+        i = 0;
+    }
+
+    virtual void next()
+    {
+        ++i;
+    }
+
+    virtual bool isDone() const
+    {
+        return ( i >= _model->rowCount() ) ;
+    }
+
+    virtual EnsembleModelIterator* at(int n)
+    {
+        i = n;
+        return this;
+    }
+
+    inline double t() const
+    {
+        return _model->_data[i*_model->_ncols+_tcol];
+    }
+
+    inline double x() const
+    {
+        return _model->_data[i*_model->_ncols+_xcol];
+    }
+
+    inline double y() const
+    {
+        return _model->_data[i*_model->_ncols+_ycol];
+    }
+
+  private:
+
+    int i;
+    int _tcol;
+    int _xcol;
+    int _ycol;
+    const CurveModelEnsemble* _model;
+};
+
+#endif // CURVE_MODEL_ENSEMBLE_H
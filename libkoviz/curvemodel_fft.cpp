@@ -1,4 +1,5 @@
 #include "curvemodel_fft.h"
+#include <QThreadPool>
 
 CurveModelFFT::CurveModelFFT(CurveModel *curveModel,
                              double xb, double xs,
@@ -7,98 +8,90 @@ CurveModelFFT::CurveModelFFT(CurveModel *curveModel,
     _endX(endX),
     _xb(xb),
     _xs(xs),
+    _spectrum(Magnitude),
+    _nSamples(0),
+    _dt(0.0),
+    _data(0),
     _ncols(3),
     _nrows(0),
     _t(new CurveModelParameter),
     _x(new CurveModelParameter),
-    _y(new CurveModelParameter),
-    _iteratorTimeIndex(0)
+    _y(new CurveModelParameter)
 {
-    if ( curveModel->x()->unit() != "s" ) {
-        fprintf(stderr,"koviz [bad scoobs]: CurveModelFFT given curve with "
-                       "xunit=%s.  It must be in seconds.\n",
-                curveModel->x()->unit().toLatin1().constData());
-        exit(-1);
-    }
-
-    _iteratorTimeIndex = new FFTModelIterator(this);
-
-    _fileName = curveModel->fileName();
-    _t->setName("frequency");
-    _t->setUnit("Hz");
-    _x->setName("frequency");
-    _x->setUnit("Hz");
-    _y->setName(curveModel->y()->name());
-    _y->setUnit(curveModel->y()->unit());
+    _setParams(curveModel);
+    _readSamples(curveModel);
+    _transform();
+}
 
-    _init(curveModel);
+CurveModelFFT::CurveModelFFT(CurveModel *curveModel,
+                             double xb, double xs,
+                             double begX, double endX,
+                             Spectrum spectrum) :
+    _begX(begX),
+    _endX(endX),
+    _xb(xb),
+    _xs(xs),
+    _spectrum(spectrum),
+    _nSamples(0),
+    _dt(0.0),
+    _data(0),
+    _ncols(3),
+    _nrows(0),
+    _t(new CurveModelParameter),
+    _x(new CurveModelParameter),
+    _y(new CurveModelParameter)
+{
+    _setParams(curveModel);
+    _readSamples(curveModel);
 }
 
 CurveModelFFT::~CurveModelFFT()
 {
     // See: ~CurveModel()
+    free(_data);
 }
 
-ModelIterator* CurveModelFFT::begin() const
+QList<CurveModel *> CurveModelFFT::createCurves(
+                                           const QList<CurveModel *> &curves,
+                                           const QVector<double> &xbs,
+                                           const QVector<double> &xss,
+                                           double begX, double endX,
+                                           Spectrum spectrum)
 {
-    return new FFTModelIterator(this);
-}
+    QList<CurveModel*> fftCurves;
+    QList<CurveModelFFT*> outs;
+    for ( int i = 0; i < curves.size(); ++i ) {
+        CurveModelFFT* out = new CurveModelFFT(curves.at(i),
+                                               xbs.at(i),xss.at(i),
+                                               begX,endX,spectrum);
+        outs.append(out);
+        fftCurves.append(out);
+    }
 
-int CurveModelFFT::indexAtTime(double time)
-{
-    return _idxAtTimeBinarySearch(_iteratorTimeIndex,0,rowCount()-1,time);
+    // Curves of a plot mostly share a length, hold their plans for the
+    // batch so they are built once even when over the plan cache's budget
+    QList<QSharedPointer<FFTPlan> > plans;
+    QList<int> sizes;
+    foreach ( CurveModelFFT* out, outs ) {
+        int n = out->_planSize();
+        if ( n > 0 && !sizes.contains(n) ) {
+            sizes.append(n);
+            plans.append(FFTPlan::plan(n));
+        }
+    }
+
+    QThreadPool pool;
+    foreach ( CurveModelFFT* out, outs ) {
+        pool.start(new FFTTransform(out));
+    }
+    pool.waitForDone();
+
+    return fftCurves;
 }
 
-int CurveModelFFT::_idxAtTimeBinarySearch (FFTModelIterator* it,
-                                       int low, int high, double time)
+ModelIterator* CurveModelFFT::begin() const
 {
-        if (high <= 0 ) {
-                return 0;
-        }
-        if (low >= high) {
-                // Time not found, choose closest near high
-                double t1 = it->at(high-1)->t();
-                double t2 = it->at(high)->t();
-                double t3 = t2;
-                it = it->at(high+1);
-                if ( !it->isDone() ) {
-                    t3 = it->at(high+1)->t();
-                }
-
-                int i;
-                if ( qAbs(time-t1) < qAbs(time-t2) ) {
-                    if ( qAbs(time-t1) < qAbs(time-t3) ) {
-                        i = high-1;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                } else {
-                    if ( qAbs(time-t2) < qAbs(time-t3) ) {
-                        i = high;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                }
-                return i;
-        } else {
-                int mid = (low + high)/2;
-                if (time == it->at(mid)->t()) {
-                        return mid;
-                } else if ( time < it->at(mid)->t() ) {
-                        return _idxAtTimeBinarySearch(it,
-                                                      low, mid-1, time);
-                } else {
-                        return _idxAtTimeBinarySearch(it, mid+1, high, time);
-                }
-        }
+    return new FFTModelIterator(this);
 }
 
 int CurveModelFFT::rowCount(const QModelIndex &pidx) const
@@ -129,7 +122,27 @@ QVariant CurveModelFFT::data (const QModelIndex & index, int role ) const
     return v;
 }
 
-void CurveModelFFT::_init(CurveModel* curveModel)
+void CurveModelFFT::_setParams(CurveModel *curveModel)
+{
+    if ( curveModel->x()->unit() != "s" ) {
+        fprintf(stderr,"koviz [bad scoobs]: CurveModelFFT given curve with "
+                       "xunit=%s.  It must be in seconds.\n",
+                curveModel->x()->unit().toLatin1().constData());
+        exit(-1);
+    }
+
+    _fileName = curveModel->fileName();
+    _t->setName("frequency");
+    _t->setUnit("Hz");
+    _x->setName("frequency");
+    _x->setUnit("Hz");
+    _y->setName(curveModel->y()->name());
+    _y->setUnit(curveModel->y()->unit());
+}
+
+// Samples in [begX,endX] are read into _real (NaNs replaced with the last
+// good value).  _real is left null if there are too few to transform.
+void CurveModelFFT::_readSamples(CurveModel* curveModel)
 {
     curveModel->map();
 
@@ -154,6 +167,8 @@ void CurveModelFFT::_init(CurveModel* curveModel)
     }
 
     if ( i0 == -1 || N < 2 ) {
+        delete it;
+        curveModel->unmap();
         return;
     }
 
@@ -169,11 +184,12 @@ void CurveModelFFT::_init(CurveModel* curveModel)
         it->next();
     }
     if ( dt == 0 ) {
+        delete it;
+        curveModel->unmap();
         return;
     }
 
     _real = (double*)malloc(N*sizeof(double));
-    _imag = (double*)malloc(N*sizeof(double));
 
     it = it->at(i0);
     double goodVal = 0.0;
@@ -186,34 +202,136 @@ void CurveModelFFT::_init(CurveModel* curveModel)
         break;
     }
 
-    double ys = 1.0;
-    double yb = 0.0;
     i = 0;
     it = it->at(i0);
     while ( !it->isDone() && i < N ) {
-        _real[i] = it->y()*ys+yb;
+        _real[i] = it->y();
         if ( std::isnan(_real[i]) ) {
             _real[i] = goodVal;
         }
-        _imag[i] = 0.0;
         goodVal = _real[i];
         it->next();
         ++i;
     }
     delete it;
 
-    Fft_transform(_real,_imag,N);
+    _nSamples = N;
+    _dt = dt;
+
+    curveModel->unmap();
+}
+
+int CurveModelFFT::_planSize() const
+{
+    if ( !_real ) {
+        return 0;
+    } else if ( _spectrum == WelchPSD ) {
+        // Largest power of 2 giving about _welchSegments half overlapped
+        // segments (one segment for short curves)
+        int L = 1;
+        while ( L*2 <= _nSamples &&
+                L*2 <= 2*_nSamples/(_welchSegments+1) ) {
+            L *= 2;
+        }
+        if ( L < 16 ) {
+            L = _nSamples;
+        }
+        return L;
+    } else {
+        return _nSamples;
+    }
+}
+
+// Done on a pool thread by createCurves()
+void CurveModelFFT::_transform()
+{
+    if ( !_real ) {
+        return;
+    }
+
+    if ( _spectrum == WelchPSD ) {
+        _transformWelch();
+    } else {
+        _transformMagnitude();
+    }
+}
+
+void CurveModelFFT::_transformMagnitude()
+{
+    int N = _nSamples;
+    _imag = (double*)malloc(N*sizeof(double));
+
+    // _real and _imag are kept as the spectrum for CurveModelIFFT
+    FFTPlan::plan(N)->transformReal(_real,_real,_imag);
 
     _nrows = N;
     _data = (double*)malloc(_nrows*_ncols*sizeof(double));
 
-    for ( i = 0 ; i < _nrows; ++i ) {
-        double f = (1/dt)*i/N;
+    for ( int i = 0 ; i < _nrows; ++i ) {
+        double f = (1/_dt)*i/N;
         double m = qSqrt(_real[i]*_real[i]+_imag[i]*_imag[i]);
         _data[i*_ncols+0] = f;
         _data[i*_ncols+1] = f;
         _data[i*_ncols+2] = m;
     }
+}
 
-    curveModel->unmap();
+void CurveModelFFT::_transformWelch()
+{
+    int N = _nSamples;
+    int L = _planSize();
+    int hop = qMax(1,L/2);
+    int nSegments = (N-L)/hop + 1;
+    double fs = 1/_dt;
+
+    QVector<double> window(L);
+    double U = 0.0;
+    for ( int i = 0; i < L; ++i ) {
+        window[i] = 0.5 - 0.5*cos(2*M_PI*i/L);   // Hann (periodic)
+        U += window.at(i)*window.at(i);
+    }
+    if ( U == 0.0 ) {
+        window.fill(1.0);  // L is too short for a window to make sense
+        U = L;
+    }
+
+    QSharedPointer<FFTPlan> plan = FFTPlan::plan(L);
+    QVector<double> re(L);
+    QVector<double> im(L);
+    int nFreqs = L/2+1;
+    QVector<double> psd(nFreqs,0.0);
+    for ( int s = 0; s < nSegments; ++s ) {
+        // Constant detrend, a segment's mean would otherwise leak
+        // through the window into the lowest bins
+        const double* x = _real + s*hop;
+        double mean = 0.0;
+        for ( int i = 0; i < L; ++i ) {
+            mean += x[i];
+        }
+        mean /= L;
+        for ( int i = 0; i < L; ++i ) {
+            re[i] = (x[i]-mean)*window.at(i);
+        }
+        plan->transformReal(re.constData(),re.data(),im.data());
+        for ( int k = 0; k < nFreqs; ++k ) {
+            psd[k] += re.at(k)*re.at(k) + im.at(k)*im.at(k);
+        }
+    }
+
+    _nrows = nFreqs;
+    _data = (double*)malloc(_nrows*_ncols*sizeof(double));
+    for ( int k = 0; k < nFreqs; ++k ) {
+        double p = psd.at(k)/(fs*U*nSegments);
+        if ( k > 0 && 2*k < L ) {
+            p *= 2.0;  // One sided, negative frequencies folded in
+        }
+        double f = fs*k/L;
+        _data[k*_ncols+0] = f;
+        _data[k*_ncols+1] = f;
+        _data[k*_ncols+2] = p;
+    }
+
+    // Not a spectrum CurveModelIFFT can invert
+    free(_real);
+    _real = 0;
 }
@@ -4,26 +4,45 @@
 #include <QAbstractTableModel>
 #include <QString>
 #include <QtMath>
+#include <QList>
+#include <QVector>
+#include <QRunnable>
 #include "parameter.h"
 #include "datamodel.h"
 #include "curvemodelparameter.h"
 #include "curvemodel.h"
 #include "fft.h"
+#include "fftplan.h"
 
 class CurveModelFFT;
 class FFTModelIterator;
+class FFTTransform;
 
 class CurveModelFFT : public CurveModel
 {
   Q_OBJECT
 
   friend class FFTModelIterator;
+  friend class FFTTransform;
 
   public:
 
+    // Magnitude - |DFT| of the samples in [begX,endX] (default)
+    // WelchPSD  - one sided power spectral density (y unit squared per Hz)
+    //             averaged over Hann windowed segments overlapped by half,
+    //             each segment's mean is removed first
+    enum Spectrum { Magnitude, WelchPSD };
+
     explicit CurveModelFFT(CurveModel* curveModel, double xb, double xs,
                            double begX, double endX);
 
+    // Samples are read here, curves are transformed on a thread pool
+    static QList<CurveModel*> createCurves(const QList<CurveModel*>& curves,
+                                           const QVector<double>& xbs,
+                                           const QVector<double>& xss,
+                                           double begX, double endX,
+                                           Spectrum spectrum=Magnitude);
+
     ~CurveModelFFT();
 
     CurveModelParameter* t() { return _t; }
@@ -35,7 +54,6 @@ class CurveModelFFT : public CurveModel
     void map() {}
     void unmap() {}
     ModelIterator* begin() const ;
-    int indexAtTime(double time);
 
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
@@ -49,6 +67,9 @@ class CurveModelFFT : public CurveModel
     double _endX;
     double _xb;
     double _xs;
+    Spectrum _spectrum;
+    int _nSamples;     // in _real, see _readSamples()
+    double _dt;
     double* _data;
     int _ncols;
     int _nrows;
@@ -59,11 +80,28 @@ class CurveModelFFT : public CurveModel
     CurveModelParameter* _x;
     CurveModelParameter* _y;
 
-    FFTModelIterator* _iteratorTimeIndex;
+    CurveModelFFT(CurveModel* curveModel, double xb, double xs,
+                  double begX, double endX, Spectrum spectrum);
+
+    void _setParams(CurveModel* curveModel);
+    void _readSamples(CurveModel* curveModel);
+    int _planSize() const;
+    void _transform();
+    void _transformMagnitude();
+    void _transformWelch();
+
+    static const int _welchSegments = 8;   // about, at half overlap
+};
 
-    void _init(CurveModel *curveModel);
-    int _idxAtTimeBinarySearch (FFTModelIterator *it,
-                                int low, int high, double time);
+// Transforms one curve of CurveModelFFT::createCurves()
+class FFTTransform : public QRunnable
+{
+  public:
+    FFTTransform(CurveModelFFT* model) : _model(model) {}
+    void run() { _model->_transform(); }
+
+  private:
+    CurveModelFFT* _model;
 };
 
 class FFTModelIterator : public ModelIterator
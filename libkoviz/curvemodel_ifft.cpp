@@ -8,8 +8,7 @@ CurveModelIFFT::CurveModelIFFT(CurveModel *curveModel,
     _nrows(0),
     _t(new CurveModelParameter),
     _x(new CurveModelParameter),
-    _y(new CurveModelParameter),
-    _iteratorTimeIndex(0)
+    _y(new CurveModelParameter)
 {
     if ( curveModel->x()->unit() != "Hz" ) {
         fprintf(stderr,"koviz [bad scoobs]: CurveModelIFFT given curve with "
@@ -26,8 +25,6 @@ CurveModelIFFT::CurveModelIFFT(CurveModel *curveModel,
     _y->setName(curveModel->y()->name());
     _y->setUnit(curveModel->y()->unit());
 
-    _iteratorTimeIndex = new IFFTModelIterator(this);
-
     if ( curveModel->_real != 0 && curveModel->_imag != 0 ) {
         _init(curveModel);
     } else {
@@ -38,10 +35,6 @@ CurveModelIFFT::CurveModelIFFT(CurveModel *curveModel,
 // See ~CurveModel() too
 CurveModelIFFT::~CurveModelIFFT()
 {
-    if ( _iteratorTimeIndex ) {
-        delete _iteratorTimeIndex;
-        _iteratorTimeIndex = 0;
-    }
 }
 
 ModelIterator* CurveModelIFFT::begin() const
@@ -49,64 +42,6 @@ ModelIterator* CurveModelIFFT::begin() const
     return new IFFTModelIterator(this);
 }
 
-int CurveModelIFFT::indexAtTime(double time)
-{
-    return _idxAtTimeBinarySearch(_iteratorTimeIndex,0,rowCount()-1,time);
-}
-
-int CurveModelIFFT::_idxAtTimeBinarySearch (IFFTModelIterator* it,
-                                       int low, int high, double time)
-{
-        if (high <= 0 ) {
-                return 0;
-        }
-        if (low >= high) {
-                // Time not found, choose closest near high
-                double t1 = it->at(high-1)->t();
-                double t2 = it->at(high)->t();
-                double t3 = t2;
-                it = it->at(high+1);
-                if ( !it->isDone() ) {
-                    t3 = it->at(high+1)->t();
-                }
-
-                int i;
-                if ( qAbs(time-t1) < qAbs(time-t2) ) {
-                    if ( qAbs(time-t1) < qAbs(time-t3) ) {
-                        i = high-1;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                } else {
-                    if ( qAbs(time-t2) < qAbs(time-t3) ) {
-                        i = high;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                }
-                return i;
-        } else {
-                int mid = (low + high)/2;
-                if (time == it->at(mid)->t()) {
-                        return mid;
-                } else if ( time < it->at(mid)->t() ) {
-                        return _idxAtTimeBinarySearch(it,
-                                                      low, mid-1, time);
-                } else {
-                        return _idxAtTimeBinarySearch(it,
-                                                      mid+1, high, time);
-                }
-        }
-}
-
 int CurveModelIFFT::rowCount(const QModelIndex &pidx) const
 {
     if ( !pidx.isValid() ) {
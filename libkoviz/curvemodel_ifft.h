@@ -34,7 +34,6 @@ class CurveModelIFFT : public CurveModel
     void map() {}
     void unmap() {}
     ModelIterator* begin() const ;
-    int indexAtTime(double time);
 
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
@@ -55,11 +54,8 @@ class CurveModelIFFT : public CurveModel
     CurveModelParameter* _t;
     CurveModelParameter* _x;
     CurveModelParameter* _y;
-    IFFTModelIterator* _iteratorTimeIndex;
 
     void _init(CurveModel* curveModel);
-    int _idxAtTimeBinarySearch (IFFTModelIterator* it,
-                                int low, int high, double time);
 };
 
 class IFFTModelIterator : public ModelIterator
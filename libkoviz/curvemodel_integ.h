@@ -35,7 +35,6 @@ class CurveModelIntegral : public CurveModel
     void map() {}
     void unmap() {}
     ModelIterator* begin() const ;
-    int indexAtTime(double time);
 
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
@@ -55,11 +54,8 @@ class CurveModelIntegral : public CurveModel
     CurveModelParameter* _x;
     CurveModelParameter* _y;
 
-    IntegralModelIterator* _iteratorTimeIndex;
 
     void _init(CurveModel *curveModel, double initial_value);
-    int _idxAtTimeBinarySearch (IntegralModelIterator *it,
-                                int low, int high, double time);
 };
 
 class IntegralModelIterator : public ModelIterator
@@ -23,6 +23,12 @@ class CurveModelSG : public CurveModel
 
     explicit CurveModelSG(CurveModel* curveModel,int window,int degree);
 
+    // Samples already filtered (see FilterJob), spaced dt apart from
+    // beginTime.  Names and units come from curveModel.
+    explicit CurveModelSG(CurveModel* curveModel,int window,int degree,
+                          double beginTime, double dt,
+                          const double* ys, int n);
+
     ~CurveModelSG();
 
     CurveModelParameter* t() { return _t; }
@@ -34,7 +40,6 @@ class CurveModelSG : public CurveModel
     void map() {}
     void unmap() {}
     ModelIterator* begin() const ;
-    int indexAtTime(double time);
 
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
@@ -55,11 +60,11 @@ class CurveModelSG : public CurveModel
     CurveModelParameter* _t;
     CurveModelParameter* _x;
     CurveModelParameter* _y;
-    SGModelIterator* _iteratorTimeIndex;
 
     void _init(CurveModel* curveModel);
-    int _idxAtTimeBinarySearch (SGModelIterator* it,
-                                int low, int high, double time);
+    void _setParams(CurveModel* curveModel);
+    void _setData(double beginTime, double dt,
+                  const double* ys, int n);
 };
 
 class SGModelIterator : public ModelIterator
@@ -0,0 +1,78 @@
+#include "curvepoints.h"
+
+CurvePoints::CurvePoints() :
+    _xmin(DBL_MAX),
+    _xmax(-DBL_MAX),
+    _ymin(DBL_MAX),
+    _ymax(-DBL_MAX)
+{
+}
+
+void CurvePoints::reserve(int n)
+{
+    _x.reserve(n);
+    _y.reserve(n);
+}
+
+void CurvePoints::squeeze()
+{
+    _x.squeeze();
+    _y.squeeze();
+}
+
+void CurvePoints::append(double x, double y)
+{
+    _x.append(x);
+    _y.append(y);
+    if ( x < _xmin ) _xmin = x;
+    if ( x > _xmax ) _xmax = x;
+    if ( y < _ymin ) _ymin = y;
+    if ( y > _ymax ) _ymax = y;
+}
+
+// Same as QPainterPath::boundingRect() i.e. a null rect when empty
+QRectF CurvePoints::boundingRect() const
+{
+    if ( _x.isEmpty() ) {
+        return QRectF();
+    }
+    return QRectF(_xmin,_ymin,_xmax-_xmin,_ymax-_ymin);
+}
+
+// Unlike QRectF::intersects(), a flat (zero height or width) curve
+// still intersects rects it passes through
+bool CurvePoints::isBoundingRectIntersects(const QRectF &rect) const
+{
+    if ( _x.isEmpty() ) {
+        return false;
+    }
+    QRectF r = rect.normalized();
+    return ( _xmin <= r.right() && _xmax >= r.left() &&
+             _ymin <= r.bottom() && _ymax >= r.top() );
+}
+
+QPainterPath CurvePoints::toPainterPath() const
+{
+    return toPainterPath(0,_x.size());
+}
+
+// Path through points [beg,end)
+QPainterPath CurvePoints::toPainterPath(int beg, int end) const
+{
+    QPainterPath path;
+
+    beg = qMax(beg,0);
+    end = qMin(end,_x.size());
+    if ( beg >= end ) {
+        return path;
+    }
+
+    const double* x = _x.constData();
+    const double* y = _y.constData();
+    path.moveTo(x[beg],y[beg]);
+    for ( int i = beg+1; i < end; ++i ) {
+        path.lineTo(x[i],y[i]);
+    }
+
+    return path;
+}
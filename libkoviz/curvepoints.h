@@ -0,0 +1,53 @@
+#ifndef CURVE_POINTS_H
+#define CURVE_POINTS_H
+
+#include <QVector>
+#include <QPointF>
+#include <QRectF>
+#include <QPainterPath>
+#include <float.h>
+
+//
+// Plot ready curve points, one point per sampled model row.
+//
+// x and y are kept in separate contiguous arrays (16 bytes/point versus
+// the 24+ bytes of a QPainterPath element) and the bounding box is kept
+// up to date as points are appended.  Unlike a painter path, every
+// appended point is stored, so point i always lines up with sample i
+// for live coordinates and symbols (see Note 2 in bookmodel.cpp).
+//
+// Painter paths are only made for drawing, see toPainterPath().
+//
+class CurvePoints
+{
+  public:
+    CurvePoints();
+
+    void reserve(int n);
+    void squeeze();
+    void append(double x, double y);
+
+    int count() const { return _x.size(); }
+    bool isEmpty() const { return _x.isEmpty(); }
+    double x(int i) const { return _x.at(i); }
+    double y(int i) const { return _y.at(i); }
+    QPointF at(int i) const { return QPointF(_x.at(i),_y.at(i)); }
+    const double* xData() const { return _x.constData(); }
+    const double* yData() const { return _y.constData(); }
+
+    QRectF boundingRect() const;
+    bool isBoundingRectIntersects(const QRectF& rect) const;
+
+    QPainterPath toPainterPath() const;
+    QPainterPath toPainterPath(int beg, int end) const;
+
+  private:
+    QVector<double> _x;
+    QVector<double> _y;
+    double _xmin;
+    double _xmax;
+    double _ymin;
+    double _ymax;
+};
+
+#endif // CURVE_POINTS_H
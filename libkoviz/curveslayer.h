@@ -0,0 +1,72 @@
+#ifndef CURVES_LAYER_H
+#define CURVES_LAYER_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QImage>
+#include <QSize>
+#include <QPainter>
+#include "pagepicture.h"
+
+//
+// Rasterizes a CurvesView curve layer on a pool thread.
+//
+// The view records the layer (background, grid, curves) on the GUI thread
+// into a PagePicture that reports the viewport's metrics, which is cheap
+// since curve paths come from the model's cached points.  Replaying the
+// picture into an image, where the antialiased line drawing is done, is
+// what runs here.  The generation is handed back with finished() so the
+// view can drop images of replaced jobs.
+//
+class CurvesLayerJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    CurvesLayerJob(PagePicture* picture, const QSize& size, int generation) :
+        _picture(picture),
+        _size(size),
+        _generation(generation)
+    {
+        setAutoDelete(false); // CurvesView owns jobs
+    }
+
+    ~CurvesLayerJob()
+    {
+        delete _picture;
+    }
+
+    void run()
+    {
+        _image = render(*_picture,_size);
+        emit finished(_generation);
+    }
+
+    int generation() const { return _generation; }
+    QImage image() const { return _image; }
+
+    // Also used by the view when there is nothing to show while waiting
+    static QImage render(const PagePicture& picture, const QSize& size)
+    {
+        QImage image(size,QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        // Same dpi as the recording so fonts are not rescaled on replay
+        image.setDotsPerMeterX(qRound(picture.logicalDpiX()/0.0254));
+        image.setDotsPerMeterY(qRound(picture.logicalDpiY()/0.0254));
+        QPainter painter(&image);
+        painter.drawPicture(0,0,picture);
+        painter.end();
+        return image;
+    }
+
+signals:
+    void finished(int generation);
+
+private:
+    PagePicture* _picture;
+    QSize _size;
+    int _generation;
+    QImage _image;
+};
+
+#endif // CURVES_LAYER_H
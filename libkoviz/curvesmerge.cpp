@@ -0,0 +1,130 @@
+#include "curvesmerge.h"
+
+CurvesMerge::CurvesMerge(const QList<CurveModel *> &curves,
+                         double start, double stop, double epsilon) :
+    _curves(curves),
+    _start(start),
+    _stop(stop),
+    _epsilon(epsilon),
+    _time(0.0)
+{
+    _values.fill(0.0,_curves.size());
+
+    // Group curves by file (curves in a file share the time column)
+    QHash<QString,int> key2cursor;
+    for ( int i = 0; i < _curves.size(); ++i ) {
+        CurveModel* curve = _curves.at(i);
+        if ( !curve ) continue;
+        QString key = curve->fileName() + "\n" + curve->t()->name();
+        if ( !key2cursor.contains(key) ) {
+            Cursor cursor;
+            cursor.nRows = curve->rowCount();
+            cursor.row = 0;
+            cursor.bufBeg = 0;
+            key2cursor.insert(key,_cursors.size());
+            _cursors.append(cursor);
+        }
+        Cursor& cursor = _cursors[key2cursor.value(key)];
+        cursor.curves.append(i);
+        cursor.ys.append(QVector<double>());
+    }
+
+    // Skip rows before start
+    for ( int j = 0; j < _cursors.size(); ++j ) {
+        Cursor& cursor = _cursors[j];
+        while ( cursor.row < cursor.nRows &&
+                _t(cursor,cursor.row) < _start ) {
+            ++cursor.row;
+        }
+    }
+}
+
+bool CurvesMerge::next()
+{
+    // Next time stamp is the smallest unmerged time across cursors.
+    // There is a cursor per file (not per param), so a linear scan
+    // is cheaper than keeping a heap.
+    bool isFound = false;
+    double tmin = 0.0;
+    for ( int j = 0; j < _cursors.size(); ++j ) {
+        Cursor& cursor = _cursors[j];
+        if ( _isDone(cursor) ) continue;
+        double t = _t(cursor,cursor.row);
+        if ( !isFound || t < tmin ) {
+            tmin = t;
+            isFound = true;
+        }
+    }
+    if ( !isFound ) {
+        return false;
+    }
+    _time = tmin;
+
+    for ( int j = 0; j < _cursors.size(); ++j ) {
+        Cursor& cursor = _cursors[j];
+        if ( cursor.nRows == 0 ) continue;
+
+        // Row closest to stamp, cursor.row is the first row at/after it
+        int k;
+        if ( cursor.row >= cursor.nRows ) {
+            k = cursor.nRows-1;
+        } else if ( cursor.row == 0 ) {
+            k = 0;
+        } else {
+            double tr = _t(cursor,cursor.row);
+            double tl = _t(cursor,cursor.row-1);
+            k = ( tmin-tl < tr-tmin ) ? cursor.row-1 : cursor.row;
+        }
+        for ( int i = 0; i < cursor.curves.size(); ++i ) {
+            _values[cursor.curves.at(i)] = _y(cursor,i,k);
+        }
+
+        // Step past rows merged into this stamp
+        while ( cursor.row < cursor.nRows &&
+                _t(cursor,cursor.row) <= tmin+_epsilon ) {
+            ++cursor.row;
+        }
+    }
+
+    return true;
+}
+
+bool CurvesMerge::_isDone(Cursor &cursor)
+{
+    return ( cursor.row >= cursor.nRows || _t(cursor,cursor.row) > _stop );
+}
+
+double CurvesMerge::_t(Cursor &cursor, int row)
+{
+    if ( row < cursor.bufBeg || row >= cursor.bufBeg+cursor.t.size() ) {
+        _load(cursor,row);
+    }
+    return cursor.t.at(row-cursor.bufBeg);
+}
+
+double CurvesMerge::_y(Cursor &cursor, int i, int row)
+{
+    if ( row < cursor.bufBeg || row >= cursor.bufBeg+cursor.t.size() ) {
+        _load(cursor,row);
+    }
+    return cursor.ys.at(i).at(row-cursor.bufBeg);
+}
+
+// Load chunk starting one row back, so the row before the cursor
+// (needed for closest row) is in the same chunk
+void CurvesMerge::_load(Cursor &cursor, int row)
+{
+    int beg = qMax(0,row-1);
+    int end = qMin(cursor.nRows,beg+_chunkSize);
+    int n = end-beg;
+
+    cursor.bufBeg = beg;
+    cursor.t.resize(n);
+    _curves.at(cursor.curves.first())->values(beg,end,
+                                              cursor.t.data(),0,0);
+    for ( int i = 0; i < cursor.curves.size(); ++i ) {
+        QVector<double>& y = cursor.ys[i];
+        y.resize(n);
+        _curves.at(cursor.curves.at(i))->values(beg,end,0,0,y.data());
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef CURVES_MERGE_H
+#define CURVES_MERGE_H
+
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <QHash>
+#include <float.h>
+#include "curvemodel.h"
+#include "timestamps.h"
+
+//
+// Streaming k-way merge of the (sorted) time columns of several curves.
+//
+// Each call to next() steps to the next time stamp on the union timeline
+// and samples every curve at it (the curve's row closest to the stamp,
+// same as CurveModel::indexAtTime()).  Curves from the same file share
+// one cursor, so the merge is over files, not params.  Rows are read in
+// fixed size chunks, memory is bounded by chunk size * number of curves
+// regardless of log length.
+//
+// Curves must be mapped by the caller for the life of the merge.
+// Null curves are allowed and are sampled as 0.0.
+//
+class CurvesMerge
+{
+  public:
+    CurvesMerge(const QList<CurveModel*>& curves,
+                double start=-DBL_MAX, double stop=DBL_MAX,
+                double epsilon=TimeStamps::epsilon);
+
+    bool next();   // false when timeline in [start,stop] is done
+
+    double time() const { return _time; }
+    double value(int i) const { return _values.at(i); }
+    const QVector<double>& values() const { return _values; }
+
+  private:
+
+    // Time cursor over one file and the curves which share it
+    struct Cursor
+    {
+        QList<int> curves;          // indices into _curves
+        int nRows;
+        int row;                    // next row not yet merged
+        int bufBeg;                 // row of buf index 0
+        QVector<double> t;
+        QList<QVector<double> > ys; // one per curve
+    };
+
+    QList<CurveModel*> _curves;
+    QList<Cursor> _cursors;
+    double _start;
+    double _stop;
+    double _epsilon;
+    double _time;
+    QVector<double> _values;
+
+    static const int _chunkSize = 4096;
+
+    double _t(Cursor& cursor, int row);
+    double _y(Cursor& cursor, int i, int row);
+    void _load(Cursor& cursor, int row);
+    bool _isDone(Cursor& cursor);
+};
+
+#endif // CURVES_MERGE_H
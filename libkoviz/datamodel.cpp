@@ -1,16 +1,18 @@
 #include <QFileInfo>
+#include <QVector>
 #include "datamodel.h"
 #include "datamodel_trick.h"
 #include "datamodel_csv.h"
 #include "datamodel_mot.h"
 
 DataModel *DataModel::createDataModel(const QStringList &timeNames,
-                                      const QString &fileName)
+                                      const QString &fileName,
+                                      TrickHeaderCache *headerCache)
 {
     DataModel* dataModel = 0;
     QFileInfo fi(fileName);
     if ( fi.suffix() == "trk") {
-        dataModel = new TrickModel(timeNames,fileName);
+        dataModel = new TrickModel(timeNames,fileName,headerCache);
     } else if ( fi.suffix() == "csv" ) {
         dataModel = new CsvModel(timeNames,fileName);
     } else if ( fi.suffix() == "mot" ) {
@@ -23,3 +25,158 @@ DataModel *DataModel::createDataModel(const QStringList &timeNames,
 
     return dataModel;
 }
+
+void DataModel::columnValues(int col, int beginRow, int endRow,
+                             double *out) const
+{
+    if ( endRow <= beginRow ) {
+        return;
+    }
+    ModelIterator* it = begin(col,col,col);
+    it = it->at(beginRow);
+    for ( int i = beginRow; i < endRow; ++i ) {
+        *out++ = it->y();
+        it->next();
+    }
+    delete it;
+}
+
+ColumnStats DataModel::columnStats(int col) const
+{
+    _statsMutex.lock();
+    if ( _col2stats.contains(col) ) {
+        ColumnStats stats = _col2stats.value(col);
+        _statsMutex.unlock();
+        return stats;
+    }
+    _statsMutex.unlock();
+
+    // Two threads may both compute a column, the answer is the same
+    ColumnStats stats;
+    int nrows = rowCount();
+    const int chunkSize = 65536;
+    QVector<double> chunk(qMin(chunkSize,nrows));
+    for ( int row = 0; row < nrows; row += chunkSize ) {
+        int n = qMin(chunkSize,nrows-row);
+        columnValues(col,row,row+n,chunk.data());
+        stats.accumulate(chunk.constData(),n);
+    }
+
+    _statsMutex.lock();
+    _col2stats.insert(col,stats);
+    _statsMutex.unlock();
+
+    return stats;
+}
+
+const TimeIndex* DataModel::timeIndex(int timeCol) const
+{
+    _statsMutex.lock();
+    TimeIndex* timeIndex = _col2timeIndex.value(timeCol,0);
+    _statsMutex.unlock();
+    if ( timeIndex ) {
+        return timeIndex;
+    }
+
+    int nrows = rowCount();
+    QVector<double> times(nrows);
+    columnValues(timeCol,0,nrows,times.data());
+    timeIndex = new TimeIndex(times);
+
+    _statsMutex.lock();
+    if ( _col2timeIndex.contains(timeCol) ) {
+        // Another thread beat us to it
+        delete timeIndex;
+        timeIndex = _col2timeIndex.value(timeCol);
+    } else {
+        _col2timeIndex.insert(timeCol,timeIndex);
+    }
+    _statsMutex.unlock();
+
+    return timeIndex;
+}
+
+void DataModel::_growCaches(int beginRow)
+{
+    int nrows = rowCount();
+    if ( nrows <= beginRow ) {
+        return;
+    }
+
+    _statsMutex.lock();
+    QList<int> statsCols = _col2stats.keys();
+    QList<int> timeCols = _col2timeIndex.keys();
+    _statsMutex.unlock();
+
+    const int chunkSize = 65536;
+    QVector<double> chunk(qMin(chunkSize,nrows-beginRow));
+
+    foreach ( int col, statsCols ) {
+        ColumnStats stats = columnStats(col);
+        for ( int row = beginRow; row < nrows; row += chunkSize ) {
+            int n = qMin(chunkSize,nrows-row);
+            columnValues(col,row,row+n,chunk.data());
+            stats.accumulate(chunk.constData(),n);
+        }
+        _statsMutex.lock();
+        _col2stats.insert(col,stats);
+        _statsMutex.unlock();
+    }
+
+    foreach ( int col, timeCols ) {
+        _statsMutex.lock();
+        TimeIndex* timeIndex = _col2timeIndex.value(col);
+        _statsMutex.unlock();
+        for ( int row = beginRow; row < nrows; row += chunkSize ) {
+            int n = qMin(chunkSize,nrows-row);
+            columnValues(col,row,row+n,chunk.data());
+            timeIndex->append(chunk.constData(),n);
+        }
+    }
+}
+
+// The loops are branch free (v-v is 0 only for finite v, and compares
+// against nan are false) so the compiler can vectorize them.
+void ColumnStats::accumulate(const double *v, int n)
+{
+    if ( n <= 0 ) {
+        return;
+    }
+
+    qint64 cnt = 0;
+    double mn = min;
+    double mx = max;
+    for ( int i = 0; i < n; ++i ) {
+        double x = v[i];
+        bool isFinite = ( x-x == 0.0 );
+        cnt += isFinite;
+        mn = ( isFinite && x < mn ) ? x : mn;
+        mx = ( isFinite && x > mx ) ? x : mx;
+    }
+
+    int isDecreasing = 0;
+    for ( int i = 1; i < n; ++i ) {
+        isDecreasing |= ( v[i] < v[i-1] );
+    }
+
+    if ( cnt > 0 ) {
+        int i = 0;
+        while ( v[i]-v[i] != 0.0 ) ++i;
+        int j = n-1;
+        while ( v[j]-v[j] != 0.0 ) --j;
+        if ( nFinite == 0 ) {
+            first = v[i];
+        } else if ( v[i] < last ) {
+            isDecreasing = 1; // across the chunk seam
+        }
+        last = v[j];
+    }
+
+    min = mn;
+    max = mx;
+    nFinite += cnt;
+    nNonFinite += n-cnt;
+    if ( isDecreasing ) {
+        isMonotonic = false;
+    }
+}
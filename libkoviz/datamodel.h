@@ -8,11 +8,43 @@
 #include <QAbstractTableModel>
 #include <QString>
 #include <QStringList>
+#include <QMutex>
+#include <float.h>
 #include "parameter.h"
+#include "timeindex.h"
+#include "mappool.h"
 
 class DataModel;
+class TrickHeaderCache;
 class ModelIterator;
 
+// One pass summary of a column (see DataModel::columnStats()).
+// Non-finite values (nan/inf) are counted but otherwise ignored.
+struct ColumnStats
+{
+    double min;
+    double max;
+    qint64 nFinite;
+    qint64 nNonFinite;
+    double first;      // first finite value (e.g. start time)
+    double last;       // last finite value (e.g. stop time)
+    bool isMonotonic;  // finite values never decrease (e.g. a time column)
+
+    ColumnStats() :
+        min(DBL_MAX), max(-DBL_MAX),
+        nFinite(0), nNonFinite(0),
+        first(0.0), last(0.0),
+        isMonotonic(true)
+    {
+    }
+
+    inline bool isEmpty() const { return nFinite == 0; }
+    inline bool isFlat() const { return nFinite > 0 && min == max; }
+
+    // Fold n more values (in column order) into the summary
+    void accumulate(const double* v, int n);
+};
+
 class DataModel : public QAbstractTableModel
 {
   Q_OBJECT
@@ -27,29 +59,68 @@ class DataModel : public QAbstractTableModel
         _fileName(fileName)
     {}
 
-    ~DataModel() {}
+    ~DataModel() { qDeleteAll(_col2timeIndex); }
 
     static DataModel* createDataModel(const QStringList& timeNames,
-                                      const QString& fileName);
+                                      const QString& fileName,
+                                      TrickHeaderCache* headerCache=0);
 
     QString fileName() const { return _fileName; }
 
     virtual void map() = 0;
     virtual void unmap() = 0;
+
+    // Keep the model mapped while a worker thread reads it.  While pinned,
+    // unmap() is a no-op.  Models whose map() is a no-op need not override.
+    virtual void pin() { map(); }
+    virtual void unpin() {}
+
+    // Access pattern hint for file backed models (see MapPool)
+    virtual void advise(MapPool::Advice advice) { Q_UNUSED(advice); }
+
+    // Pick up records appended to the file since it was loaded (e.g. a
+    // sim that is still logging).  Returns the number of new rows, or -1
+    // if the model is pinned or could not be remapped and should be asked
+    // again later.  Models that read their file whole do not grow.
+    virtual int grow() { return 0; }
+
     virtual const Parameter* param(int col) const = 0;
     virtual int paramColumn(const QString& param) const = 0;
     virtual ModelIterator* begin(int tcol, int xcol, int ycol) const = 0;
     virtual int indexAtTime(double time) = 0 ;
 
+    // Bulk read of rows [beginRow,endRow) of col into out (model must be
+    // mapped).  Default walks an iterator, models override with a kernel.
+    virtual void columnValues(int col, int beginRow, int endRow,
+                              double* out) const;
+
+    // Summary of col, computed on first request and cached.  The model
+    // must be mapped (or pinned) for the first request.  Thread safe.
+    ColumnStats columnStats(int col) const;
+
+    // Decoded time column (see TimeIndex) that models answer indexAtTime()
+    // with.  Built on first request (model must be mapped), thread safe.
+    const TimeIndex* timeIndex(int timeCol) const;
+
     virtual int rowCount(const QModelIndex& pidx=QModelIndex()) const = 0;
     virtual int columnCount(const QModelIndex& pidx=QModelIndex()) const = 0;
     virtual QVariant data(const QModelIndex& idx,
                           int role=Qt::DisplayRole) const = 0;
 
+  protected:
+
+    // Fold rows [beginRow,rowCount()) into the cached column stats and
+    // time indexes, called by grow() with the model mapped
+    void _growCaches(int beginRow);
+
   private:
 
     QStringList _timeNames;
     QString _fileName;
+
+    mutable QMutex _statsMutex;
+    mutable QHash<int,ColumnStats> _col2stats;
+    mutable QHash<int,TimeIndex*> _col2timeIndex;
 };
 
 class ModelIterator
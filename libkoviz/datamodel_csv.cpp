@@ -1,14 +1,15 @@
 #include "datamodel_csv.h"
+#ifdef __linux
+#include <sys/mman.h>
+#endif
 
-QString CsvModel::_err_string;
-QTextStream CsvModel::_err_stream(&CsvModel::_err_string);
 
 CsvModel::CsvModel(const QStringList& timeNames,
                    const QString& csvfile,
                    QObject *parent) :
     DataModel(timeNames, csvfile, parent),
     _timeNames(timeNames),_csvfile(csvfile),
-    _nrows(0), _ncols(0),_iteratorTimeIndex(0),
+    _nrows(0), _ncols(0),
     _data(0)
 {
     _init();
@@ -19,14 +20,43 @@ void CsvModel::_init()
     QFile file(_csvfile);
 
     if (!file.open(QIODevice::ReadOnly)) {
-        _err_stream << "koviz [error]: could not open "
-                    << _csvfile << "\n";
-        throw std::runtime_error(_err_string.toLatin1().constData());
+        QString msg = QString("koviz [error]: could not open %1\n")
+                      .arg(_csvfile);
+        throw std::runtime_error(msg.toLatin1().constData());
+    }
+
+    // Map the whole file, fields are parsed straight out of the mapping
+    qint64 fileSize = file.size();
+    const char* mem = 0;
+    if ( fileSize > 0 ) {
+        mem = (const char*) file.map(0,fileSize);
+        if ( mem == 0 ) {
+            QString msg = QString("koviz [error]: could not map %1\n")
+                          .arg(_csvfile);
+            throw std::runtime_error(msg.toLatin1().constData());
+        }
+#ifdef __linux
+        madvise((void*)mem,fileSize,MADV_SEQUENTIAL);
+#endif
+    }
+    const char* fileEnd = mem + fileSize;
+
+    // Header line (skip utf-8 byte order mark like QTextStream does)
+    const char* p = mem;
+    if ( fileSize >= 3 && memcmp(p,"\xEF\xBB\xBF",3) == 0 ) {
+        p += 3;
+    }
+    const char* nl = 0;
+    if ( p < fileEnd ) {
+        nl = (const char*) memchr(p,'\n',fileEnd-p);
+    }
+    const char* headerEnd = nl ? nl : fileEnd;
+    const char* dataBeg = nl ? nl+1 : fileEnd;
+    if ( headerEnd > p && headerEnd[-1] == '\r' ) {
+        --headerEnd;
     }
-    QTextStream in(&file);
-    in.setCodec("UTF-8");
+    QString line0 = QString::fromUtf8(p,headerEnd-p);
 
-    QString line0 = in.readLine();
     QStringList items = line0.split(',',QString::SkipEmptyParts);
     int col = 0;
     foreach ( QString item, items ) {
@@ -76,80 +106,205 @@ void CsvModel::_init()
         }
     }
     if ( ! isFoundTime ) {
-        _err_stream << "koviz [error]: couldn't find time param \""
-                    << _timeNames.join("=") << "\" in file=" << _csvfile
-                    << ".  Try setting -timeName on commandline option.";
-        throw std::runtime_error(_err_string.toLatin1().constData());
+        QString msg = QString("koviz [error]: couldn't find time param "
+                              "\"%1\" in file=%2.  Try setting "
+                              "-timeName on commandline option.")
+                      .arg(_timeNames.join("=")).arg(_csvfile);
+        throw std::runtime_error(msg.toLatin1().constData());
     }
 
-    _iteratorTimeIndex = new CsvModelIterator(0,this,
-                                              _timeCol,_timeCol,_timeCol);
+    _parse(dataBeg,fileEnd);
 
+    if ( mem ) {
+        file.unmap((uchar*)mem);
+    }
+    file.close();
+}
+
+// Parse csv data lines [beg,end) into _data with a thread per chunk
+void CsvModel::_parse(const char* beg, const char* end)
+{
 #ifdef __linux
     TimeItLinux timer;
     timer.start();
 #endif
 
-    // Get number of data rows in csv file
-    while ( !in.atEnd() ) {
-        in.readLine();
-        ++_nrows;
-    }
-
-    // Allocate to hold *all* parsed data
-    _data = (double*)malloc(_nrows*_ncols*sizeof(double));
-
-    // Begin Progress Dialog
-    QString msg("Loading ");
-    msg += QFileInfo(fileName()).fileName();
-    msg += "...";
-    QProgressDialog progress(msg, "Abort", 0, _nrows-1, 0);
-    progress.setWindowModality(Qt::WindowModal);
-    int row = 0;
-
-    // Read in data
-    in.seek(0);
-    in.readLine(); // csv header line
-    int i = 0;
-    while ( !in.atEnd() ) {
-        if (progress.wasCanceled()) {
-             break;
+    // Off the gui thread, files are already loaded in parallel on the
+    // Runs loader pool, so each file is parsed serially there
+    QCoreApplication* app = QCoreApplication::instance();
+    bool isGuiThread = ( app && QThread::currentThread() == app->thread() );
+
+    // Chunks start on line boundaries, small files get a single chunk
+    // which is parsed on the calling thread
+    const qint64 minChunkSize = 1024*1024;
+    qint64 len = end-beg;
+    int nThreads = isGuiThread ? qMax(QThread::idealThreadCount(),1) : 1;
+    int nChunks = (int) qMax(qMin((qint64)nThreads,len/minChunkSize),
+                             (qint64)1);
+    QVector<const char*> bounds(nChunks+1);
+    bounds[0] = beg;
+    bounds[nChunks] = end;
+    for ( int i = 1; i < nChunks; ++i ) {
+        const char* q = qMax(beg + (len*i)/nChunks, bounds.at(i-1));
+        const char* nl = 0;
+        if ( q < end ) {
+            nl = (const char*) memchr(q,'\n',end-q);
+        }
+        bounds[i] = nl ? nl+1 : end;
+    }
+
+    // Pass 1: count rows per chunk
+    QList<CsvParseThread*> threads;
+    QVector<int> chunkRow(nChunks);
+    _nrows = 0;
+    if ( nChunks == 1 ) {
+        _nrows = _countRows(beg,end);
+    } else {
+        for ( int i = 0; i < nChunks; ++i ) {
+            threads << new CsvParseThread(CsvParseThread::CountRows,
+                                          bounds.at(i),bounds.at(i+1));
+        }
+        foreach ( CsvParseThread* thread, threads ) {
+            thread->start();
         }
-        if ( row % 10000 == 0 ) {
-            progress.setValue(row);
+        for ( int i = 0; i < nChunks; ++i ) {
+            threads.at(i)->wait();
+            chunkRow[i] = _nrows;
+            _nrows += threads.at(i)->rowCount();
+            delete threads.at(i);
         }
-        ++row;
-
-        QString line = in.readLine();
-        int from = 0;
-        while (1) {
-            int j = line.indexOf(',',from);
-            if ( j < 0 ) {
-                _data[i] = _convert(line.mid(from,line.size()-from));
-                ++i;
+        threads.clear();
+    }
+
+    // Allocate to hold *all* parsed data (zeroed in case of abort)
+    size_t nvals = (size_t)_nrows*(size_t)_ncols;
+    _data = (double*)calloc(nvals > 0 ? nvals : 1,sizeof(double));
+    if ( _data == 0 ) {
+        QString msg = QString("koviz [error]: could not allocate memory "
+                              "for %1\n").arg(_csvfile);
+        throw std::runtime_error(msg.toLatin1().constData());
+    }
+
+    // Pass 2: parse chunks
+    QAtomicInt rowsDone(0);
+    QAtomicInt isAbort(0);
+    if ( nChunks == 1 ) {
+        _parseRows(beg,end,_ncols,_data,&rowsDone,&isAbort);
+        return;
+    }
+    for ( int i = 0; i < nChunks; ++i ) {
+        double* out = _data + (size_t)chunkRow.at(i)*_ncols;
+        threads << new CsvParseThread(CsvParseThread::ParseRows,
+                                      bounds.at(i),bounds.at(i+1),
+                                      _ncols,out,&rowsDone,&isAbort);
+    }
+    foreach ( CsvParseThread* thread, threads ) {
+        thread->start();
+    }
+
+    // Progress Dialog only when loading on the gui thread, the Runs
+    // loader pool shows its own progress
+    QProgressDialog* progress = 0;
+    if ( isGuiThread ) {
+        QString msg("Loading ");
+        msg += QFileInfo(fileName()).fileName();
+        msg += "...";
+        progress = new QProgressDialog(msg, "Abort", 0, _nrows-1, 0);
+        progress->setWindowModality(Qt::WindowModal);
+    }
+
+    bool isRunning = true;
+    while ( isRunning ) {
+        isRunning = false;
+        foreach ( CsvParseThread* thread, threads ) {
+            if ( !thread->wait(50) ) {
+                isRunning = true;
                 break;
             }
-            _data[i] = _convert(line.mid(from,j-from));
-            from = j+1;
-            ++i;
         }
-
+        if ( progress ) {
+            if ( progress->wasCanceled() ) {
+                isAbort.fetchAndStoreOrdered(1);
+            }
+            int row = rowsDone.load();
+            progress->setValue(row);
 #ifdef __linux
-        if ( row % 10000 == 0 ) {
             int secs = qRound(timer.stop()/1000000.0);
             div_t d = div(secs,60);
             QString msg = QString("Loaded %1 of %2 lines "
                                   "(%3 min %4 sec)")
                     .arg(row).arg(_nrows).arg(d.quot).arg(d.rem);
-            progress.setLabelText(msg);
-        }
+            progress->setLabelText(msg);
 #endif
+        }
+    }
+
+    foreach ( CsvParseThread* thread, threads ) {
+        delete thread;
     }
 
     // End Progress Dialog
-    progress.setValue(_nrows-1);
+    if ( progress ) {
+        progress->setValue(_nrows-1);
+        delete progress;
+    }
+}
 
-    file.close();
+// Number of lines in [beg,end), a last line without newline counts
+int CsvModel::_countRows(const char *beg, const char *end)
+{
+    int nrows = 0;
+    const char* p = beg;
+    while ( p < end ) {
+        const char* nl = (const char*) memchr(p,'\n',end-p);
+        if ( nl == 0 ) {
+            ++nrows;
+            break;
+        }
+        ++nrows;
+        p = nl+1;
+    }
+    return nrows;
+}
+
+// Parse lines [beg,end) into out (row major, ncols per row).
+// Missing fields are left zero and extra fields are ignored.
+void CsvModel::_parseRows(const char *beg, const char *end,
+                          int ncols, double *out,
+                          QAtomicInt *rowsDone, QAtomicInt *isAbort)
+{
+    int n = 0;
+    const char* line = beg;
+    while ( line < end ) {
+        const char* nl = (const char*) memchr(line,'\n',end-line);
+        const char* lineEnd = nl ? nl : end;
+        if ( lineEnd > line && lineEnd[-1] == '\r' ) {
+            --lineEnd;
+        }
+
+        const char* field = line;
+        for ( int col = 0; col < ncols; ++col ) {
+            const char* comma = (const char*) memchr(field,',',
+                                                     lineEnd-field);
+            const char* fieldEnd = comma ? comma : lineEnd;
+            out[col] = _toDouble(field,fieldEnd);
+            if ( comma == 0 ) {
+                break;
+            }
+            field = comma+1;
+        }
+        out += ncols;
+
+        line = nl ? nl+1 : end;
+        if ( ++n == 10000 ) {
+            rowsDone->fetchAndAddRelaxed(n);
+            n = 0;
+            if ( isAbort->load() ) {
+                return;
+            }
+        }
+    }
+    rowsDone->fetchAndAddRelaxed(n);
 }
 
 void CsvModel::map()
@@ -179,11 +334,6 @@ CsvModel::~CsvModel()
         free(_data);
         _data = 0;
     }
-
-    if ( _iteratorTimeIndex ) {
-        delete _iteratorTimeIndex;
-        _iteratorTimeIndex = 0;
-    }
 }
 
 const Parameter* CsvModel::param(int col) const
@@ -193,60 +343,117 @@ const Parameter* CsvModel::param(int col) const
 
 int CsvModel::indexAtTime(double time)
 {
-    return _idxAtTimeBinarySearch(_iteratorTimeIndex,0,rowCount()-1,time);
+    return timeIndex(_timeCol)->indexAtTime(time);
+}
+
+void CsvModel::columnValues(int col, int beginRow, int endRow,
+                            double *out) const
+{
+    const double* p = _data + beginRow*_ncols + col;
+    for ( int i = beginRow; i < endRow; ++i ) {
+        *out++ = *p;
+        p += _ncols;
+    }
 }
 
-int CsvModel::_idxAtTimeBinarySearch (CsvModelIterator* it,
-                                       int low, int high, double time)
+// Plain decimal numbers with at most 19 significant digits.  The result
+// is exact (same as strtod) when the mantissa fits in 53 bits and the
+// power of ten is at most 22, otherwise false is returned and the caller
+// falls back to the slow path.
+static bool _fastStrToDouble(const char* s, const char* e, double* val)
 {
-        if (high <= 0 ) {
-                return 0;
+    static const double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+        1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    while ( s < e && (*s == ' ' || *s == '\t') ) ++s;
+    while ( e > s && (e[-1] == ' ' || e[-1] == '\t') ) --e;
+
+    bool isNeg = false;
+    if ( s < e && (*s == '-' || *s == '+') ) {
+        isNeg = ( *s == '-' );
+        ++s;
+    }
+
+    quint64 m = 0;
+    int nSigDigits = 0;
+    int exp10 = 0;
+    bool isDigits = false;
+    while ( s < e && *s >= '0' && *s <= '9' ) {
+        int d = *s - '0';
+        if ( m > 0 || d > 0 ) {
+            if ( ++nSigDigits > 19 ) return false;
+            m = m*10 + d;
         }
-        if (low >= high) {
-                // Time not found, choose closest near high
-                double t1 = it->at(high-1)->t();
-                double t2 = it->at(high)->t();
-                double t3 = t2;
-                it = it->at(high+1);
-                if ( !it->isDone() ) {
-                    t3 = it->at(high+1)->t();
-                }
+        isDigits = true;
+        ++s;
+    }
+    if ( s < e && *s == '.' ) {
+        ++s;
+        while ( s < e && *s >= '0' && *s <= '9' ) {
+            int d = *s - '0';
+            if ( m > 0 || d > 0 ) {
+                if ( ++nSigDigits > 19 ) return false;
+                m = m*10 + d;
+            }
+            --exp10;
+            isDigits = true;
+            ++s;
+        }
+    }
+    if ( !isDigits ) {
+        return false;
+    }
 
-                int i;
-                if ( qAbs(time-t1) < qAbs(time-t2) ) {
-                    if ( qAbs(time-t1) < qAbs(time-t3) ) {
-                        i = high-1;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                } else {
-                    if ( qAbs(time-t2) < qAbs(time-t3) ) {
-                        i = high;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                }
-                return i;
+    if ( s < e && (*s == 'e' || *s == 'E') ) {
+        ++s;
+        bool isExpNeg = false;
+        if ( s < e && (*s == '-' || *s == '+') ) {
+            isExpNeg = ( *s == '-' );
+            ++s;
+        }
+        if ( s == e ) {
+            return false;
+        }
+        int exp = 0;
+        while ( s < e && *s >= '0' && *s <= '9' ) {
+            if ( exp > 1000 ) return false;
+            exp = exp*10 + (*s - '0');
+            ++s;
+        }
+        exp10 += isExpNeg ? -exp : exp;
+    }
+    if ( s != e ) {
+        return false;
+    }
+
+    double v;
+    if ( m == 0 ) {
+        v = 0.0;
+    } else {
+        if ( m > (Q_UINT64_C(1) << 53) ) return false;
+        if ( exp10 < -22 || exp10 > 22 ) return false;
+        v = (double) m;
+        if ( exp10 < 0 ) {
+            v /= pow10[-exp10];
         } else {
-                int mid = (low + high)/2;
-                if (time == it->at(mid)->t()) {
-                        return mid;
-                } else if ( time < it->at(mid)->t() ) {
-                        return _idxAtTimeBinarySearch(it,
-                                                      low, mid-1, time);
-                } else {
-                        return _idxAtTimeBinarySearch(it,
-                                                      mid+1, high, time);
-                }
+            v *= pow10[exp10];
         }
+    }
+    *val = isNeg ? -v : v;
+
+    return true;
+}
+
+double CsvModel::_toDouble(const char *beg, const char *end)
+{
+    double val;
+    if ( _fastStrToDouble(beg,end,&val) ) {
+        return val;
+    }
+    return _convert(QString::fromUtf8(beg,end-beg));
 }
 
 double CsvModel::_convert(const QString &s)
@@ -9,7 +9,14 @@
 #include <QTextStream>
 #include <QProgressDialog>
 #include <QFileInfo>
+#include <QFile>
+#include <QVector>
+#include <QList>
+#include <QThread>
+#include <QAtomicInt>
+#include <QCoreApplication>
 #include <stdexcept>
+#include <string.h>
 
 #include "datamodel.h"
 #include "parameter.h"
@@ -18,12 +25,14 @@
 
 class CsvModel;
 class CsvModelIterator;
+class CsvParseThread;
 
 class CsvModel : public DataModel
 {
   Q_OBJECT
 
   friend class CsvModelIterator;
+  friend class CsvParseThread;
 
   public:
 
@@ -38,6 +47,8 @@ class CsvModel : public DataModel
     virtual int paramColumn(const QString& paramName) const ;
     virtual ModelIterator* begin(int tcol, int xcol, int ycol) const ;
     int indexAtTime(double time);
+    virtual void columnValues(int col, int beginRow, int endRow,
+                              double* out) const;
 
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
@@ -55,18 +66,70 @@ class CsvModel : public DataModel
 
     QHash<int,Parameter*> _col2param;
     QHash<QString,int> _paramName2col;
-    CsvModelIterator* _iteratorTimeIndex;
 
     double* _data;
 
-    static QString _err_string;
-    static QTextStream _err_stream;
-
     void _init();
-    int _idxAtTimeBinarySearch (CsvModelIterator *it,
-                               int low, int high, double time);
+    void _parse(const char* beg, const char* end);
+
+    static int _countRows(const char* beg, const char* end);
+    static void _parseRows(const char* beg, const char* end,
+                           int ncols, double* out,
+                           QAtomicInt* rowsDone, QAtomicInt* isAbort);
+    static double _toDouble(const char* beg, const char* end);
+    static double _convert(const QString& s);
+};
+
+//
+// Worker for CsvModel::_parse().  The data section of the csv file is
+// split on line boundaries into one chunk per thread.  The first pass
+// counts the rows in each chunk so every chunk knows where its rows go
+// in CsvModel::_data, the second pass parses the chunk in place.
+//
+class CsvParseThread : public QThread
+{
+  public:
+    enum Pass
+    {
+        CountRows,
+        ParseRows
+    };
+
+    CsvParseThread(Pass pass, const char* beg, const char* end,
+                   int ncols=0, double* out=0,
+                   QAtomicInt* rowsDone=0, QAtomicInt* isAbort=0) :
+        _pass(pass),
+        _beg(beg),
+        _end(end),
+        _ncols(ncols),
+        _out(out),
+        _rowsDone(rowsDone),
+        _isAbort(isAbort),
+        _nrows(0)
+    {
+    }
 
-    inline double _convert(const QString& s);
+    int rowCount() const { return _nrows; }
+
+  protected:
+    void run()
+    {
+        if ( _pass == CountRows ) {
+            _nrows = CsvModel::_countRows(_beg,_end);
+        } else {
+            CsvModel::_parseRows(_beg,_end,_ncols,_out,_rowsDone,_isAbort);
+        }
+    }
+
+  private:
+    Pass _pass;
+    const char* _beg;
+    const char* _end;
+    int _ncols;
+    double* _out;
+    QAtomicInt* _rowsDone;
+    QAtomicInt* _isAbort;
+    int _nrows;
 };
 
 class CsvModelIterator : public ModelIterator
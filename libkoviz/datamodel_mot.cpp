@@ -1,14 +1,11 @@
 #include "datamodel_mot.h"
 
-QString MotModel::_err_string;
-QTextStream MotModel::_err_stream(&MotModel::_err_string);
-
 MotModel::MotModel(const QStringList& timeNames,
                    const QString& motfile,
                    QObject *parent) :
     DataModel(timeNames, motfile, parent),
     _timeNames(timeNames),_motfile(motfile),
-    _nrows(0), _ncols(0),_iteratorTimeIndex(0),
+    _nrows(0), _ncols(0),
     _data(0)
 {
     _init();
@@ -19,9 +16,9 @@ void MotModel::_init()
     QFile file(_motfile);
 
     if (!file.open(QIODevice::ReadOnly)) {
-        _err_stream << "koviz [error]: could not open "
-                    << _motfile << "\n";
-        throw std::runtime_error(_err_string.toLatin1().constData());
+        QString msg = QString("koviz [error]: could not open %1\n")
+                      .arg(_motfile);
+        throw std::runtime_error(msg.toLatin1().constData());
     }
     QTextStream in(&file);
     in.setCodec("UTF-8");
@@ -89,9 +86,6 @@ void MotModel::_init()
         exit(-1);
     }
 
-    _iteratorTimeIndex = new MotModelIterator(0,this,
-                                              _timeCol,_timeCol,_timeCol);
-
     // Get number of data rows in mot file
     while ( !in.atEnd() ) {
         in.readLine();
@@ -166,11 +160,6 @@ MotModel::~MotModel()
         free(_data);
         _data = 0;
     }
-
-    if ( _iteratorTimeIndex ) {
-        delete _iteratorTimeIndex;
-        _iteratorTimeIndex = 0;
-    }
 }
 
 const Parameter* MotModel::param(int col) const
@@ -180,60 +169,17 @@ const Parameter* MotModel::param(int col) const
 
 int MotModel::indexAtTime(double time)
 {
-    return _idxAtTimeBinarySearch(_iteratorTimeIndex,0,rowCount()-1,time);
+    return timeIndex(_timeCol)->indexAtTime(time);
 }
 
-int MotModel::_idxAtTimeBinarySearch (MotModelIterator* it,
-                                       int low, int high, double time)
+void MotModel::columnValues(int col, int beginRow, int endRow,
+                            double *out) const
 {
-        if (high <= 0 ) {
-                return 0;
-        }
-        if (low >= high) {
-                // Time not found, choose closest near high
-                double t1 = it->at(high-1)->t();
-                double t2 = it->at(high)->t();
-                double t3 = t2;
-                it = it->at(high+1);
-                if ( !it->isDone() ) {
-                    t3 = it->at(high+1)->t();
-                }
-
-                int i;
-                if ( qAbs(time-t1) < qAbs(time-t2) ) {
-                    if ( qAbs(time-t1) < qAbs(time-t3) ) {
-                        i = high-1;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                } else {
-                    if ( qAbs(time-t2) < qAbs(time-t3) ) {
-                        i = high;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                }
-                return i;
-        } else {
-                int mid = (low + high)/2;
-                if (time == it->at(mid)->t()) {
-                        return mid;
-                } else if ( time < it->at(mid)->t() ) {
-                        return _idxAtTimeBinarySearch(it,
-                                                      low, mid-1, time);
-                } else {
-                        return _idxAtTimeBinarySearch(it,
-                                                      mid+1, high, time);
-                }
-        }
+    const double* p = _data + beginRow*_ncols + col;
+    for ( int i = beginRow; i < endRow; ++i ) {
+        *out++ = *p;
+        p += _ncols;
+    }
 }
 
 double MotModel::_convert(const QString &s)
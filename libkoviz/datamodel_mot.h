@@ -38,6 +38,8 @@ class MotModel : public DataModel
     virtual int paramColumn(const QString& paramName) const ;
     virtual ModelIterator* begin(int tcol, int xcol, int ycol) const ;
     int indexAtTime(double time);
+    virtual void columnValues(int col, int beginRow, int endRow,
+                              double* out) const;
 
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
@@ -55,16 +57,10 @@ class MotModel : public DataModel
 
     QHash<int,Parameter*> _col2param;
     QHash<QString,int> _paramName2col;
-    MotModelIterator* _iteratorTimeIndex;
 
     double* _data;
 
-    static QString _err_string;
-    static QTextStream _err_stream;
-
     void _init();
-    int _idxAtTimeBinarySearch (MotModelIterator *it,
-                               int low, int high, double time);
 
     inline double _convert(const QString& s);
 };
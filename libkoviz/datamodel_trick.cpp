@@ -1,20 +1,30 @@
 #include "datamodel_trick.h"
 #include <QStringList>
+#include <QFileInfo>
 #include <stdio.h>
 #include <stdexcept>
 #include <unistd.h>
 
-QString TrickModel::_err_string;
-QTextStream TrickModel::_err_stream(&TrickModel::_err_string);
 
 TrickModel::TrickModel(const QStringList& timeNames,
-                       const QString& trkfile, QObject *parent) :
+                       const QString& trkfile,
+                       TrickHeaderCache *headerCache,
+                       QObject *parent) :
     DataModel(timeNames, trkfile, parent),
     _timeNames(timeNames),_trkfile(trkfile),
     _nrows(0), _row_size(0), _ncols(0), _timeCol(0),_pos_beg_data(0),
-    _mem(0), _data(0), _fd(-1), _file(_trkfile),_iteratorTimeIndex(0)
+    _mem(0), _data(0), _fd(-1), _file(_trkfile),
+    _pinCount(0)
 {
-    _load_trick_header();
+    TrickHeader hdr;
+    if ( headerCache && headerCache->header(_trkfile,&hdr) ) {
+        _load_cached_header(hdr);
+    } else {
+        _load_trick_header();
+        if ( headerCache ) {
+            headerCache->insert(_trkfile,_header());
+        }
+    }
     map();
 }
 
@@ -23,9 +33,9 @@ bool TrickModel::_load_trick_header()
     bool ret = true;
 
     if (!_file.open(QIODevice::ReadOnly)) {
-        _err_stream << "koviz [error]: could not open "
-                    << _trkfile << "\n";
-        throw std::runtime_error(_err_string.toLatin1().constData());
+        QString msg = QString("koviz [error]: could not open %1\n")
+                      .arg(_trkfile);
+        throw std::runtime_error(msg.toLatin1().constData());
     }
     QDataStream in(&_file);
 
@@ -40,9 +50,9 @@ bool TrickModel::_load_trick_header()
     } else if ( data[0] == '0' && data[1] == '7' ) {
         _trick_version = TrickVersion07;
     } else {
-        _err_stream << "koviz [error]: unrecognized file or Trick version: "
-                    << _trkfile << "\n";
-        throw std::runtime_error(_err_string.toLatin1().constData());
+        QString msg = QString("koviz [error]: unrecognized file or "
+                              "Trick version: %1\n").arg(_trkfile);
+        throw std::runtime_error(msg.toLatin1().constData());
     }
 
     in.readRawData(data,1) ; // -
@@ -69,20 +79,35 @@ bool TrickModel::_load_trick_header()
         _paramtypes.push_back(p->type());
     }
     if ( _row_size == 0 ) {
-        _err_stream << "koviz [error]: trk file \""
-                    << _file.fileName() << "\" is corrupt!\n";
-        throw std::runtime_error(_err_string.toLatin1().constData());
+        QString msg = QString("koviz [error]: trk file \"%1\" is corrupt!\n")
+                      .arg(_file.fileName());
+        throw std::runtime_error(msg.toLatin1().constData());
     }
 
     // Sanity check. Bytes remaining should be a multiple of the record size
     qint64 nbytes = _file.bytesAvailable();
     if ( nbytes % _row_size != 0 ) {
-        _err_stream << "koviz [error]: trk file \""
-                    << _file.fileName() << "\" is corrupt!\n";
-        throw std::runtime_error(_err_string.toLatin1().constData());
+        QString msg = QString("koviz [error]: trk file \"%1\" is corrupt!\n")
+                      .arg(_file.fileName());
+        throw std::runtime_error(msg.toLatin1().constData());
     }
 
     // Make sure time param exists in model and set time column
+    _set_time_column();
+
+    // Save address of begin location of data for map()
+    _pos_beg_data = _file.pos();
+
+    // Calculate number of timestamped records in file
+    _nrows = nbytes/(qint64)_row_size;
+
+    _file.close();
+
+    return ret;
+}
+
+void TrickModel::_set_time_column()
+{
     bool isFoundTime = false;
     foreach (QString timeName, _timeNames) {
         if ( _param2column.contains(timeName)) {
@@ -92,21 +117,57 @@ bool TrickModel::_load_trick_header()
         }
     }
     if ( ! isFoundTime ) {
-        _err_stream << "koviz [error]: couldn't find time param \""
-                    << _timeNames.join("=") << "\" in trkfile=" << _trkfile
-                    << ".  Try setting -timeName on commandline option.";
-        throw std::runtime_error(_err_string.toLatin1().constData());
+        QString msg = QString("koviz [error]: couldn't find time param "
+                              "\"%1\" in trkfile=%2.  Try setting "
+                              "-timeName on commandline option.")
+                      .arg(_timeNames.join("=")).arg(_trkfile);
+        throw std::runtime_error(msg.toLatin1().constData());
     }
+}
 
-    // Save address of begin location of data for map()
-    _pos_beg_data = _file.pos();
+// Same bookkeeping as _load_trick_header() but from a cached header,
+// so the trk file is not opened until map()
+void TrickModel::_load_cached_header(const TrickHeader &hdr)
+{
+    _trick_version = (TrickVersion)hdr.trickVersion;
+    _ncols = hdr.params.size();
+    _row_size = 0;
+    for ( int cc = 0; cc < _ncols; ++cc ) {
+        const TrickHeaderParam& hp = hdr.params.at(cc);
+        TrickParameter* param = new TrickParameter;
+        param->setName(hp.name);
+        param->setUnit(hp.unit);
+        param->setType(hp.type);
+        param->setSize(hp.size);
+        _col2param.insert(cc,param);
+        _param2column.insert(hp.name,cc);
+        _col2offset[cc] = _row_size;
+        _row_size += hp.size;
+        _paramtypes.push_back(hp.type);
+    }
 
-    // Calculate number of timestamped records in file
-    _nrows = nbytes/(qint64)_row_size;
+    _set_time_column();
 
-    _file.close();
+    _pos_beg_data = hdr.posBegData;
+    _nrows = hdr.nrows;
+}
 
-    return ret;
+TrickHeader TrickModel::_header() const
+{
+    TrickHeader hdr;
+    hdr.trickVersion = (qint32)_trick_version;
+    hdr.posBegData = _pos_beg_data;
+    hdr.nrows = _nrows;
+    for ( int cc = 0; cc < _ncols; ++cc ) {
+        TrickParameter* param = _col2param.value(cc);
+        TrickHeaderParam hp;
+        hp.name = param->name();
+        hp.unit = param->unit();
+        hp.type = param->type();
+        hp.size = param->size();
+        hdr.params.append(hp);
+    }
+    return hdr;
 }
 
 // Returns byte size of parameter
@@ -150,42 +211,105 @@ qint32 TrickModel::_load_binary_param(QDataStream& in, int col)
 
 void TrickModel::map()
 {
-    if ( _data ) return; // already mapped
+    QMutexLocker locker(&_mapMutex);
+    _map();
+}
 
-    if (!_file.open(QIODevice::ReadOnly)) {
-        _err_stream << "koviz [error]: could not open "
-                    << _file.fileName() << "\n";
-        throw std::runtime_error(_err_string.toLatin1().constData());
+void TrickModel::unmap()
+{
+    QMutexLocker locker(&_mapMutex);
+    if ( _pinCount > 0 ) {
+        return; // a worker is still reading, see pin()
     }
+    _unmap();
+}
 
-    _mem = (ptrdiff_t) _file.map(0,_file.size());
+// Curve points are built on worker threads (see PlotBookModel).
+// Several curves share one TrickModel, so the GUI thread could unmap
+// the file out from under a worker.  A pin keeps the map alive.
+void TrickModel::pin()
+{
+    QMutexLocker locker(&_mapMutex);
+    _map();
+    ++_pinCount;
+}
 
-    if ( _mem == 0 ) {
-        _err_stream << "koviz [error]: TrickModel couldn't allocate memory for : "
-                    << _file.fileName() << "\n";
-        throw std::runtime_error(_err_string.toLatin1().constData());
+void TrickModel::unpin()
+{
+    QMutexLocker locker(&_mapMutex);
+    if ( _pinCount > 0 ) {
+        --_pinCount;
     }
+}
 
-    _data = _mem + _pos_beg_data;
+// A sim appends whole records to its trk file, the header does not
+// change.  Rows are picked up a whole record at a time, a record still
+// being written is left for the next grow().
+int TrickModel::grow()
+{
+    QMutexLocker locker(&_mapMutex);
+    if ( _pinCount > 0 ) {
+        return -1; // a worker is reading the current map
+    }
 
-    if ( _iteratorTimeIndex ) {
-        delete _iteratorTimeIndex;
+    qint64 nbytes = QFileInfo(_trkfile).size() - _pos_beg_data;
+    qint64 nrows = nbytes/_row_size;
+    if ( nrows <= _nrows ) {
+        return 0;
+    }
+
+    // Map the new size and fold the new rows into cached stats
+    bool isMapped = ( _data != 0 );
+    _unmap();
+    qint64 beginRow = _nrows;
+    _nrows = nrows;
+    try {
+        _map();
+    } catch (std::exception &e) {
+        // Keep the rows already loaded, the follower asks again
+        fprintf(stderr,"\n%s\n",e.what());
+        _nrows = beginRow;
+        if ( isMapped ) {
+            try {
+                _map();
+            } catch (std::exception &e) {
+                fprintf(stderr,"\n%s\n",e.what());
+            }
+        }
+        return -1;
+    }
+    _growCaches(beginRow);
+    if ( !isMapped ) {
+        _unmap();
     }
-    _iteratorTimeIndex = new TrickModelIterator(0,this,
-                                                _timeCol,_timeCol,_timeCol);
+
+    return nrows-beginRow;
 }
 
-void TrickModel::unmap()
+// Mappings come from (and go back to) the shared MapPool, so mapping
+// a recently used file does not reopen or remap it
+void TrickModel::_map()
+{
+    if ( _data ) return; // already mapped
+
+    qint64 minSize = _pos_beg_data + _nrows*_row_size;
+    _mem = (ptrdiff_t) MapPool::instance()->acquire(_trkfile,minSize);
+
+    if ( _mem == 0 ) {
+        QString msg = QString("koviz [error]: TrickModel couldn't map : "
+                              "%1\n").arg(_trkfile);
+        throw std::runtime_error(msg.toLatin1().constData());
+    }
+
+    _data = _mem + _pos_beg_data;
+}
+
+void TrickModel::_unmap()
 {
     if ( _data ) {
-        _file.unmap((uchar*)_mem);
-        _file.close();
+        MapPool::instance()->release(_trkfile);
         _data = 0 ;
     }
-    if ( _iteratorTimeIndex ) {
-        delete _iteratorTimeIndex;
-        _iteratorTimeIndex = 0;
-    }
 }
 
 ModelIterator *TrickModel::begin(int tcol, int xcol, int ycol) const
@@ -195,7 +319,7 @@ ModelIterator *TrickModel::begin(int tcol, int xcol, int ycol) const
 
 TrickModel::~TrickModel()
 {
-    unmap();
+    _unmap();
     foreach ( Parameter* param, _col2param.values() ) {
         delete param;
     }
@@ -208,7 +332,90 @@ const Parameter* TrickModel::param(int col) const
 
 int TrickModel::indexAtTime(double time)
 {
-    return _idxAtTimeBinarySearch(_iteratorTimeIndex,0,rowCount()-1,time);
+    return timeIndex(_timeCol)->indexAtTime(time);
+}
+
+void TrickModel::columnValues(int col, int beginRow, int endRow,
+                              double *out) const
+{
+    int n = endRow-beginRow;
+    if ( n <= 0 ) {
+        return;
+    }
+
+    ptrdiff_t addr = _data + beginRow*_row_size + _col2offset.value(col);
+    int paramtype = _paramtypes.at(col);
+
+    if ( _trick_version == TrickVersion07 ) {
+        switch (paramtype) {
+        case TRICK_07_DOUBLE:
+            _extractColumn<double>(addr,_row_size,n,out); break;
+        case TRICK_07_UNSIGNED_LONG_LONG:
+            _extractColumn<unsigned long long>(addr,_row_size,n,out); break;
+        case TRICK_07_LONG_LONG:
+            _extractColumn<long long>(addr,_row_size,n,out); break;
+        case TRICK_07_FLOAT:
+            _extractColumn<float>(addr,_row_size,n,out); break;
+        case TRICK_07_INTEGER:
+        case TRICK_07_ENUMERATED:
+        case TRICK_07_UNSIGNED_BITFIELD:
+        case TRICK_07_BITFIELD:
+            _extractColumn<int>(addr,_row_size,n,out); break;
+        case TRICK_07_UNSIGNED_CHARACTER:
+            _extractColumn<unsigned char>(addr,_row_size,n,out); break;
+        case TRICK_07_SHORT:
+            _extractColumn<short int>(addr,_row_size,n,out); break;
+        case TRICK_07_UNSIGNED_SHORT:
+            _extractColumn<unsigned short int>(addr,_row_size,n,out); break;
+        case TRICK_07_UNSIGNED_INTEGER:
+            _extractColumn<unsigned int>(addr,_row_size,n,out); break;
+        case TRICK_07_LONG:
+            _extractColumn<long int>(addr,_row_size,n,out); break;
+        case TRICK_07_BOOLEAN:
+            _extractColumn<bool>(addr,_row_size,n,out); break;
+        default:
+            // Let _toDouble() report the unhandled type
+            for ( int i = 0; i < n; ++i ) {
+                out[i] = _toDouble(addr+i*_row_size,paramtype);
+            }
+        }
+    } else {
+        switch (paramtype) {
+        case TRICK_10_DOUBLE:
+            _extractColumn<double>(addr,_row_size,n,out); break;
+        case TRICK_10_UNSIGNED_LONG_LONG:
+            _extractColumn<unsigned long long>(addr,_row_size,n,out); break;
+        case TRICK_10_LONG_LONG:
+            _extractColumn<long long>(addr,_row_size,n,out); break;
+        case TRICK_10_FLOAT:
+            _extractColumn<float>(addr,_row_size,n,out); break;
+        case TRICK_10_INTEGER:
+        case TRICK_10_ENUMERATED:
+        case TRICK_10_UNSIGNED_BITFIELD:
+        case TRICK_10_BITFIELD:
+            _extractColumn<int>(addr,_row_size,n,out); break;
+        case TRICK_10_UNSIGNED_CHARACTER:
+            _extractColumn<unsigned char>(addr,_row_size,n,out); break;
+        case TRICK_10_SHORT:
+            _extractColumn<short int>(addr,_row_size,n,out); break;
+        case TRICK_10_UNSIGNED_SHORT:
+            _extractColumn<unsigned short int>(addr,_row_size,n,out); break;
+        case TRICK_10_UNSIGNED_INTEGER:
+            _extractColumn<unsigned int>(addr,_row_size,n,out); break;
+        case TRICK_10_LONG:
+            _extractColumn<long int>(addr,_row_size,n,out); break;
+        case TRICK_10_BOOLEAN:
+            _extractColumn<bool>(addr,_row_size,n,out); break;
+        case TRICK_10_CHARACTER:
+            _extractColumn<char>(addr,_row_size,n,out); break;
+        case TRICK_10_UNSIGNED_LONG:
+            _extractColumn<unsigned long>(addr,_row_size,n,out); break;
+        default:
+            for ( int i = 0; i < n; ++i ) {
+                out[i] = _toDouble(addr+i*_row_size,paramtype);
+            }
+        }
+    }
 }
 
 void TrickModel::writeTrkHeader(QDataStream &out,
@@ -256,59 +463,6 @@ void TrickModel::_write_binary_qstring(QDataStream& out, const QString &str)
     out.writeRawData(str.toLatin1().constData(),str.size());
 }
 
-int TrickModel::_idxAtTimeBinarySearch (TrickModelIterator* it,
-                                       int low, int high, double time)
-{
-        if (high <= 0 ) {
-                return 0;
-        }
-        if (low >= high) {
-                // Time not found, choose closest near high
-                double t1 = it->at(high-1)->t();
-                double t2 = it->at(high)->t();
-                double t3 = t2;
-                it = it->at(high+1);
-                if ( !it->isDone() ) {
-                    t3 = it->at(high+1)->t();
-                }
-
-                int i;
-                if ( qAbs(time-t1) < qAbs(time-t2) ) {
-                    if ( qAbs(time-t1) < qAbs(time-t3) ) {
-                        i = high-1;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                } else {
-                    if ( qAbs(time-t2) < qAbs(time-t3) ) {
-                        i = high;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                }
-                return i;
-        } else {
-                int mid = (low + high)/2;
-                if (time == it->at(mid)->t()) {
-                        return mid;
-                } else if ( time < it->at(mid)->t() ) {
-                        return _idxAtTimeBinarySearch(it,
-                                                      low, mid-1, time);
-                } else {
-                        return _idxAtTimeBinarySearch(it,
-                                                      mid+1, high, time);
-                }
-        }
-}
-
 int TrickModel::rowCount(const QModelIndex &pidx) const
 {
     if ( ! pidx.isValid() ) {
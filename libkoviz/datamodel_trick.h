@@ -16,12 +16,15 @@
 #include <QAbstractTableModel>
 #include <QString>
 #include <QStringList>
+#include <QMutex>
 #include <vector>
 
 #include "datamodel.h"
 #include "snaptable.h"
 #include "trick_types.h"
 #include "parameter.h"
+#include "trickheadercache.h"
+#include "mappool.h"
 using namespace std;
 
 class TrickModel;
@@ -72,7 +75,8 @@ class TrickModel : public DataModel
 
     explicit TrickModel(const QStringList &timeNames,
                         const QString &trkfile,
-                       QObject *parent = 0);
+                        TrickHeaderCache* headerCache = 0,
+                        QObject *parent = 0);
     ~TrickModel();
 
     QString trkFile() const { return _trkfile; }
@@ -81,12 +85,21 @@ class TrickModel : public DataModel
 
     virtual void map();
     virtual void unmap();
+    virtual void pin();
+    virtual void unpin();
+    virtual int grow();
+    virtual void advise(MapPool::Advice advice)
+    {
+        MapPool::instance()->advise(_trkfile,advice);
+    }
     virtual int paramColumn(const QString& param) const
     {
         return _param2column.value(param,-1);
     }
     virtual ModelIterator* begin(int tcol, int xcol, int ycol) const ;
     int indexAtTime(double time);
+    virtual void columnValues(int col, int beginRow, int endRow,
+                              double* out) const;
 
     static void writeTrkHeader(QDataStream &out, const QList<TrickParameter> &params);
 
@@ -119,21 +132,35 @@ class TrickModel : public DataModel
     struct stat _fstat;
     QFile _file;
 
-    TrickModelIterator* _iteratorTimeIndex;
 
-    static QString _err_string;
-    static QTextStream _err_stream;
+    QMutex _mapMutex;  // guards _mem/_data/_pinCount across threads
+    int _pinCount;
+    void _map();
+    void _unmap();
 
     bool _load_trick_header();
     qint32 _load_binary_param(QDataStream& in, int col);
-    int _idxAtTimeBinarySearch (TrickModelIterator *it,
-                               int low, int high, double time);
+    void _load_cached_header(const TrickHeader& hdr);
+    TrickHeader _header() const;
+    void _set_time_column();
 
     static void _write_binary_param(QDataStream& out, const TrickParameter &p);
     static void _write_binary_qstring(QDataStream& out, const QString& str);
 
   private:
 
+    // Strided load of n values of type T spaced rowSize bytes apart.
+    // The type switch is hoisted out of the loop so this stays tight.
+    template <typename T>
+    static inline void _extractColumn(ptrdiff_t addr, qint64 rowSize,
+                                      int n, double* out)
+    {
+        for ( int i = 0; i < n; ++i ) {
+            out[i] = (double) *((const T*)(addr));
+            addr += rowSize;
+        }
+    }
+
     inline double _toDouble(ptrdiff_t addr, int paramtype) const
     {
         if ( _trick_version == TrickVersion07 ) {
@@ -0,0 +1,62 @@
+#ifndef DPPAGEBUILDER_H
+#define DPPAGEBUILDER_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QFileInfo>
+#include <QDir>
+#include <QModelIndex>
+#include <QStandardItem>
+#include <QProgressDialog>
+#include <QTextStream>
+#include <stdexcept>
+#include "dp.h"
+#include "bookmodel.h"
+#include "unit.h"
+#include "utils.h"
+#include "programmodel.h"
+
+//
+// Adds the pages (plots and curves) of DP files to a PlotBookModel.
+//
+// No widgets are needed (a load progress dialog is shown only if a
+// progress parent is given), so books can be built for headless output.
+//
+class DPPageBuilder
+{
+  public:
+    DPPageBuilder(const QString& timeName,
+                  const QStringList& runDirs,
+                  PlotBookModel* bookModel,
+                  const QStringList& unitOverrides);
+    ~DPPageBuilder();
+
+    // Returns the curves idxs of the plots made.  Page names are numbered
+    // from *idNum, which is incremented per page.
+    QModelIndexList createPages(const QString& dpfile, int* idNum,
+                                QWidget* progressParent=0);
+
+  private:
+    QString _timeName;
+    QStringList _runDirs;
+    PlotBookModel* _bookModel;
+    QStringList _unitOverrides;
+    QList<ProgramModel*> _programModels;
+
+    QStandardItem* _addChild(QStandardItem* parentItem,
+                   const QString& childTitle,
+                   const QVariant &childValue=QVariant());
+    CurveModel* _addCurve(QStandardItem* curvesItem, DPCurve* dpcurve,
+                          DPProgram *dpprogram,
+                          int runId,
+                          const QString &defaultColor,
+                          const QString &defaultLineStyle);
+    QString _descrPlotTitle(DPPlot* plot);
+
+    static QString _err_string;
+    static QTextStream _err_stream;
+};
+
+#endif // DPPAGEBUILDER_H
@@ -1,9 +1,5 @@
 #include "dptreewidget.h"
 
-#ifdef __linux
-#include "timeit_linux.h"
-#endif
-
 QString DPTreeWidget::_err_string;
 QTextStream DPTreeWidget::_err_stream(&DPTreeWidget::_err_string);
 
@@ -59,7 +55,8 @@ DPTreeWidget::DPTreeWidget(const QString& timeName,
     _isShowTables(isShowTables),
     _unitOverrides(unitOverrides),
     _gridLayout(0),
-    _searchBox(0)
+    _searchBox(0),
+    _pageBuilder(new DPPageBuilder(timeName,runDirs,bookModel,unitOverrides))
 {
     _setupModel();
 
@@ -91,10 +88,7 @@ DPTreeWidget::~DPTreeWidget()
     delete _dir;
     delete _dpFilterModel;
 
-    foreach ( ProgramModel* program, _programModels ) {
-        delete program;
-    }
-    _programModels.clear();
+    delete _pageBuilder;
 }
 
 //
@@ -286,267 +280,26 @@ void DPTreeWidget::_createDPPages(const QString& dpfile)
     QCursor currCursor = this->cursor();
     this->setCursor(QCursor(Qt::WaitCursor));
 
-    DPProduct dp(dpfile);
-    int rc = _runDirs.count();
-
-    // Program
-    DPProgram* dpprogram = dp.program();
-
-    // Pages
-    QModelIndex pagesIdx = _bookModel->getIndex(QModelIndex(), "Pages");
-    QStandardItem *pagesItem = _bookModel->itemFromIndex(pagesIdx);
-
-    // Page0 plots
-    QModelIndex page0Idx = _bookModel->index(0,0,pagesIdx);
-    QModelIndexList siblingPlotIdxs = _bookModel->plotIdxs(page0Idx);
-
-
-    foreach (DPPage* page, dp.pages() ) {
-
-        // Page
-        QStandardItem *pageItem = _addChild(pagesItem,"Page");
-
-        // PageName
-        QString pageName = dpfile;
-        pageName += QString(":dp.page.%0").arg(_idNum++);
-        _addChild(pageItem, "PageName", pageName);
-
-        _addChild(pageItem, "PageTitle", page->title());
-        _addChild(pageItem, "PageStartTime", page->startTime());
-        _addChild(pageItem, "PageStopTime", page->stopTime());
-        QString bg = _bookModel->getDataString(QModelIndex(),"BackgroundColor");
-        if ( !bg.isEmpty() ) {
-            _addChild(pageItem, "PageBackgroundColor", bg);
-        } else {
-            _addChild(pageItem, "PageBackgroundColor", page->backgroundColor());
-        }
-        QString fg = _bookModel->getDataString(QModelIndex(),"ForegroundColor");
-        if ( !fg.isEmpty() ) {
-            _addChild(pageItem, "PageForegroundColor", fg);
-        } else {
-            _addChild(pageItem, "PageForegroundColor", page->foregroundColor());
-        }
-
-        // Plots
-        QStandardItem *plotsItem = _addChild(pageItem, "Plots");
-
-        foreach (DPPlot* plot, page->plots() ) {
-
-            // Plot
-            QStandardItem *plotItem = _addChild(plotsItem, "Plot");
-            QModelIndex plotIdx = plotItem->index();
-
-            // Some plot children
-            _addChild(plotItem, "PlotName", _descrPlotTitle(plot));
-            _addChild(plotItem, "PlotTitle",      plot->title());
-            _addChild(plotItem, "PlotMathRect", QRectF());
-            _addChild(plotItem, "PlotXScale", plot->plotXScale());
-            _addChild(plotItem, "PlotYScale", plot->plotYScale());
-            _addChild(plotItem, "PlotRatio", "");
-            QModelIndex plotRatioIdx = _bookModel->getDataIndex(plotIdx,
-                                                            "PlotRatio","Plot");
-            _bookModel->setData(plotRatioIdx,plot->plotRatio());// why set 2x?
-            _addChild(plotItem, "PlotXMinRange",  plot->xMinRange());
-            _addChild(plotItem, "PlotXMaxRange",  plot->xMaxRange());
-            _addChild(plotItem, "PlotYMinRange",  plot->yMinRange());
-            _addChild(plotItem, "PlotYMaxRange",  plot->yMaxRange());
-            if ( rc == 2 && plot->curves().size() == 1 ) {
-                QString presentation = _bookModel->getDataString(QModelIndex(),
-                                                               "Presentation");
-                if ( !presentation.isEmpty() ) {
-                    // Commandline argument -pres given
-                    _addChild(plotItem, "PlotPresentation", presentation);
-                } else {
-                    if ( !plot->presentation().isEmpty() ) {
-                        // Presentation specified in DP file
-                        if ( plot->presentation() != "compare" &&
-                             plot->presentation() != "error" &&
-                             plot->presentation() != "error+compare" ) {
-                            fprintf(stderr,
-                                    "koviz [error]: bad presentation=%s "
-                                    "in dpfile=%s \n",
-                                    plot->presentation().toLatin1().constData(),
-                                    dpfile.toLatin1().constData());
-                            exit(-1);
-
-                        }
-                        _addChild(plotItem, "PlotPresentation",
-                                  plot->presentation());
-                    } else {
-                        _addChild(plotItem, "PlotPresentation","compare");
-                    }
-                }
-            } else {
-                _addChild(plotItem, "PlotPresentation", "compare");
-            }
-            _addChild(plotItem, "PlotPointSize", 0.0);
-            _addChild(plotItem, "PlotXAxisLabel", plot->xAxisLabel());
-            _addChild(plotItem, "PlotYAxisLabel", plot->yAxisLabel());
-            _addChild(plotItem, "PlotStartTime",  plot->startTime());
-            _addChild(plotItem, "PlotStopTime",   plot->stopTime());
-            _addChild(plotItem, "PlotGrid",       plot->grid());
-            _addChild(plotItem, "PlotGridColor",       plot->gridColor());
-            _addChild(plotItem, "PlotBackgroundColor", plot->backgroundColor());
-            _addChild(plotItem, "PlotForegroundColor", plot->foregroundColor());
-            _addChild(plotItem, "PlotFont",            plot->font());
-            QVariantList listMajorXTics;
-            foreach ( double tic, plot->majorXTics() ) {
-                listMajorXTics << tic;
-            }
-            _addChild(plotItem, "PlotMajorXTics", listMajorXTics);
-            QVariantList listMajorYTics;
-            foreach ( double tic, plot->majorYTics() ) {
-                listMajorYTics << tic;
-            }
-            _addChild(plotItem, "PlotMajorYTics", listMajorYTics);
-            QVariantList listMinorXTics;
-            foreach ( double tic, plot->minorXTics() ) {
-                listMinorXTics << tic;
-            }
-            _addChild(plotItem, "PlotMinorXTics", listMinorXTics);
-            QVariantList listMinorYTics;
-            foreach ( double tic, plot->minorYTics() ) {
-                listMinorYTics << tic;
-            }
-            _addChild(plotItem, "PlotMinorYTics", listMinorYTics);
-            _addChild(plotItem, "PlotRect", plot->rect());
-
-            // Curves
-            QStandardItem *curvesItem = _addChild(plotItem,"Curves");
-            QList<QColor> colors;
-            int nCurves = plot->curves().size();
-            colors = _bookModel->createCurveColors(rc*nCurves);
-
-            QStringList styles = _bookModel->lineStyles();
-
-            // Turn off model signals when adding children for speedup
-            bool block = _bookModel->blockSignals(true);
-
-            int i = 0;
-            foreach (DPCurve* dpcurve, plot->curves() ) {
-
-                // Setup progress bar dialog for time intensive loads
-                QProgressDialog progress("Loading curves...", "Abort",
-                                         0, rc, this);
-                progress.setWindowModality(Qt::WindowModal);
-                progress.setMinimumDuration(500);
-
-#ifdef __linux
-                TimeItLinux timer;
-                timer.start();
-#endif
-
-                QString default_style = "plain";
-
-                QString ux0;
-                QString uy0;
-                QString r0;
-                for ( int r = 0; r < rc; ++r) {
-
-                    QString color = colors.at(i++).name();
-
-                    CurveModel* curveModel = _addCurve(curvesItem,dpcurve,
-                                                       dpprogram,r,
-                                                       color,default_style);
-
-                    if ( r == 0 ) {
-                        ux0 = curveModel->x()->unit();
-                        uy0 = curveModel->y()->unit();
-                        r0 = QFileInfo(curveModel->fileName()).dir().dirName();
-                    } else {
-                        QString ux1 = curveModel->x()->unit();
-                        QString uy1 = curveModel->y()->unit();
-                        QString r1 = QFileInfo(curveModel->fileName()).
-                                     dir().dirName();
-                        if ( !Unit::canConvert(ux0,ux1) ) {
-                            fprintf(stderr,
-                                 "koviz [error]: Unit mismatch for param=%s "
-                                 "between the following RUNs:\n"
-                                 "        %s {%s}\n"
-                                 "        %s {%s}\n",
-                                 curveModel->x()->name().toLatin1().constData(),
-                                 r0.toLatin1().constData(),
-                                 ux0.toLatin1().constData(),
-                                 r1.toLatin1().constData(),
-                                 ux1.toLatin1().constData());
-                            exit(-1);
-                        }
-                        if ( !Unit::canConvert(uy0,uy1) ) {
-                            fprintf(stderr,
-                                 "koviz [error]: Unit mismatch for param=%s "
-                                 "between the following RUNs:\n"
-                                 "        %s {%s}\n"
-                                 "        %s {%s}\n",
-                                 curveModel->y()->name().toLatin1().constData(),
-                                 r0.toLatin1().constData(),
-                                 uy0.toLatin1().constData(),
-                                 r1.toLatin1().constData(),
-                                 uy1.toLatin1().constData());
-                            exit(-1);
-                        }
-                    }
-
-
-#ifdef __linux
-                    int secs = qRound(timer.stop()/1000000.0);
-                    div_t d = div(secs,60);
-                    QString msg = QString("Loaded %1 of %2 curves "
-                                          "(%3 min %4 sec)")
-                                       .arg(r+1).arg(rc).arg(d.quot).arg(d.rem);
-                    progress.setLabelText(msg);
-#endif
-                    progress.setValue(r);
-                    if (progress.wasCanceled()) {
-                        break;
-                    }
-                }
-
-                // Update progress dialog
-                progress.setValue(rc);
-            }
-
-            // Turn signals back on before adding curveModel
-            _bookModel->blockSignals(block);
-
-            // Initialize plot math rect
-            QModelIndex curvesIdx = curvesItem->index();
-            QRectF bbox = _bookModel->calcCurvesBBox(curvesIdx);
-            QModelIndex plotMathRectIdx = _bookModel->getDataIndex(plotIdx,
-                                                                 "PlotMathRect",
-                                                                 "Plot");
-            if ( _bookModel->isXTime(plotIdx) ) {
-                foreach ( QModelIndex siblingPlotIdx, siblingPlotIdxs ) {
-                    bool isXTime = _bookModel->isXTime(siblingPlotIdx);
-                    if ( isXTime ) {
-                        QRectF sibPlotRect = _bookModel->getPlotMathRect(
-                                                                siblingPlotIdx);
-                        bbox.setLeft(sibPlotRect.left());
-                        bbox.setRight(sibPlotRect.right());
-                        break;
-                    }
-                }
-            }
-            if ( bbox.width() > 0.0 ) {
-                _bookModel->setData(plotMathRectIdx,bbox);
-            }
+    QModelIndexList curvesIdxs = _pageBuilder->createPages(dpfile,
+                                                           &_idNum,this);
 
-            // Reset monte carlo input view current idx to signal curr changed
-            int currRunId = -1;
-            if ( _monteInputsView ) {
-                currRunId = _monteInputsView->currentRun();
-            }
-            if ( currRunId >= 0 ) {
-                foreach (QModelIndex curveIdx,_bookModel->curveIdxs(curvesIdx)){
-                    int curveRunId = _bookModel->getDataInt(curveIdx,
-                                                          "CurveRunID","Curve");
-                    if ( curveRunId == currRunId ) {
-                        // Reset monte input view's current index which will set
-                        // plot view's current index (by way of signal/slots)
-                        QModelIndex currIdx = _monteInputsView->currentIndex();
-                        _monteInputsView->setCurrentIndex(QModelIndex());
-                        _monteInputsView->setCurrentIndex(currIdx);
-                        break;
-                    }
+    // Reset monte carlo input view current idx to signal curr changed
+    int currRunId = -1;
+    if ( _monteInputsView ) {
+        currRunId = _monteInputsView->currentRun();
+    }
+    if ( currRunId >= 0 ) {
+        foreach ( QModelIndex curvesIdx, curvesIdxs ) {
+            foreach (QModelIndex curveIdx,_bookModel->curveIdxs(curvesIdx)){
+                int curveRunId = _bookModel->getDataInt(curveIdx,
+                                                      "CurveRunID","Curve");
+                if ( curveRunId == currRunId ) {
+                    // Reset monte input view's current index which will set
+                    // plot view's current index (by way of signal/slots)
+                    QModelIndex currIdx = _monteInputsView->currentIndex();
+                    _monteInputsView->setCurrentIndex(QModelIndex());
+                    _monteInputsView->setCurrentIndex(currIdx);
+                    break;
                 }
             }
         }
@@ -684,346 +437,6 @@ QStandardItem *DPTreeWidget::_addChild(QStandardItem *parentItem,
     return(_bookModel->addChild(parentItem,childTitle,childValue));
 }
 
-CurveModel* DPTreeWidget::_addCurve(QStandardItem *curvesItem,
-                             DPCurve *dpcurve,
-                             DPProgram *dpprogram,
-                             int runId, const QString& defaultColor,
-                             const QString& defaultLineStyle)
-{
-    // Curve
-    QStandardItem *curveItem = _addChild(curvesItem,"Curve");
-
-    CurveModel* curveModel = 0 ;
-
-    // Get x&y params that match this run
-    DPVar* x = 0;
-    DPVar* y = 0;
-    QString xName;
-    QString xUnit;
-    QString yName;
-    if ( dpcurve->xyPairs().isEmpty() ) {
-        // Find out what x&y to use for curve
-        x = dpcurve->x();
-        y = dpcurve->y();
-        xName = x->name();
-        xUnit = x->unit();
-        yName = y->name();
-
-        if ( xName.isEmpty() ) {
-            xName = _timeName;
-        }
-
-        curveModel = _bookModel->createCurve(runId, _timeName, xName, yName);
-
-        if ( !curveModel ) {
-
-            QString outputCurveName;
-            foreach ( Parameter outputParam, dpprogram->outputParams() ) {
-                if ( outputParam.name() == yName ) {
-                    outputCurveName = yName;
-                    break;
-                }
-            }
-
-            if ( !outputCurveName.isEmpty() ) {
-
-                QList<CurveModel*> inputCurves;
-                foreach ( Parameter inputParam, dpprogram->inputParams() ) {
-                    CurveModel* inputCurve = _bookModel->createCurve(runId,
-                                                             _timeName,
-                                                             _timeName,
-                                                             inputParam.name());
-                    if ( inputCurve ) {
-                        inputCurves << inputCurve;
-                    } else {
-                        fprintf(stderr, "koviz [error]: DP Program input "
-                                "variable not found:\n"
-                                "    DPProgramInputName=%s\n",
-                                inputParam.name().toLatin1().constData());
-                        exit(-1);
-                    }
-                }
-
-                QStringList timeNames;
-                timeNames << _timeName;
-                ProgramModel* programModel = new ProgramModel(inputCurves,
-                                                       dpprogram->inputParams(),
-                                                       dpprogram->outputs(),
-                                                       timeNames,
-                                                       dpprogram->fileName());
-                _programModels << programModel;
-                int ycol = programModel->paramColumn(outputCurveName);
-                curveModel = new CurveModel(programModel,0,0,ycol);
-            }
-        }
-
-        if ( !curveModel ) {
-
-            QString runDir = _runDirs.at(runId);
-            _err_stream << "koviz [error]: could not find parameter: \n\n"
-                        << "        " << "("
-                        << _timeName << " , "
-                        << xName << " , "
-                        << yName << ") "
-                        << "\n\nin RUN:\n\n "
-                        << "         "
-                        << runDir ;
-            fprintf(stderr, "koviz [error]: %s\n",
-                           _err_string.toLatin1().constData());
-            exit(-1);
-        }
-    } else {
-
-        // Search through xypairs
-        QStringList txyParams;  // in case error, use this in message
-        foreach ( DPXYPair* xyPair, dpcurve->xyPairs() ) {
-            xName = xyPair->x()->name();
-            xUnit = xyPair->x()->unit();
-            yName = xyPair->y()->name();
-            if ( !xyPair->y()->timeName().isEmpty() &&
-                  xyPair->y()->timeName() != _timeName ) {
-                fprintf(stderr,"koviz [todo]: DPTreeWidget::_addCurve() "
-                               "xyPair->y()->timeName() != _timeName \n");
-            }
-            if ( !xyPair->x()->timeName().isEmpty() &&
-                  xyPair->x()->timeName() != _timeName ) {
-                fprintf(stderr,"koviz [todo]: DPTreeWidget::_addCurve() "
-                               "xyPair->x()->timeName() != _timeName \n");
-            }
-            if ( xName.isEmpty() ) {
-                xName = _timeName;
-                xUnit = "--";
-            }
-            txyParams << "(" + _timeName  + " , " + xName + " , " + yName + ")";
-            curveModel = _bookModel->createCurve(runId,_timeName,xName,yName);
-            if ( curveModel ) {
-                x = xyPair->x();
-                y = xyPair->y();
-                break;
-            }
-        }
-
-        if ( !curveModel ) {
-            QString runDir = _runDirs.at(runId);
-            _err_stream << "koviz [error]: could not find matching xypair "
-                           "parameter in RUN:\n\n"
-                        << "        " << runDir << "\n\n"
-                           "Tried the following :\n\n";
-            foreach ( QString txy, txyParams ) {
-                _err_stream << "        " << txy << "\n";
-            }
-            _err_stream << "\n        Try using the -map option.\n";
-            throw std::runtime_error(_err_string.toLatin1().constData());
-        }
-    }
-
-    // Curve children
-    _addChild(curveItem, "CurveTimeName", _timeName);
-    _addChild(curveItem, "CurveXName", xName);
-
-    if ( !_unitOverrides.isEmpty() ) {
-        foreach ( QString overrideUnit, _unitOverrides ) {
-            Unit mUnit = Unit::map(curveModel->x()->unit(),
-                                   overrideUnit);
-            if ( !mUnit.isEmpty() ) {
-                // No break if found, so last override in list used
-                xUnit = mUnit.name();
-            }
-        }
-    }
-    _addChild(curveItem, "CurveXUnit", xUnit);
-
-    _addChild(curveItem, "CurveYName", y->name());
-
-    QString yUnit = y->unit();
-    if ( !_unitOverrides.isEmpty() ) {
-        foreach ( QString overrideUnit, _unitOverrides ) {
-            Unit mUnit = Unit::map(curveModel->y()->unit(),
-                                   overrideUnit);
-            if ( !mUnit.isEmpty() ) {
-                // No break if found, so last override in list used
-                yUnit = mUnit.name();
-            }
-        }
-    }
-    _addChild(curveItem, "CurveYUnit", yUnit);
-    _addChild(curveItem, "CurveRunID", runId);
-    _addChild(curveItem, "CurveXMinRange", x->minRange());
-    _addChild(curveItem, "CurveXMaxRange", x->maxRange());
-    _addChild(curveItem, "CurveXScale",
-                          x->scaleFactor()*curveModel->x()->scale());
-    QHash<QString,QVariant> shifts = _bookModel->getDataHash(QModelIndex(),
-                                                             "RunToShiftHash");
-    QString curveRunDir = QFileInfo(curveModel->fileName()).absolutePath();
-    if ( shifts.contains(curveRunDir) ) {
-        double shiftVal = shifts.value(curveRunDir).toDouble();
-        _addChild(curveItem, "CurveXBias", shiftVal);
-    } else {
-        _addChild(curveItem, "CurveXBias", x->bias() + curveModel->x()->bias());
-    }
-    _addChild(curveItem, "CurveYMinRange",   y->minRange());
-    _addChild(curveItem, "CurveYMaxRange",   y->maxRange());
-    _addChild(curveItem, "CurveYScale",
-                         y->scaleFactor()*curveModel->y()->scale());
-    _addChild(curveItem, "CurveYBias", y->bias() + curveModel->y()->bias());
-    _addChild(curveItem, "CurveSymbolSize",  y->symbolSize());
-
-    int row = curveItem->row();
-
-    bool isGroups = false;
-    QStringList groups;
-    QModelIndex groupsIdx = _bookModel->getIndex(QModelIndex(),"Groups","");
-    int nGroups = _bookModel->rowCount(groupsIdx);
-    for ( int i = 0; i < nGroups; ++i ) {
-        QModelIndex groupIdx = _bookModel->index(i,1,groupsIdx);
-        QString group = _bookModel->data(groupIdx).toString();
-        groups << group;
-        if ( !group.isEmpty() ) {
-            isGroups = true;
-        }
-    }
-
-    // Symbol Style
-    QString symbolStyle = y->symbolStyle(); // DP symbol style
-    QModelIndex ssIdx = _bookModel->getIndex(QModelIndex(),
-                                             "Symbolstyles","");
-    if ( row < _bookModel->rowCount(ssIdx) ) {
-        QModelIndex symbolStyleIdx = _bookModel->index(row,1,ssIdx);
-        QString ss = _bookModel->data(symbolStyleIdx).toString();
-        if ( !ss.isEmpty() ) {
-            QString group;
-            if ( row < groups.size() ) {
-                group = groups.at(row);
-            }
-            if ( group.isEmpty() ) {
-                // Use symbolstyle from cmdline, otherwise see group logic below
-                symbolStyle = ss;
-            }
-        }
-    }
-    if ( symbolStyle.isEmpty() ) {
-        symbolStyle = "none";
-    }
-
-    // Linestyle
-    QString lineStyle = y->lineStyle() ; // DP linestyle
-    QModelIndex lsIdx = _bookModel->getIndex(QModelIndex(),"Linestyles","");
-    if ( row < _bookModel->rowCount(lsIdx) ) {
-        // Possible commandline linestyle override
-        QModelIndex lineStyleIdx = _bookModel->index(row,1,lsIdx);
-        QString ls = _bookModel->data(lineStyleIdx).toString();
-        if ( !ls.isEmpty() ) {
-            QString group;
-            if ( row < groups.size() ) {
-                group = groups.at(row);
-            }
-            if ( group.isEmpty() ) {
-                // E.g. if -l4 dog -ls4 thick_line -g4 99,
-                //      then override handled in the group logic below
-                lineStyle = ls;
-            }
-        }
-    }
-    if ( lineStyle.isEmpty() ) {
-        lineStyle = defaultLineStyle;
-    }
-
-    // Label
-    QString yLabel = y->label();
-    QModelIndex llIdx = _bookModel->getIndex(QModelIndex(),"LegendLabels","");
-    if ( row < _bookModel->rowCount(llIdx) ) {
-        QString llTag = QString("Label%1").arg(row+1);
-        QString ll = _bookModel->getDataString(llIdx,llTag,"LegendLabels");
-        if ( !ll.isEmpty() ) {
-            QString group;
-            if ( row < groups.size() ) {
-                group = groups.at(row);
-            }
-            if ( group.isEmpty() ) {
-                // Use commandline label
-                yLabel = ll;
-            }
-        }
-    }
-
-    // Color
-    QString color = y->lineColor() ;
-    QModelIndex lcsIdx = _bookModel->getIndex(QModelIndex(),"LegendColors","");
-    if ( row < _bookModel->rowCount(lcsIdx) ) {
-        // Possible commandline color override
-        QModelIndex legendColorIdx = _bookModel->index(row,1,lcsIdx);
-        QString legendColor = _bookModel->data(legendColorIdx).toString();
-        if ( !legendColor.isEmpty() ) {
-            QString group;
-            if ( row < groups.size() ) {
-                group = groups.at(row);
-            }
-            if ( group.isEmpty() ) {
-                color = legendColor;
-            }
-        }
-    }
-    if ( color.isEmpty()) {
-        color = defaultColor;
-    }
-
-    // Handle groups (-g1, -g2... -g7 options)
-    if ( isGroups ) {
-        int i = 0;
-        foreach ( QString group, groups ) {
-            if ( !group.isEmpty() ) {
-                if ( _bookModel->isMatch(curveRunDir,group) ) {
-                    // Color
-                    QModelIndex idx = _bookModel->index(i,1,lcsIdx);
-                    QString cc = _bookModel->data(idx).toString();
-                    if ( !cc.isEmpty() ) {
-                        color = cc ;
-                    }
-
-                    // Label
-                    QString llTag = QString("Label%1").arg(i+1);
-                    QString ll = _bookModel->getDataString(llIdx,llTag,
-                                                           "LegendLabels");
-                    if ( !ll.isEmpty() ) {
-                        yLabel = ll ;
-                    } else {
-                        yLabel = group;
-                    }
-
-                    // Linestyle
-                    idx = _bookModel->index(i,1,lsIdx);
-                    QString ls = _bookModel->data(idx).toString();
-                    if ( !ls.isEmpty() ) {
-                        lineStyle = ls;
-                    }
-
-                    // Symbolstyle
-                    idx = _bookModel->index(i,1,ssIdx);
-                    QString ss = _bookModel->data(idx).toString();
-                    if ( !ss.isEmpty() ) {
-                        symbolStyle = ss;
-                    }
-
-                    // Match found and handled
-                    break;
-                }
-            }
-            ++i;
-        }
-    }
-
-    _addChild(curveItem, "CurveYLabel", yLabel);
-    _addChild(curveItem, "CurveColor", color);
-    _addChild(curveItem, "CurveLineStyle",   lineStyle);
-    _addChild(curveItem, "CurveSymbolStyle", symbolStyle);
-
-    // Finally, add actual curve model data with signals turned on
-    QVariant v = PtrToQVariant<CurveModel>::convert(curveModel);
-    _addChild(curveItem, "CurveData", v);
-
-    return curveModel;
-}
-
 bool DPTreeWidget::_isDP(const QString &fp)
 {
     bool ret = false ;
@@ -1037,44 +450,6 @@ bool DPTreeWidget::_isDP(const QString &fp)
     return ret;
 }
 
-QString DPTreeWidget::_descrPlotTitle(DPPlot *plot)
-{
-    QString plotTitle = "Plot_";
-    if ( plot->title() != "Plot" )  {
-        plotTitle += plot->title();
-    } else {
-        QStringList vars;
-        foreach ( DPCurve* curve, plot->curves() ) {
-            vars.append(curve->y()->name());
-        }
-        QString var0 = vars.at(0);
-        int dotCnt = 0 ;
-        QString sub;
-        for ( int i = 1 ; i < var0.size(); ++i) {
-            sub = var0.right(i);
-            if ( sub.at(0) == '.' ) {
-                dotCnt++;
-            }
-            bool is = true;
-            foreach ( QString var, vars ) {
-                if ( ! var.endsWith(sub) ) {
-                    is = false;
-                    break;
-                }
-            }
-            if ( ! is || dotCnt == 2 ) {
-                break;
-            }
-        }
-        if ( dotCnt == 2 ) {
-            sub.remove(0,1);
-        }
-        plotTitle += sub;
-    }
-
-    return plotTitle;
-}
-
 void DPTreeWidget::clearSelection()
 {
     _dpTreeView->selectionModel()->clear();
@@ -15,6 +15,7 @@
 #include "utils.h"
 #include "monteinputsview.h"
 #include "programmodel.h"
+#include "dppagebuilder.h"
 
 // This class introduced to fix Qt bug:
 // https://codereview.qt-project.org/#/c/65171/3
@@ -73,7 +74,7 @@ private:
     DPFilterProxyModel* _dpFilterModel;
     QFileSystemModel* _dpModel ;
     QModelIndex _dpModelRootIdx;
-    QList<ProgramModel*> _programModels;
+    DPPageBuilder* _pageBuilder;
 
     void _setupModel();
     void _createDP(const QString& dpfile);
@@ -82,13 +83,7 @@ private:
     QStandardItem* _addChild(QStandardItem* parentItem,
                    const QString& childTitle,
                    const QVariant &childValue=QVariant());
-    CurveModel* _addCurve(QStandardItem* curvesItem, DPCurve* dpcurve,
-                          DPProgram *dpprogram,
-                          int runId,
-                          const QString &defaultColor,
-                          const QString &defaultLineStyle);
     bool _isDP(const QString& fp);
-    QString _descrPlotTitle(DPPlot* plot);
 
     static QString _err_string;
     static QTextStream _err_stream;
@@ -27,7 +27,9 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "fft.h"
+#include "fftplan.h"
 #define FFT_SIZE_MAX    100000000000
 
 //extern double pi;
@@ -41,7 +43,10 @@ static void *memdup(const void *src, size_t n);
 bool Fft_transform(double real[], double imag[], size_t n) {
 	if (n == 0)
 		return true;
-	else if ((n & (n - 1)) == 0)  // Is power of 2
+	else if (n <= (size_t)INT_MAX) {  // Tables cached by size, see fftplan.h
+		FFTPlan::plan((int)n)->transform(real, imag);
+		return true;
+	} else if ((n & (n - 1)) == 0)  // Is power of 2
 		return Fft_transformRadix2(real, imag, n);
 	else  // More complicated algorithm for arbitrary sizes
 		return Fft_transformBluestein(real, imag, n);
@@ -0,0 +1,279 @@
+#include "fftplan.h"
+#include <math.h>
+
+QMutex FFTPlan::_plansMutex;
+QHash<int,QWeakPointer<FFTPlan> > FFTPlan::_livePlans;
+QList<QSharedPointer<FFTPlan> > FFTPlan::_plans;
+
+FFTPlan::FFTPlan(int n) :
+    _n(n),
+    _isPowerOf2((n & (n-1)) == 0)
+{
+    _cos.resize(n/2);
+    _sin.resize(n/2);
+    for ( int i = 0; i < n/2; ++i ) {
+        _cos[i] = cos(2*M_PI*i/n);
+        _sin[i] = sin(2*M_PI*i/n);
+    }
+}
+
+QSharedPointer<FFTPlan> FFTPlan::plan(int n)
+{
+    QMutexLocker locker(&_plansMutex);
+
+    QSharedPointer<FFTPlan> p = _livePlans.value(n).toStrongRef();
+    if ( !p ) {
+        p = QSharedPointer<FFTPlan>(new FFTPlan(n));
+        _livePlans.insert(n,p.toWeakRef());
+    }
+
+    // Keep recently used plans within budget, plans that are over budget
+    // live as long as their users hold them
+    _plans.removeOne(p);
+    _plans.prepend(p);
+    qint64 bytes = 0;
+    for ( int i = 0; i < _plans.size(); ++i ) {
+        bytes += _plans.at(i)->_bytes();
+        if ( bytes > _maxPlansBytes || i >= _maxPlans ) {
+            while ( _plans.size() > i ) {
+                _plans.removeLast();
+            }
+            break;
+        }
+    }
+
+    QHash<int,QWeakPointer<FFTPlan> >::iterator it = _livePlans.begin();
+    while ( it != _livePlans.end() ) {
+        if ( it.value().isNull() ) {
+            it = _livePlans.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return p;
+}
+
+void FFTPlan::transform(double *real, double *imag) const
+{
+    if ( _n <= 1 ) {
+        return;
+    } else if ( _isPowerOf2 ) {
+        _transformRadix2(real,imag);
+    } else {
+        _transformBluestein(real,imag);
+    }
+}
+
+// X[k] = E[k] + W^k*O[k] where E and O are the DFTs of the even and odd
+// samples, taken from the packed DFT Z as E[k] = (Z[k]+conj(Z[h-k]))/2 and
+// O[k] = (Z[k]-conj(Z[h-k]))/2i
+static inline void unpackReal(double ar, double ai, double br, double bi,
+                              double c, double s, double* xr, double* xi)
+{
+    double er = 0.5*(ar+br);
+    double ei = 0.5*(ai-bi);
+    double or_ = 0.5*(ai+bi);
+    double oi = -0.5*(ar-br);
+    *xr = er + c*or_ + s*oi;
+    *xi = ei + c*oi - s*or_;
+}
+
+void FFTPlan::transformReal(const double *in, double *real,
+                            double *imag) const
+{
+    int n = _n;
+    if ( n < 2 || n % 2 != 0 ) {
+        for ( int i = 0; i < n; ++i ) {
+            real[i] = in[i];
+            imag[i] = 0.0;
+        }
+        transform(real,imag);
+        return;
+    }
+
+    // Even samples as real parts, odd samples as imaginary parts.
+    // Reads are ahead of writes so in may be real.
+    int h = n/2;
+    for ( int k = 0; k < h; ++k ) {
+        double re = in[2*k];
+        double im = in[2*k+1];
+        real[k] = re;
+        imag[k] = im;
+    }
+
+    _halfPlan()->transform(real,imag);
+
+    double z0r = real[0];
+    double z0i = imag[0];
+    real[0] = z0r+z0i;
+    imag[0] = 0.0;
+    real[h] = z0r-z0i;
+    imag[h] = 0.0;
+    const double* c = _cos.constData();
+    const double* s = _sin.constData();
+    for ( int k = 1; k <= h/2; ++k ) {
+        int j = h-k;
+        double ar = real[k];
+        double ai = imag[k];
+        double br = real[j];
+        double bi = imag[j];
+        unpackReal(ar,ai,br,bi,c[k],s[k],&real[k],&imag[k]);
+        unpackReal(br,bi,ar,ai,c[j],s[j],&real[j],&imag[j]);
+    }
+
+    // Spectrum of real samples is conjugate symmetric
+    for ( int k = 1; k < h; ++k ) {
+        real[n-k] = real[k];
+        imag[n-k] = -imag[k];
+    }
+}
+
+QSharedPointer<FFTPlan> FFTPlan::_halfPlan() const
+{
+    QMutexLocker locker(&_buildMutex);
+    if ( !_half ) {
+        _half = plan(_n/2);
+    }
+    return _half;
+}
+
+QSharedPointer<FFTPlan::Bluestein> FFTPlan::_bluesteinTables() const
+{
+    QMutexLocker locker(&_buildMutex);
+    {
+        QMutexLocker lazyLocker(&_lazyMutex);
+        if ( _bluestein ) {
+            return _bluestein;
+        }
+    }
+
+    int n = _n;
+    QSharedPointer<Bluestein> b(new Bluestein);
+
+    // Power of 2 convolution size such that m >= n*2+1
+    b->m = 1;
+    while ( b->m/2 <= n ) {
+        b->m *= 2;
+    }
+
+    b->chirpCos.resize(n);
+    b->chirpSin.resize(n);
+    for ( int i = 0; i < n; ++i ) {
+        unsigned long long t = (unsigned long long)i*i;
+        t %= (unsigned long long)n*2;
+        double angle = M_PI*t/n;
+        b->chirpCos[i] = cos(angle);
+        b->chirpSin[i] = sin(angle);
+    }
+
+    int m = b->m;
+    b->chirpReal.fill(0.0,m);
+    b->chirpImag.fill(0.0,m);
+    b->chirpReal[0] = b->chirpCos.at(0);
+    b->chirpImag[0] = b->chirpSin.at(0);
+    for ( int i = 1; i < n; ++i ) {
+        b->chirpReal[i] = b->chirpReal[m-i] = b->chirpCos.at(i);
+        b->chirpImag[i] = b->chirpImag[m-i] = b->chirpSin.at(i);
+    }
+    b->mPlan = plan(m);
+    b->mPlan->transform(b->chirpReal.data(),b->chirpImag.data());
+
+    QMutexLocker lazyLocker(&_lazyMutex);
+    _bluestein = b;
+    return _bluestein;
+}
+
+// Cooley-Tukey decimation-in-time radix-2 (see Fft_transformRadix2())
+void FFTPlan::_transformRadix2(double *real, double *imag) const
+{
+    int n = _n;
+
+    // Bit-reversed addressing permutation
+    for ( int i = 1, j = 0; i < n; ++i ) {
+        int bit = n >> 1;
+        for ( ; j & bit; bit >>= 1 ) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if ( i < j ) {
+            double t = real[i];
+            real[i] = real[j];
+            real[j] = t;
+            t = imag[i];
+            imag[i] = imag[j];
+            imag[j] = t;
+        }
+    }
+
+    const double* c = _cos.constData();
+    const double* s = _sin.constData();
+    for ( int size = 2; size <= n; size *= 2 ) {
+        int halfsize = size/2;
+        int tablestep = n/size;
+        for ( int i = 0; i < n; i += size ) {
+            for ( int j = i, k = 0; j < i+halfsize; ++j, k += tablestep ) {
+                int l = j+halfsize;
+                double tpre = real[l]*c[k] + imag[l]*s[k];
+                double tpim = -real[l]*s[k] + imag[l]*c[k];
+                real[l] = real[j]-tpre;
+                imag[l] = imag[j]-tpim;
+                real[j] += tpre;
+                imag[j] += tpim;
+            }
+        }
+        if ( size == n ) {
+            break;  // Prevent overflow in 'size *= 2'
+        }
+    }
+}
+
+// Bluestein's chirp z-transform (see Fft_transformBluestein()), the
+// chirp's DFT is in the plan so each call is two transforms of size m
+void FFTPlan::_transformBluestein(double *real, double *imag) const
+{
+    QSharedPointer<Bluestein> b = _bluesteinTables();
+    int n = _n;
+    int m = b->m;
+    const double* cc = b->chirpCos.constData();
+    const double* cs = b->chirpSin.constData();
+
+    QVector<double> ar(m,0.0);
+    QVector<double> ai(m,0.0);
+    for ( int i = 0; i < n; ++i ) {
+        ar[i] = real[i]*cc[i] + imag[i]*cs[i];
+        ai[i] = -real[i]*cs[i] + imag[i]*cc[i];
+    }
+
+    // Convolution with the chirp
+    b->mPlan->transform(ar.data(),ai.data());
+    const double* br = b->chirpReal.constData();
+    const double* bi = b->chirpImag.constData();
+    for ( int i = 0; i < m; ++i ) {
+        double t = ar[i]*br[i] - ai[i]*bi[i];
+        ai[i] = ai[i]*br[i] + ar[i]*bi[i];
+        ar[i] = t;
+    }
+    b->mPlan->transform(ai.data(),ar.data());  // inverse
+
+    for ( int i = 0; i < n; ++i ) {
+        double cr = ar.at(i)/m;
+        double ci = ai.at(i)/m;
+        real[i] = cr*cc[i] + ci*cs[i];
+        imag[i] = -cr*cs[i] + ci*cc[i];
+    }
+}
+
+// Tables held by this plan, the plans it uses are counted on their own
+qint64 FFTPlan::_bytes() const
+{
+    qint64 bytes = (qint64)(_cos.size()+_sin.size())*sizeof(double);
+    QMutexLocker locker(&_lazyMutex);
+    if ( _bluestein ) {
+        bytes += (qint64)(_bluestein->chirpCos.size() +
+                          _bluestein->chirpSin.size() +
+                          _bluestein->chirpReal.size() +
+                          _bluestein->chirpImag.size())*sizeof(double);
+    }
+    return bytes;
+}
@@ -0,0 +1,80 @@
+#ifndef FFT_PLAN_H
+#define FFT_PLAN_H
+
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QSharedPointer>
+#include <QWeakPointer>
+#include <QMutex>
+#include <QMutexLocker>
+
+//
+// Tables for discrete Fourier transforms of one size.
+//
+// Fft_transform() used to compute its cos/sin tables (and for sizes that
+// are not a power of 2, Bluestein's chirp and its transform) on every
+// call.  A plan computes them once.  plan() hands out the live plan of a
+// size if there is one and keeps recently used plans within a memory
+// budget, so the curves of a plot, which mostly share a length, share a
+// plan.  Plans are not changed once built and may be used by several
+// threads at once.
+//
+class FFTPlan
+{
+public:
+
+    static QSharedPointer<FFTPlan> plan(int n);
+
+    int size() const { return _n; }
+
+    // Forward DFT of n complex values in place, same result as
+    // Fft_transform().  The inverse is transform(imag,real) (unscaled).
+    void transform(double* real, double* imag) const;
+
+    // Forward DFT of n real values, the n complex values are written to
+    // real and imag.  in may be real.  Even sizes are packed into n/2
+    // complex values, which halves the transform.
+    void transformReal(const double* in, double* real, double* imag) const;
+
+private:
+
+    explicit FFTPlan(int n);
+
+    struct Bluestein
+    {
+        int m;                          // convolution size, power of 2
+        QSharedPointer<FFTPlan> mPlan;
+        QVector<double> chirpCos;       // cos(pi*i*i/n), i < n
+        QVector<double> chirpSin;
+        QVector<double> chirpReal;      // DFT of the chirp, m values
+        QVector<double> chirpImag;
+    };
+
+    int _n;
+    bool _isPowerOf2;
+    QVector<double> _cos;               // cos(2*pi*i/n), i < n/2
+    QVector<double> _sin;
+
+    // Built on first use, under _buildMutex (which may call plan()).
+    // _lazyMutex only guards the pointers, see _bytes().
+    mutable QMutex _buildMutex;
+    mutable QMutex _lazyMutex;
+    mutable QSharedPointer<FFTPlan> _half;          // for transformReal()
+    mutable QSharedPointer<Bluestein> _bluestein;
+    QSharedPointer<FFTPlan> _halfPlan() const;
+    QSharedPointer<Bluestein> _bluesteinTables() const;
+
+    void _transformRadix2(double* real, double* imag) const;
+    void _transformBluestein(double* real, double* imag) const;
+    qint64 _bytes() const;
+
+    static QMutex _plansMutex;
+    static QHash<int,QWeakPointer<FFTPlan> > _livePlans;
+    static QList<QSharedPointer<FFTPlan> > _plans;  // most recent first
+
+    static const int _maxPlans = 8;
+    static const qint64 _maxPlansBytes = 256*1024*1024;
+};
+
+#endif // FFT_PLAN_H
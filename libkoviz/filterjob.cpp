@@ -0,0 +1,53 @@
+#include "filterjob.h"
+
+void FilterJob::run()
+{
+    QMutexLocker locker(&_runMutex);
+
+    foreach ( QSharedPointer<FilterSource> source, _sources ) {
+        if ( isCanceled() ) {
+            break;
+        }
+        QVector<double> ys(source->ys);
+        if ( !filter(_filter,ys.data(),ys.size(),source->dt,
+                     _frequency,_window,_degree,&_isCancel) ) {
+            ys.clear();   // curve is left as is
+        }
+        _results.append(ys);
+    }
+    _isDone = !isCanceled();
+
+    emit finished(_generation);
+}
+
+bool FilterJob::filter(Filter filter, double *ys, int n, double dt,
+                       double frequency, int window, int degree,
+                       const QAtomicInt *isCancel)
+{
+    if ( n <= 0 || dt <= 0.0 ) {
+        return false;
+    }
+
+    if ( filter == Butterworth ) {
+        BWLowPass* bw = create_bw_low_pass_filter(4, 1/dt, frequency);
+        for ( int beg = 0; beg < n; beg += _cancelBlock ) {
+            if ( isCancel && isCancel->load() ) {
+                free_bw_low_pass(bw);
+                return false;
+            }
+            int end = qMin(n,beg+_cancelBlock);
+            for ( int i = beg; i < end; ++i ) {
+                ys[i] = bw_low_pass(bw,ys[i]);
+            }
+        }
+        free_bw_low_pass(bw);
+    } else {
+        // See sg_smooth() for the minimum number of samples
+        if ( window < 1 || n < 2*window+2 ) {
+            return false;
+        }
+        calc_sgsmooth(n,ys,window,degree);
+    }
+
+    return !( isCancel && isCancel->load() );
+}
@@ -0,0 +1,102 @@
+#ifndef FILTER_JOB_H
+#define FILTER_JOB_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QList>
+#include <QVector>
+#include <QSharedPointer>
+#include <QPersistentModelIndex>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "filter.h"
+#include "filter_sgolay.h"
+
+// Original samples of a curve being filtered.  Filters expect uniform
+// sampling, so only the begin time and dt are kept.
+struct FilterSource
+{
+    QPersistentModelIndex curveIdx;
+    QVector<double> ys;         // NaNs replaced by the last good value
+    double beginTime;
+    double dt;
+
+    FilterSource() : beginTime(0.0), dt(0.0) {}
+};
+
+//
+// Full resolution filter of a plot's curves for one slider value, run on
+// a pool thread.  CurvesView previews a value on the visible part of the
+// curves right away and starts a job for the rest.  Jobs of values that
+// have since been superseded are canceled (a Butterworth job stops
+// within a block of samples, an S-Golay job between curves) and their
+// results dropped by generation.
+//
+class FilterJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    enum Filter { Butterworth, SGolay };
+
+    FilterJob(Filter filter,
+              const QList<QSharedPointer<FilterSource> >& sources,
+              double frequency, int window, int degree, int generation) :
+        _filter(filter),
+        _sources(sources),
+        _frequency(frequency),
+        _window(window),
+        _degree(degree),
+        _generation(generation),
+        _isCancel(0),
+        _isDone(false)
+    {
+        setAutoDelete(false); // CurvesView owns jobs
+    }
+
+    void run();
+
+    // Filter n samples spaced dt apart in place.  Returns false if
+    // canceled or if there are too few samples for the filter.
+    static bool filter(Filter filter, double* ys, int n, double dt,
+                       double frequency, int window, int degree,
+                       const QAtomicInt* isCancel=0);
+
+    // Cancel is safe from any thread, wait() blocks until run() is out
+    void cancel() { _isCancel.store(1); }
+    bool isCanceled() const { return _isCancel.load() != 0; }
+    void wait() { QMutexLocker locker(&_runMutex); }
+
+    Filter filterType() const { return _filter; }
+    int generation() const { return _generation; }
+    double frequency() const { return _frequency; }
+    int window() const { return _window; }
+    int degree() const { return _degree; }
+    bool isDone() const { return _isDone; }
+    const QList<QSharedPointer<FilterSource> >& sources() const
+    {
+        return _sources;
+    }
+    const QList<QVector<double> >& results() const { return _results; }
+
+signals:
+    void finished(int generation);
+
+private:
+    Filter _filter;
+    QList<QSharedPointer<FilterSource> > _sources;
+    double _frequency;
+    int _window;
+    int _degree;
+    int _generation;
+    QAtomicInt _isCancel;
+    QMutex _runMutex;
+    bool _isDone;
+    QList<QVector<double> > _results;   // filtered ys, one per source
+
+    static const int _cancelBlock = 65536;
+};
+
+#endif // FILTER_JOB_H
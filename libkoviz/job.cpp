@@ -1,6 +1,7 @@
 #include "job.h"
 
 #include <QRegExp>
+#include <QVector>
 #include <stdio.h>
 #include <cmath>
 #include <QtCore/qmath.h>
@@ -63,12 +64,16 @@ inline void Job::_do_stats()
     long sum_squares = 0 ;
     long sum_rt = 0 ;
     long max_rt = 0 ;
-    ModelIterator* it = _curve->begin();
+    double max_timestamp = 0.0;
+    int nrows = _curve->rowCount();
+    QVector<double> times(nrows);
+    QVector<double> rts(nrows);
+    _curve->values(0,nrows,times.data(),0,rts.data());
     int cnt = 0;
-    while ( !it->isDone() ) {
+    for ( int i = 0; i < nrows; ++i ) {
 
-        double time = it->t();
-        long rt = (long)it->y();
+        double time = times.at(i);
+        long rt = (long)rts.at(i);
 
         if ( rt < 0 ) {
             rt =  0.0;
@@ -76,34 +81,49 @@ inline void Job::_do_stats()
 
         if ( cnt > 0 && rt > 0 ) {
             freq = round_10((long)(time*1000000.0) - last_nonzero_timestamp);
-            long freq_cnt ;
-            if ( map_freq.contains(freq) ) {
-                freq_cnt = map_freq.value(freq)+1;
-            } else {
-                freq_cnt = 0;
-            }
-            map_freq.insert(freq,freq_cnt);
+            _addFreqs(map_freq,freq,1);
             last_nonzero_timestamp = (long)(time*1000000.0);
         }
 
         if ( rt > max_rt ) {
             max_rt = rt;
-            _max_timestamp = time;
+            max_timestamp = time;
         }
 
         sum_squares += rt*rt;
         sum_rt += rt;
 
         ++cnt;
-        it->next();
     }
-    delete it;
+
+    _setStats(sum_rt,sum_squares,cnt,max_rt,max_timestamp,map_freq);
+}
+
+// Tally cnt more occurrences of freq.  Counts are one less than the
+// number of occurrences, so a period seen only once never wins the mode.
+void Job::_addFreqs(QMap<long,int> &map_freq, long freq, int cnt)
+{
+    if ( map_freq.contains(freq) ) {
+        map_freq.insert(freq,map_freq.value(freq)+cnt);
+    } else {
+        map_freq.insert(freq,cnt-1);
+    }
+}
+
+// Stats from one pass over the job's runtimes, by _do_stats() or by
+// JobStats for all jobs of a log file at once
+void Job::_setStats(long sum_rt, long sum_squares, int cnt,
+                    long max_rt, double max_timestamp,
+                    const QMap<long,int>& map_freq)
+{
+    _is_stats = true;
 
     double ss = (double)sum_squares;
     double s = (double)sum_rt;
     double n = (double)cnt;
 
     _max_runtime = (max_rt)/1000000.0;
+    _max_timestamp = max_timestamp;
     _avg_runtime = (s/n)/1000000.0;
     _stddev_runtime = qSqrt(ss/n - s*s/(n*n))/1000000.0 ;
 
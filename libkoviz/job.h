@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QTextStream>
+#include <QMap>
 #include <stdlib.h>
 #include <stdexcept>
 
@@ -15,6 +16,8 @@ bool jobMaxTimeGreaterThan(Job* a,Job* b);
 
 class Job
 {
+  friend class JobStats;
+
   public:
     // job_id is logged job name
     // e.g. JOB_bus.SimBus##read_ObcsRouter_C1.1828.00(read_simbus_0.100)
@@ -57,6 +60,10 @@ private:
 
     bool _is_stats;
     void _do_stats();
+    void _setStats(long sum_rt, long sum_squares, int cnt,
+                   long max_rt, double max_timestamp,
+                   const QMap<long,int>& map_freq);
+    static void _addFreqs(QMap<long,int>& map_freq, long freq, int cnt);
     double _avg_runtime;
     double _stddev_runtime;
     double _max_runtime;
@@ -0,0 +1,121 @@
+#include "jobstats.h"
+#include "utils.h"
+
+JobStats::JobStats(DataModel *model, int timeCol) :
+    _model(model),
+    _timeCol(timeCol)
+{
+    setAutoDelete(false); // caller collects threadRuntimes() after run()
+}
+
+void JobStats::addJob(Job *job, int col)
+{
+    _jobs.append(job);
+    _cols.append(col);
+}
+
+void JobStats::run()
+{
+    int nJobs = _jobs.size();
+    int nRows = _model->rowCount();
+    if ( nJobs == 0 ) {
+        return;
+    }
+
+    _model->pin(); // other models may be read on other threads
+
+    // Per job accumulators, same arithmetic as Job::_do_stats()
+    QVector<long> sums(nJobs,0);
+    QVector<long> sumSquares(nJobs,0);
+    QVector<long> maxs(nJobs,0);
+    QVector<double> maxTimes(nJobs,0.0);
+    QVector<long> lastNonzeroTimestamps(nJobs,0);
+    QList<QMap<long,int> > freqs;
+    QVector<long> runFreqs(nJobs,0);  // current run of equal freqs
+    QVector<int> runCnts(nJobs,0);    // is counted without a map lookup
+
+    QVector<double*> runtimes(nJobs);
+    for ( int j = 0; j < nJobs; ++j ) {
+        freqs.append(QMap<long,int>());
+        int tid = _jobs.at(j)->thread_id();
+        if ( !_tid2runtimes.contains(tid) ) {
+            _tid2runtimes.insert(tid,QVector<double>(nRows,0.0));
+        }
+    }
+    for ( int j = 0; j < nJobs; ++j ) {
+        int tid = _jobs.at(j)->thread_id();
+        runtimes[j] = _tid2runtimes[tid].data();
+    }
+
+    // Blocks of rows that fit in cache, so reading a column from the
+    // (row major) file hits memory that the previous column brought in
+    int nCols = qMax(1,_model->columnCount());
+    int blockRows = qBound(16,_blockBytes/(int)(nCols*sizeof(double)),4096);
+    QVector<double> t(blockRows);
+    QVector<double> v(blockRows);
+    QVector<long> rts(blockRows);
+
+    for ( int beg = 0; beg < nRows; beg += blockRows ) {
+        int end = qMin(nRows,beg+blockRows);
+        int n = end-beg;
+        _model->columnValues(_timeCol,beg,end,t.data());
+
+        for ( int j = 0; j < nJobs; ++j ) {
+
+            _model->columnValues(_cols.at(j),beg,end,v.data());
+
+            // Sums (no branches, so the compiler can vectorize)
+            const double* x = v.constData();
+            double* rowRuntimes = runtimes[j]+beg;
+            long* rt = rts.data();
+            long sum = 0;
+            long sumSquare = 0;
+            for ( int i = 0; i < n; ++i ) {
+                rowRuntimes[i] += ( x[i] < 0.0 ) ? 0.0 : x[i];
+                long r = (long)x[i];
+                r = ( r < 0 ) ? 0 : r;
+                rt[i] = r;
+                sum += r;
+                sumSquare += r*r;
+            }
+            sums[j] += sum;
+            sumSquares[j] += sumSquare;
+
+            // Max and frequency histogram
+            long maxRt = maxs.at(j);
+            for ( int i = 0; i < n; ++i ) {
+                long r = rt[i];
+                if ( r > 0 && beg+i > 0 ) {
+                    long timestamp = (long)(t.at(i)*1000000.0);
+                    long freq = round_10(timestamp-lastNonzeroTimestamps.at(j));
+                    if ( runCnts.at(j) > 0 && freq == runFreqs.at(j) ) {
+                        ++runCnts[j];
+                    } else {
+                        if ( runCnts.at(j) > 0 ) {
+                            Job::_addFreqs(freqs[j],runFreqs.at(j),
+                                           runCnts.at(j));
+                        }
+                        runFreqs[j] = freq;
+                        runCnts[j] = 1;
+                    }
+                    lastNonzeroTimestamps[j] = timestamp;
+                }
+                if ( r > maxRt ) {
+                    maxRt = r;
+                    maxTimes[j] = t.at(i);
+                }
+            }
+            maxs[j] = maxRt;
+        }
+    }
+
+    _model->unpin();
+
+    for ( int j = 0; j < nJobs; ++j ) {
+        if ( runCnts.at(j) > 0 ) {
+            Job::_addFreqs(freqs[j],runFreqs.at(j),runCnts.at(j));
+        }
+        _jobs.at(j)->_setStats(sums.at(j),sumSquares.at(j),nRows,
+                               maxs.at(j),maxTimes.at(j),freqs.at(j));
+    }
+}
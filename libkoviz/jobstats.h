@@ -0,0 +1,51 @@
+#ifndef JOBSTATS_H
+#define JOBSTATS_H
+
+#include <QRunnable>
+#include <QList>
+#include <QMap>
+#include <QVector>
+
+#include "datamodel.h"
+#include "job.h"
+
+//
+// Runtime statistics for all jobs logged in one DataModel in one pass.
+//
+// Job::_do_stats() reads a job's column on its own, so a log with
+// thousands of job columns was swept once per job.  JobStats instead
+// walks the file in blocks of rows small enough to stay in cache and,
+// per block, folds every job column into its sums, sum of squares, max
+// and frequency histogram.  The per row sum of job runtimes on each
+// thread (used for thread frame times, see Thread::_do_stats()) is
+// accumulated in the same pass.
+//
+// run() may be called on a pool thread, one JobStats per model.  Jobs
+// must belong to this model only, and are given their stats when run()
+// returns.
+//
+class JobStats : public QRunnable
+{
+  public:
+    JobStats(DataModel* model, int timeCol=0);
+
+    void addJob(Job* job, int col);
+    void run();
+
+    // Thread id -> per row sum of job runtimes (microseconds)
+    const QMap<int,QVector<double> >& threadRuntimes() const
+    {
+        return _tid2runtimes;
+    }
+
+  private:
+    DataModel* _model;
+    int _timeCol;
+    QList<Job*> _jobs;
+    QList<int> _cols;
+    QMap<int,QVector<double> > _tid2runtimes;
+
+    static const int _blockBytes = 256*1024;
+};
+
+#endif // JOBSTATS_H
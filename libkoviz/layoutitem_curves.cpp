@@ -65,8 +65,7 @@ void CurvesLayoutItem::paint(QPainter *painter,
 
     // Print!
     if ( nCurves == 2 ) {
-        QString plotPresentation = _bookModel->getDataString(_plotIdx,
-                                                     "PlotPresentation","Plot");
+        QString plotPresentation = _bookModel->plotProps(_plotIdx).presentation;
         if ( plotPresentation == "compare" ) {
             _printCoplot(T,painter,_plotIdx);
         } else if (plotPresentation == "error" || plotPresentation.isEmpty()) {
@@ -85,20 +84,20 @@ void CurvesLayoutItem::paint(QPainter *painter,
         int nElements = 0;
         for ( int i = 0; i < nCurves; ++i ) {
             QModelIndex curveIdx = _bookModel->index(i,0,curvesIdx);
-            QPainterPath* path = _bookModel->getPainterPath(curveIdx);
-            nElements += path->elementCount();
+            CurvePoints* points = _bookModel->getCurvePoints(curveIdx);
+            nElements += points->count();
         }
 
         if ( nElements > 100000 || nCurves > 64 ) {
 
-            // Use pixmaps to reduce file size
+            // Use pixmaps to reduce file size.  A QImage is used since
+            // pages may be printed on worker threads (see BookPrinter)
             double rw = R.width()/(double)painter->device()->logicalDpiX();
             double rh = R.height()/(double)painter->device()->logicalDpiY();
-            QPixmap nullPixmap(1,1); // used for dpi
-            QPainter nullPainter(&nullPixmap);
-            int w = qRound(1.8*rw*nullPainter.device()->logicalDpiX());
-            int h = qRound(1.8*rh*nullPainter.device()->logicalDpiY());
-            QPixmap pixmap(w,h);
+            QImage nullPixmap(1,1,QImage::Format_ARGB32_Premultiplied);
+            int w = qRound(1.8*rw*nullPixmap.logicalDpiX());
+            int h = qRound(1.8*rh*nullPixmap.logicalDpiY());
+            QImage pixmap(w,h,QImage::Format_ARGB32_Premultiplied);
 
             QModelIndex pageIdx = _plotIdx.parent().parent();
             pixmap.fill(_bookModel->pageBackgroundColor(pageIdx));
@@ -118,28 +117,27 @@ void CurvesLayoutItem::paint(QPainter *painter,
 
             for ( int i = 0; i < nCurves; ++i ) {
                 QModelIndex curveIdx = _bookModel->index(i,0,curvesIdx);
-                QPainterPath* path =_bookModel->getPainterPath(curveIdx);
-                if ( path ) {
+                CurvePoints* points =_bookModel->getCurvePoints(curveIdx);
+                if ( points ) {
+                    CurveProps props = _bookModel->curveProps(curveIdx);
+
                     // Line color
-                    QColor color(_bookModel->getDataString(curveIdx,
-                                                         "CurveColor","Curve"));
+                    QColor color(props.color);
                     pen.setColor(color);
                     pixmapPainter.setPen(pen);
 
                     // Scale transform (e.g. for unit axis scaling)
-                    double xs = _bookModel->xScale(curveIdx);
-                    double ys = _bookModel->yScale(curveIdx);
-                    double xb = _bookModel->xBias(curveIdx);
-                    double yb = _bookModel->yBias(curveIdx);
+                    double xs = props.xScale;
+                    double ys = props.yScale;
+                    double xb = props.xBias;
+                    double yb = props.yBias;
                     QTransform Tscaled(T);
                     Tscaled = Tscaled.scale(xs,ys);
                     Tscaled = Tscaled.translate(xb/xs,yb/ys);
                     pixmapPainter.setTransform(Tscaled);
 
                     // Line style
-                    QString lineStyle = _bookModel->getDataString(curveIdx,
-                                                      "CurveLineStyle","Curve");
-                    lineStyle = lineStyle.toLower();
+                    const QString& lineStyle = props.lineStyle;
 
                     // Draw curve!
                     if ( lineStyle == "thick_line" ||
@@ -159,10 +157,9 @@ void CurvesLayoutItem::paint(QPainter *painter,
                         }
                         pixmapPainter.setPen(pen);
                         QPointF pLast;
-                        for ( int i = 0; i < path->elementCount(); ++i ) {
-                            QPainterPath::Element el = path->elementAt(i);
-                            QPointF p(el.x,el.y);
-                            p = Tscaled.map(p);
+                        int n = points->count();
+                        for ( int i = 0; i < n; ++i ) {
+                            QPointF p = Tscaled.map(points->at(i));
                             if  ( i > 0 ) {
                                 pixmapPainter.drawLine(pLast,p);
                             }
@@ -182,10 +179,9 @@ void CurvesLayoutItem::paint(QPainter *painter,
                         brush.setColor(color);
                         pixmapPainter.setBrush(brush);
                         double r = pen.widthF();
-                        for ( int i = 0; i < path->elementCount(); ++i ) {
-                            QPainterPath::Element el = path->elementAt(i);
-                            QPointF p(el.x,el.y);
-                            p = Tscaled.map(p);
+                        int n = points->count();
+                        for ( int i = 0; i < n; ++i ) {
+                            QPointF p = Tscaled.map(points->at(i));
                             pixmapPainter.drawEllipse(p,r,r);
                         }
                         pen.setWidthF(w);
@@ -193,12 +189,20 @@ void CurvesLayoutItem::paint(QPainter *painter,
                         pixmapPainter.setBrush(origBrush);
                         pixmapPainter.setTransform(Tscaled);
                     } else {
-                        pixmapPainter.drawPath(*path);
+                        CurveLOD* lod = _bookModel->getCurveLOD(curveIdx);
+                        if ( lod ) {
+                            QRectF P(pixmap.rect());
+                            QRectF V = Tscaled.inverted().mapRect(P);
+                            pixmapPainter.drawPath(lod->path(V.left(),
+                                                             V.right(),w));
+                        } else {
+                            pixmapPainter.drawPath(points->toPainterPath());
+                        }
                     }
                 }
             }
             QRectF S(pixmap.rect());
-            painter->drawPixmap(R,pixmap,S);
+            painter->drawImage(R,pixmap,S);
         } else {
             _printCoplot(T,painter,_plotIdx);
         }
@@ -221,38 +225,38 @@ void CurvesLayoutItem::_printCoplot(const QTransform& T,
     double start = _bookModel->getDataDouble(QModelIndex(),"StartTime");
     double stop = _bookModel->getDataDouble(QModelIndex(),"StopTime");
 
-    QString plotXScale = _bookModel->getDataString(plotIdx,
-                                                   "PlotXScale","Plot");
-    QString plotYScale = _bookModel->getDataString(plotIdx,
-                                                   "PlotYScale","Plot");
-    bool isXLogScale = ( plotXScale == "log" ) ? true : false;
-    bool isYLogScale = ( plotYScale == "log" ) ? true : false;
+    PlotProps plotProps = _bookModel->plotProps(plotIdx);
+    bool isXLogScale = plotProps.isXLogScale;
+    bool isYLogScale = plotProps.isYLogScale;
+
+    double columnWidth = _printColumnWidth(painter);
 
-    QList<QPainterPath*> paths;
+    QList<CurvePoints*> curves;
     QModelIndex curvesIdx = _bookModel->getIndex(plotIdx,"Curves","Plot");
     int rc = _bookModel->rowCount(curvesIdx);
     for ( int i = 0; i < rc; ++i ) {
 
         QModelIndex curveIdx = _bookModel->index(i,0,curvesIdx);
-        QModelIndex curveDataIdx = _bookModel->getDataIndex(curveIdx,
-                                                           "CurveData","Curve");
-        QVariant v = _bookModel->data(curveDataIdx);
-        CurveModel* curveModel =QVariantToPtr<CurveModel>::convert(v);
+        CurveProps props = _bookModel->curveProps(curveIdx);
+        CurveModel* curveModel = props.curveModel;
 
         if ( curveModel ) {
 
-            double xs = _bookModel->xScale(curveIdx);
-            double ys = _bookModel->yScale(curveIdx);
-            double xb = _bookModel->xBias(curveIdx);
-            double yb = _bookModel->yBias(curveIdx);
+            double xs = props.xScale;
+            double ys = props.yScale;
+            double xb = props.xBias;
+            double yb = props.yBias;
 
-            QPainterPath* path = new QPainterPath;
-            paths << path;
+            CurvePoints* points = new CurvePoints;
+            curves << points;
 
-            curveModel->map();
+            // Every dot of a scatter plot shows, so only decimate lines
+            bool isScatter = ( props.lineStyle == "scatter" );
+            CurveDecimator decimator(points, isScatter ? 0.0 : columnWidth);
+
+            curveModel->pin(); // other threads may be printing this file
             ModelIterator* it = curveModel->begin();
 
-            bool isFirst = true;
             while ( !it->isDone() ) {
 
                 if ( it->t() < start || it->t() > stop ) {
@@ -267,19 +271,19 @@ void CurvesLayoutItem::_printCoplot(const QTransform& T,
                 QPointF p(x,y);
                 p = T.map(p);
 
-                if ( isFirst ) {
-                    path->moveTo(p.x(),p.y());
-                    isFirst = false;
+                if ( std::isfinite(p.x()) && std::isfinite(p.y()) ) {
+                    decimator.append(p.x(),p.y());
                 } else {
-                    path->lineTo(p);
+                    decimator.gap();
                 }
 
                 it->next();
             }
             delete it;
+            decimator.finish();
 
             // If curve is flat (constant), label with "Flatline=#"
-            QRectF curveBBox = path->boundingRect();
+            QRectF curveBBox = points->boundingRect();
             if ( curveBBox.height() == 0.0 ) {
                 it = curveModel->begin();
                 double y = it->y()*ys+yb;  // y is constant, so use first point
@@ -295,15 +299,14 @@ void CurvesLayoutItem::_printCoplot(const QTransform& T,
                 }
                 s = QString("Flatline=%1").arg(s);
                 int h = painter->fontMetrics().height();
-                QColor color( _bookModel->getDataString(curveIdx,
-                                                        "CurveColor","Curve"));
+                QColor color(props.color);
                 QPen pen = painter->pen();
                 pen.setColor(color);
                 painter->setPen(pen);
                 painter->drawText(curveBBox.topLeft()-QPointF(0,h+10),s);
             }
 
-            curveModel->unmap();
+            curveModel->unpin(); // map is the GUI thread's to drop
         }
     }
 
@@ -313,11 +316,11 @@ void CurvesLayoutItem::_printCoplot(const QTransform& T,
     QPen pen = painter->pen();
 
     double xHeight = painter->fontMetrics().xHeight();
-    if ( paths.size() > 20 ) {
+    if ( curves.size() > 20 ) {
         pen.setWidthF(xHeight/11.0);// smaller point size if many curves
-    } else if ( paths.size() > 5 && paths.size() < 20 ) {
+    } else if ( curves.size() > 5 && curves.size() < 20 ) {
         pen.setWidthF(xHeight/7.0);
-    } else if ( paths.size() < 5 ) {
+    } else if ( curves.size() < 5 ) {
         pen.setWidthF(xHeight/5.0);
     }
     if (pen.widthF() < 1.0 ) {
@@ -325,19 +328,15 @@ void CurvesLayoutItem::_printCoplot(const QTransform& T,
     }
 
     int i = 0;
-    foreach ( QPainterPath* path, paths ) {
+    foreach ( CurvePoints* points, curves ) {
         QModelIndex curveIdx = _bookModel->index(i,0,curvesIdx);
-        QColor color( _bookModel->getDataString(curveIdx,
-                                                "CurveColor","Curve"));
+        CurveProps props = _bookModel->curveProps(curveIdx);
+        QColor color(props.color);
         pen.setColor(color);
-        QString linestyle =  _bookModel->getDataString(curveIdx,
-                                                      "CurveLineStyle","Curve");
-        pen.setDashPattern(_bookModel->getLineStylePattern(linestyle));
+        pen.setDashPattern(props.linePattern);
 
         // Handle thick_line and x_thick_line styles
-        QString style = _bookModel->getDataString(curveIdx,
-                                                  "CurveLineStyle","Curve");
-        style = style.toLower();
+        const QString& style = props.lineStyle;
         double penWidthOrig = pen.widthF();
         if ( style == "thick_line" ) {
             if ( pen.widthF() == 0.0 ) {
@@ -365,22 +364,19 @@ void CurvesLayoutItem::_printCoplot(const QTransform& T,
             QBrush brush(Qt::SolidPattern);
             brush.setColor(color);
             painter->setBrush(brush);
-            for ( int i = 0; i < path->elementCount(); ++i ) {
-                QPainterPath::Element el = path->elementAt(i);
-                QPointF p(el.x,el.y);
+            for ( int i = 0; i < points->count(); ++i ) {
+                QPointF p = points->at(i);
                 double r = pen.widthF();
                 painter->drawEllipse(p,r,r); // Qt would not drawPoint for me!
             }
             painter->setBrush(origBrush);
         } else {
-            painter->drawPath(*path);
+            painter->drawPath(points->toPainterPath());
         }
         pen.setWidthF(penWidthOrig);
 
         // Draw symbols
-        QString symbolStyle = _bookModel->getDataString(curveIdx,
-                                                   "CurveSymbolStyle", "Curve");
-        symbolStyle = symbolStyle.toLower();
+        const QString& symbolStyle = props.symbolStyle;
         if ( !symbolStyle.isEmpty() && symbolStyle != "none" ) {
             QVector<qreal> pattern;
             pen.setDashPattern(pattern); // plain lines for drawing symbols
@@ -388,9 +384,8 @@ void CurvesLayoutItem::_printCoplot(const QTransform& T,
             pen.setWidthF(xHeight/11.0);
             painter->setPen(pen);
             QPointF pLast;
-            for ( int i = 0; i < path->elementCount(); ++i ) {
-                QPainterPath::Element el = path->elementAt(i);
-                QPointF p(el.x,el.y);
+            for ( int i = 0; i < points->count(); ++i ) {
+                QPointF p = points->at(i);
                 if ( i > 0 ) {
                     double r = xHeight*3.0;
                     double x = pLast.x()-r/2.0;
@@ -407,7 +402,7 @@ void CurvesLayoutItem::_printCoplot(const QTransform& T,
             pen.setWidthF(w);
             painter->setPen(pen);
         }
-        delete path;
+        delete points;
         ++i;
     }
     painter->restore();
@@ -586,8 +581,8 @@ void CurvesLayoutItem::_printErrorplot(const QTransform& T,
     double k1 = _bookModel->getDataDouble(curveIdx1,"CurveYScale","Curve");
     double ys0 = _bookModel->yScale(curveIdx0);
     double ys1 = (k1/k0)*_bookModel->yScale(curveIdx1);
-    c0->map();
-    c1->map();
+    c0->pin(); // other threads may be printing these files
+    c1->pin();
     ModelIterator* i0 = c0->begin();
     ModelIterator* i1 = c1->begin();
     while ( !i0->isDone() && !i1->isDone() ) {
@@ -613,24 +608,23 @@ void CurvesLayoutItem::_printErrorplot(const QTransform& T,
     }
     delete i0;
     delete i1;
-    c0->unmap();
-    c1->unmap();
+    c0->unpin(); // maps are the GUI thread's to drop
+    c1->unpin();
 
 
     // Create path from points
-    QPainterPath path;
-    if ( !pts.isEmpty() ) {
-        bool isFirst = true;
-        foreach ( QPointF p, pts ) {
-            p = T.map(p);
-            if ( isFirst ) {
-                isFirst = false;
-                path.moveTo(p);
-            } else {
-                path.lineTo(p);
-            }
+    CurvePoints points;
+    CurveDecimator decimator(&points,_printColumnWidth(painter));
+    foreach ( QPointF p, pts ) {
+        p = T.map(p);
+        if ( std::isfinite(p.x()) && std::isfinite(p.y()) ) {
+            decimator.append(p.x(),p.y());
+        } else {
+            decimator.gap();
         }
     }
+    decimator.finish();
+    QPainterPath path = points.toPainterPath();
 
     painter->save();
     painter->setRenderHint(QPainter::Antialiasing);
@@ -666,24 +660,35 @@ void CurvesLayoutItem::_printErrorplot(const QTransform& T,
     painter->restore();
 }
 
+// Width of a device pixel column in painter coordinates, curves are
+// decimated to min/max per column when printing (see CurveDecimator).
+// Returns 0.0 (no decimation) if the book asks for exact output.
+double CurvesLayoutItem::_printColumnWidth(QPainter *painter) const
+{
+    if ( _bookModel->isChildIndex(QModelIndex(),"","IsPrintExact") &&
+         _bookModel->getDataBool(QModelIndex(),"IsPrintExact") ) {
+        return 0.0;
+    }
+
+    double sx = qAbs(painter->deviceTransform().m11());
+    if ( sx == 0.0 ) {
+        return 0.0;
+    }
+    return 1.0/sx;
+}
+
 void CurvesLayoutItem::_paintGrid(QPainter* painter,
                                   const QRect &R,const QRect &RG,
                                   const QRect &C, const QRectF &M)
 {
     // If Grid is off, do not paint grid
-    QModelIndex isGridIdx = _bookModel->getDataIndex(_plotIdx,
-                                                     "PlotGrid","Plot");
-    bool isGrid = _bookModel->data(isGridIdx).toBool();
-    if ( !isGrid ) {
+    PlotProps plotProps = _bookModel->plotProps(_plotIdx);
+    if ( !plotProps.isGrid ) {
         return;
     }
 
-    QString plotXScale = _bookModel->getDataString(_plotIdx,
-                                                   "PlotXScale","Plot");
-    QString plotYScale = _bookModel->getDataString(_plotIdx,
-                                                   "PlotYScale","Plot");
-    bool isXLogScale = ( plotXScale == "log" ) ? true : false;
-    bool isYLogScale = ( plotYScale == "log" ) ? true : false;
+    bool isXLogScale = plotProps.isXLogScale;
+    bool isYLogScale = plotProps.isYLogScale;
 
     QList<double> xtics = _bookModel->majorXTics(_plotIdx);
     if ( isXLogScale ) {
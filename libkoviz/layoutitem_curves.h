@@ -2,8 +2,10 @@
 #define LAYOUTITEM_CURVES_H
 
 #include <QPixmap>
+#include <QImage>
 #include "layoutitem_paintable.h"
 #include "bookmodel.h"
+#include "curvedecimator.h"
 
 class CurvesLayoutItem : public PaintableLayoutItem
 {
@@ -34,6 +36,7 @@ private:
                       QPainter *painter, const QModelIndex &plotIdx);
     void _printErrorplot(const QTransform& T,
                          QPainter *painter, const QModelIndex &plotIdx);
+    double _printColumnWidth(QPainter* painter) const;
     void __paintSymbol(const QPointF &p,
                        const QString &symbol, QPainter* painter);
     void _paintGrid(QPainter* painter,
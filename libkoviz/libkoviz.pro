@@ -104,7 +104,22 @@ SOURCES += bookmodel.cpp \
            filter_sgolay.cpp \
            coord_arrow.cpp \
            curvemodel_deriv.cpp \
-           curvemodel_integ.cpp
+           curvemodel_integ.cpp \
+           trickheadercache.cpp \
+           curvelod.cpp \
+           curvepoints.cpp \
+           timeindex.cpp \
+           curvesmerge.cpp \
+           bookprinter.cpp \
+           dppagebuilder.cpp \
+           curvedecimator.cpp \
+           tablerowindex.cpp \
+           jobstats.cpp \
+           curvemodel_ensemble.cpp \
+           tailfollower.cpp \
+           mappool.cpp \
+           filterjob.cpp \
+           fftplan.cpp
 
 HEADERS  += bookmodel.h \
             bookidxview.h \
@@ -184,7 +199,24 @@ HEADERS  += bookmodel.h \
             filter_sgolay.h \
             coord_arrow.h \
             curvemodel_deriv.h \
-            curvemodel_integ.h
+            curvemodel_integ.h \
+            trickheadercache.h \
+            curvelod.h \
+            curvepoints.h \
+            timeindex.h \
+            curvesmerge.h \
+            bookprinter.h \
+            dppagebuilder.h \
+            curvedecimator.h \
+            tablerowindex.h \
+            jobstats.h \
+            curvemodel_ensemble.h \
+            tailfollower.h \
+            mappool.h \
+            pagepicture.h \
+            curveslayer.h \
+            filterjob.h \
+            fftplan.h
 
 FLEXSOURCES = product_lexer.l
 BISONSOURCES = product_parser.y
@@ -0,0 +1,175 @@
+#include "mappool.h"
+#include <QFile>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+
+MapPool *MapPool::instance()
+{
+    static MapPool pool;
+    return &pool;
+}
+
+// Address space is plentiful on 64 bit, the count budget keeps a few
+// thousand RUNs well under vm.max_map_count
+MapPool::MapPool() :
+    _maxBytes(Q_INT64_C(16)*1024*1024*1024),
+    _maxMappings(4096),
+    _nBytes(0),
+    _clock(0)
+{
+}
+
+const uchar *MapPool::acquire(const QString &fileName, qint64 minSize)
+{
+    QMutexLocker locker(&_mutex);
+
+    if ( _mappings.contains(fileName) ) {
+        Mapping& m = _mappings[fileName];
+        bool isCurrent = _isCurrent(fileName,m);
+        if ( isCurrent && m.size >= minSize ) {
+            ++m.refCount;
+            m.lastUsed = ++_clock;
+            return m.mem;
+        }
+        if ( m.refCount > 0 ) {
+            fprintf(stderr,"koviz [bad scoobs]: MapPool::acquire() cannot "
+                           "%s \"%s\" while it is referenced.\n",
+                    isCurrent ? "grow" : "remap changed file",
+                    fileName.toLatin1().constData());
+            return 0;
+        }
+        munmap(m.mem,m.size);
+        _nBytes -= m.size;
+        _mappings.remove(fileName);
+    }
+
+    Mapping m;
+    if ( !_map(fileName,&m) ) {
+        return 0;
+    }
+    if ( m.size < minSize ) {
+        munmap(m.mem,m.size);
+        return 0;
+    }
+
+    m.refCount = 1;
+    m.lastUsed = ++_clock;
+    _advise(m,Sequential);
+    _mappings.insert(fileName,m);
+    _nBytes += m.size;
+
+    _evict();
+
+    return m.mem;
+}
+
+void MapPool::release(const QString &fileName)
+{
+    QMutexLocker locker(&_mutex);
+
+    if ( !_mappings.contains(fileName) ) {
+        return;
+    }
+    Mapping& m = _mappings[fileName];
+    if ( m.refCount > 0 ) {
+        --m.refCount;
+    }
+    if ( m.refCount == 0 ) {
+        _evict();
+    }
+}
+
+void MapPool::advise(const QString &fileName, Advice advice)
+{
+    QMutexLocker locker(&_mutex);
+    if ( _mappings.contains(fileName) ) {
+        _advise(_mappings.value(fileName),advice);
+    }
+}
+
+void MapPool::setBudget(qint64 maxBytes, int maxMappings)
+{
+    QMutexLocker locker(&_mutex);
+    _maxBytes = maxBytes;
+    _maxMappings = maxMappings;
+    _evict();
+}
+
+bool MapPool::_map(const QString &fileName, Mapping *m)
+{
+    QByteArray path = QFile::encodeName(fileName);
+    int fd = open(path.constData(),O_RDONLY);
+    if ( fd < 0 ) {
+        return false;
+    }
+
+    struct stat st;
+    if ( fstat(fd,&st) != 0 || st.st_size == 0 ) {
+        close(fd);
+        return false;
+    }
+
+    void* mem = mmap(0,st.st_size,PROT_READ,MAP_SHARED,fd,0);
+    close(fd); // the mapping keeps the file
+    if ( mem == MAP_FAILED ) {
+        return false;
+    }
+
+    m->mem = (uchar*)mem;
+    m->size = st.st_size;
+    m->dev = st.st_dev;
+    m->ino = st.st_ino;
+    return true;
+}
+
+// True if fileName is still the file m maps and covers all of m
+bool MapPool::_isCurrent(const QString &fileName, const Mapping &m)
+{
+    QByteArray path = QFile::encodeName(fileName);
+    struct stat st;
+    if ( stat(path.constData(),&st) != 0 ) {
+        return false;
+    }
+    return ( (quint64)st.st_dev == m.dev && (quint64)st.st_ino == m.ino &&
+             (qint64)st.st_size >= m.size );
+}
+
+void MapPool::_advise(const Mapping &m, Advice advice)
+{
+    int a = MADV_NORMAL;
+    if ( advice == Sequential ) {
+        a = MADV_SEQUENTIAL;
+    } else if ( advice == Random ) {
+        a = MADV_RANDOM;
+    }
+    madvise(m.mem,m.size,a);
+}
+
+// Unmap least recently used unreferenced mappings until within budget
+void MapPool::_evict()
+{
+    while ( _nBytes > _maxBytes || _mappings.size() > _maxMappings ) {
+        QString lruFileName;
+        quint64 lru = 0;
+        bool isFound = false;
+        QHash<QString,Mapping>::const_iterator it;
+        for ( it = _mappings.constBegin(); it != _mappings.constEnd(); ++it ) {
+            if ( it.value().refCount == 0 &&
+                 (!isFound || it.value().lastUsed < lru) ) {
+                lruFileName = it.key();
+                lru = it.value().lastUsed;
+                isFound = true;
+            }
+        }
+        if ( !isFound ) {
+            break; // everything left is in use
+        }
+        Mapping m = _mappings.take(lruFileName);
+        munmap(m.mem,m.size);
+        _nBytes -= m.size;
+    }
+}
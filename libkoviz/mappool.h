@@ -0,0 +1,80 @@
+#ifndef MAP_POOL_H
+#define MAP_POOL_H
+
+#include <QHash>
+#include <QString>
+#include <QMutex>
+
+//
+// Process wide pool of read only file mappings (trk files).
+//
+// Models map() and unmap() around nearly every read (paint, live time,
+// tables, export), and each pair used to cost an open, mmap and munmap.
+// Mappings are now reference counted here.  When the last reference
+// is released a mapping stays in the pool, so the next acquire() is a
+// hash lookup and a stat.  Unreferenced mappings are unmapped least
+// recently used first once the pool is over its byte or mapping count
+// budget.
+//
+// A cached mapping is reused only while the path still names the same
+// file (device and inode) and the file is still at least as long as
+// the mapping.  A trk replaced by a re-run, or truncated in place, is
+// remapped, since reading a mapping past the file's end is a SIGBUS.
+// Appends (see DataModel::grow()) leave the mapped bytes valid.
+//
+// The file descriptor is closed right after mmap, so cached mappings do
+// not hold open files.  Thread safe.
+//
+class MapPool
+{
+  public:
+
+    enum Advice
+    {
+        Normal,
+        Sequential,  // column scans (curves, stats)
+        Random       // row lookups (tables)
+    };
+
+    static MapPool* instance();
+
+    // Mapping of at least minSize bytes of fileName, 0 on failure.
+    // A cached mapping that is too small (the file has grown) or stale
+    // (the file was replaced or truncated) is remapped if no one else
+    // references it.
+    const uchar* acquire(const QString& fileName, qint64 minSize);
+    void release(const QString& fileName);
+
+    void advise(const QString& fileName, Advice advice);
+
+    // Unreferenced mappings are dropped beyond these
+    void setBudget(qint64 maxBytes, int maxMappings);
+
+  private:
+
+    MapPool();
+
+    struct Mapping
+    {
+        uchar* mem;
+        qint64 size;
+        quint64 dev;        // file mapped, see _isCurrent()
+        quint64 ino;
+        int refCount;
+        quint64 lastUsed;
+    };
+
+    QMutex _mutex;
+    QHash<QString,Mapping> _mappings;
+    qint64 _maxBytes;
+    int _maxMappings;
+    qint64 _nBytes;
+    quint64 _clock;
+
+    static bool _map(const QString& fileName, Mapping* m);
+    static bool _isCurrent(const QString& fileName, const Mapping& m);
+    static void _advise(const Mapping& m, Advice advice);
+    void _evict();
+};
+
+#endif // MAP_POOL_H
@@ -0,0 +1,70 @@
+#ifndef PAGEPICTURE_H
+#define PAGEPICTURE_H
+
+#include <QPicture>
+#include <QPaintDevice>
+
+//
+// Records QPainter commands like a QPicture, but reports the metrics
+// (size, dpi) of another device.  The page layout and fonts of a page
+// recorded on it come out exactly as if painted on that device.
+//
+class PagePicture : public QPicture
+{
+  public:
+    // Metrics are taken from device
+    explicit PagePicture(const QPaintDevice* device) :
+        QPicture(),
+        _width(device->width()),
+        _height(device->height()),
+        _widthMM(device->widthMM()),
+        _heightMM(device->heightMM()),
+        _dpiX(device->logicalDpiX()),
+        _dpiY(device->logicalDpiY()),
+        _physicalDpiX(device->physicalDpiX()),
+        _physicalDpiY(device->physicalDpiY())
+    {
+    }
+
+    // Copies metrics only (not recorded commands)
+    PagePicture(const PagePicture& o) :
+        QPicture(),
+        _width(o._width),
+        _height(o._height),
+        _widthMM(o._widthMM),
+        _heightMM(o._heightMM),
+        _dpiX(o._dpiX),
+        _dpiY(o._dpiY),
+        _physicalDpiX(o._physicalDpiX),
+        _physicalDpiY(o._physicalDpiY)
+    {
+    }
+
+  protected:
+    virtual int metric(PaintDeviceMetric m) const
+    {
+        switch ( m ) {
+        case PdmWidth:         return _width;
+        case PdmHeight:        return _height;
+        case PdmWidthMM:       return _widthMM;
+        case PdmHeightMM:      return _heightMM;
+        case PdmDpiX:          return _dpiX;
+        case PdmDpiY:          return _dpiY;
+        case PdmPhysicalDpiX:  return _physicalDpiX;
+        case PdmPhysicalDpiY:  return _physicalDpiY;
+        default:               return QPicture::metric(m);
+        }
+    }
+
+  private:
+    int _width;
+    int _height;
+    int _widthMM;
+    int _heightMM;
+    int _dpiX;
+    int _dpiY;
+    int _physicalDpiX;
+    int _physicalDpiY;
+};
+
+#endif // PAGEPICTURE_H
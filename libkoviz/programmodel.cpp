@@ -11,8 +11,8 @@ ProgramModel::ProgramModel(const QList<CurveModel *> &inputCurves,
                            QObject *parent) :
     DataModel(timeNames, programfile, parent),
     _timeNames(timeNames),_programfile(programfile),
-    _nrows(0), _ncols(0),_iteratorTimeIndex(0),
-    _data(0), _library(0)
+    _nrows(0), _ncols(0),
+    _data(0), _library(0), _program(0), _programBatch(0)
 {
     _init(inputCurves,inputParams,outputNames);
 }
@@ -33,12 +33,16 @@ void ProgramModel::_init(const QList<CurveModel*>& inputCurves,
         exit(-1);
     }
     _program = (ExternalProgram) _library->resolve("kovizProgram");
-    if ( !_program ) {
+    _programBatch = (ExternalProgramBatch)
+                              _library->resolve("kovizProgramBatch");
+    if ( !_program && !_programBatch ) {
         fprintf(stderr, "koviz [error]: Could not find symbol "
-                        "\"kovizProgram\" in %s\n",
+                        "\"kovizProgram\" or \"kovizProgramBatch\" in %s\n",
                         _library->fileName().toLatin1().constData());
         exit(-1);
     }
+    ExternalProgramIsThreadSafe isThreadSafe = (ExternalProgramIsThreadSafe)
+                             _library->resolve("kovizProgramIsThreadSafe");
 
     QString timeName;
     bool ok = false;
@@ -85,9 +89,6 @@ void ProgramModel::_init(const QList<CurveModel*>& inputCurves,
 
     _ncols = col;
 
-    _iteratorTimeIndex = new ProgramModelIterator(0,this,
-                                                  _timeCol,_timeCol,_timeCol);
-
     // Get number of data rows in program file
     foreach ( CurveModel* curveModel, inputCurves ) {
         curveModel->map();
@@ -126,13 +127,14 @@ void ProgramModel::_init(const QList<CurveModel*>& inputCurves,
     // Copy timestamps to _data (column 0)
     int row = 0;
     foreach (double timeStamp, _timeStamps ) {
-        _data[row*_ncols] = timeStamp;
+        _data[_timeCol*_nrows+row] = timeStamp;
         ++row;
     }
+    const double* timeStamps = &_data[_timeCol*_nrows];
 
-    // Load input curve data into an array
+    // Load input curve data into column arrays, input i at row is
+    // input_data[i*_nrows+row]
     double* input_data = (double*)malloc(_nrows*nInputs*sizeof(double));
-    row = 0;
     col = 0;
     foreach ( CurveModel* curveModel, inputCurves ) {
         Parameter inputParam = inputParams.at(col);
@@ -153,50 +155,115 @@ void ProgramModel::_init(const QList<CurveModel*>& inputCurves,
             sf = Unit::scale(curveModel->y()->unit(), inputParam.unit());
             bias = Unit::bias(curveModel->y()->unit(), inputParam.unit());
         }
-        curveModel->map();
-        ModelIterator* it = curveModel->begin();
-        row = 0;
-        while ( !it->isDone() ) {
-
-            double timeStamp = _data[row*_ncols];
 
-            double t = it->t();
+        curveModel->map();
+        int n = curveModel->rowCount();
+        QVector<double> ts(n);
+        QVector<double> ys(n);
+        curveModel->values(0,n,ts.data(),0,ys.data());
+        curveModel->unmap();
 
-            if ( t == timeStamp ) {
-                input_data[row*nInputs+col] = it->y()*sf+bias;
-            } else if ( timeStamp < t ) {
-                // Interpolate
+        // Sample input at every time stamp.  Stamps this curve was not
+        // logged at (another input was) are linearly interpolated, and
+        // stamps outside the curve's time span hold its end values.
+        double* in = &input_data[col*_nrows];
+        int k = 0;
+        for ( row = 0; row < _nrows; ++row ) {
+            double t = timeStamps[row];
+            while ( k < n-1 && ts.at(k+1) <= t ) {
+                ++k;
+            }
+            double y;
+            if ( n == 0 ) {
+                y = 0.0;
+            } else if ( t <= ts.at(k) || k == n-1 ) {
+                y = ys.at(k);
             } else {
-                fprintf(stderr, "koviz [bad scoobs]: ProgramModel::_init() "
-                                "time stamp weirdness... abort!!!"
-                                "t=%g timeStamp=%g row=%d\n",
-                                t,timeStamp,row);
-                exit(-1);
+                double t0 = ts.at(k);
+                double t1 = ts.at(k+1);
+                double y0 = ys.at(k);
+                double y1 = ys.at(k+1);
+                y = y0 + (y1-y0)*(t-t0)/(t1-t0);
             }
-
-            it->next();
-            ++row;
+            in[row] = y*sf+bias;
         }
 
-        delete it;
-        curveModel->unmap();
         ++col;
     }
 
-    // Generate output curves
-    double* in;
-    double* out = (double*)malloc(nOutputs);
-    col = 1;
-    for ( int row = 0; row < _nrows; ++row ) {
-        in = &input_data[row*nInputs];
-        _program(in,nInputs,out,nOutputs);
-        for (int i = 0; i < nOutputs; ++i ) {
-            _data[row*_ncols+i+1] = out[i]; // 1 for timestamp
+    // Generate output curves, a block of rows at a time
+    QAtomicInt failedRow(-1);
+    QAtomicInt failedRet(0);
+    if ( _programBatch && isThreadSafe && isThreadSafe() ) {
+        QThreadPool pool;
+        for ( int beg = 0; beg < _nrows; beg += _blockSize ) {
+            int end = qMin(_nrows,beg+_blockSize);
+            pool.start(new ProgramModelBlock(this,input_data,
+                                             nInputs,nOutputs,beg,end,
+                                             &failedRow,&failedRet));
+        }
+        pool.waitForDone();
+    } else {
+        for ( int beg = 0; beg < _nrows; beg += _blockSize ) {
+            int end = qMin(_nrows,beg+_blockSize);
+            int ret = _runProgram(input_data,nInputs,nOutputs,beg,end);
+            if ( ret != 0 ) {
+                failedRow.store(beg);
+                failedRet.store(ret);
+                break;
+            }
         }
     }
-    free(out);
 
     free(input_data);
+
+    // Report here, not on a pool thread
+    int beg = failedRow.load();
+    if ( beg >= 0 ) {
+        fprintf(stderr, "koviz [error]: kovizProgramBatch in %s "
+                        "returned %d for rows [%d,%d)\n",
+                        _library->fileName().toLatin1().constData(),
+                        failedRet.load(),beg,qMin(_nrows,beg+_blockSize));
+        exit(-1);
+    }
+}
+
+// Outputs for rows [beginRow,endRow) from column array inputs.  Returns
+// kovizProgramBatch's return code, 0 on success.
+int ProgramModel::_runProgram(const double *inputs, int nInputs,
+                              int nOutputs, int beginRow, int endRow)
+{
+    int n = endRow-beginRow;
+    if ( n <= 0 ) {
+        return 0;
+    }
+
+    if ( _programBatch ) {
+        QVector<const double*> in(nInputs);
+        QVector<double*> out(nOutputs);
+        for ( int i = 0; i < nInputs; ++i ) {
+            in[i] = &inputs[i*_nrows+beginRow];
+        }
+        for ( int i = 0; i < nOutputs; ++i ) {
+            out[i] = &_data[(i+1)*_nrows+beginRow]; // +1 for timestamp
+        }
+        return _programBatch(in.data(),nInputs,out.data(),nOutputs,n);
+    }
+
+    // Per row fallback
+    QVector<double> in(nInputs);
+    QVector<double> out(nOutputs);
+    for ( int row = beginRow; row < endRow; ++row ) {
+        for ( int i = 0; i < nInputs; ++i ) {
+            in[i] = inputs[i*_nrows+row];
+        }
+        _program(in.data(),nInputs,out.data(),nOutputs);
+        for ( int i = 0; i < nOutputs; ++i ) {
+            _data[(i+1)*_nrows+row] = out.at(i); // +1 for timestamp
+        }
+    }
+
+    return 0;
 }
 
 void ProgramModel::map()
@@ -226,11 +293,6 @@ ProgramModel::~ProgramModel()
         free(_data);
         _data = 0;
     }
-
-    if ( _iteratorTimeIndex ) {
-        delete _iteratorTimeIndex;
-        _iteratorTimeIndex = 0;
-    }
 }
 
 const Parameter* ProgramModel::param(int col) const
@@ -240,60 +302,16 @@ const Parameter* ProgramModel::param(int col) const
 
 int ProgramModel::indexAtTime(double time)
 {
-    return _idxAtTimeBinarySearch(_iteratorTimeIndex,0,rowCount()-1,time);
+    return timeIndex(_timeCol)->indexAtTime(time);
 }
 
-int ProgramModel::_idxAtTimeBinarySearch (ProgramModelIterator* it,
-                                       int low, int high, double time)
+void ProgramModel::columnValues(int col, int beginRow, int endRow,
+                                double *out) const
 {
-        if (high <= 0 ) {
-                return 0;
-        }
-        if (low >= high) {
-                // Time not found, choose closest near high
-                double t1 = it->at(high-1)->t();
-                double t2 = it->at(high)->t();
-                double t3 = t2;
-                it = it->at(high+1);
-                if ( !it->isDone() ) {
-                    t3 = it->at(high+1)->t();
-                }
-
-                int i;
-                if ( qAbs(time-t1) < qAbs(time-t2) ) {
-                    if ( qAbs(time-t1) < qAbs(time-t3) ) {
-                        i = high-1;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                } else {
-                    if ( qAbs(time-t2) < qAbs(time-t3) ) {
-                        i = high;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                }
-                return i;
-        } else {
-                int mid = (low + high)/2;
-                if (time == it->at(mid)->t()) {
-                        return mid;
-                } else if ( time < it->at(mid)->t() ) {
-                        return _idxAtTimeBinarySearch(it,
-                                                      low, mid-1, time);
-                } else {
-                        return _idxAtTimeBinarySearch(it,
-                                                      mid+1, high, time);
-                }
-        }
+    if ( endRow <= beginRow ) {
+        return;
+    }
+    memcpy(out,&_data[col*_nrows+beginRow],(endRow-beginRow)*sizeof(double));
 }
 
 int ProgramModel::rowCount(const QModelIndex &pidx) const
@@ -323,7 +341,7 @@ QVariant ProgramModel::data(const QModelIndex &idx, int role) const
     if ( idx.isValid() && _data ) {
         int row = idx.row();
         int col = idx.column();
-        val = _data[row*_ncols+col];
+        val = _data[col*_nrows+row];
     }
 
     return val;
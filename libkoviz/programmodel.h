@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <QString>
 #include <QStringList>
 #include <QVariant>
@@ -10,6 +11,10 @@
 #include <QProgressDialog>
 #include <QFileInfo>
 #include <QLibrary>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QVector>
 #include <stdexcept>
 #include <math.h>
 
@@ -22,13 +27,34 @@
 class ProgramModel;
 class ProgramModelIterator;
 
+//
+// External DP programs are shared libraries exporting
+//
+//     int kovizProgram(double* in, int nIn, double* out, int nOut)
+//
+// which is called once per row.  A library may also export
+//
+//     int kovizProgramBatch(const double** in, int nIn,
+//                           double** out, int nOut, int nRows)
+//
+// which is handed column arrays (in[i][row], out[j][row]) for a block of
+// rows at a time and returns 0 on success.  If present, it is used
+// instead of kovizProgram.  If the library also exports
+//
+//     int kovizProgramIsThreadSafe()
+//
+// returning non-zero, blocks are run on several threads at once.
+//
 typedef int (*ExternalProgram)(double*,int,double*,int);
+typedef int (*ExternalProgramBatch)(const double**,int,double**,int,int);
+typedef int (*ExternalProgramIsThreadSafe)();
 
 class ProgramModel : public DataModel
 {
   Q_OBJECT
 
   friend class ProgramModelIterator;
+  friend class ProgramModelBlock;
 
   public:
 
@@ -47,6 +73,9 @@ class ProgramModel : public DataModel
     virtual ModelIterator* begin(int tcol, int xcol, int ycol) const ;
     int indexAtTime(double time);
 
+    virtual void columnValues(int col, int beginRow, int endRow,
+                              double* out) const;
+
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual QVariant data (const QModelIndex & index,
@@ -63,14 +92,16 @@ class ProgramModel : public DataModel
 
     QHash<int,Parameter*> _col2param;
     QHash<QString,int> _paramName2col;
-    ProgramModelIterator* _iteratorTimeIndex;
 
     QList<double> _timeStamps;
 
-    double* _data;
+    double* _data;    // column major, _data[col*_nrows+row]
 
     QLibrary* _library;
     ExternalProgram _program;
+    ExternalProgramBatch _programBatch;
+
+    static const int _blockSize = 65536; // rows per kovizProgramBatch call
 
     static QString _err_string;
     static QTextStream _err_stream;
@@ -78,8 +109,47 @@ class ProgramModel : public DataModel
     void _init(const QList<CurveModel *> &inputCurves,
                const QList<Parameter> &inputParams,
                const QStringList &outputNames);
-    int _idxAtTimeBinarySearch (ProgramModelIterator *it,
-                               int low, int high, double time);
+    int _runProgram(const double* inputs, int nInputs, int nOutputs,
+                    int beginRow, int endRow);
+};
+
+// Runs a block of rows through the program on a pool thread.  The first
+// block to fail records its begin row and return code for
+// ProgramModel::_init() to report, blocks not yet run are skipped.
+class ProgramModelBlock : public QRunnable
+{
+  public:
+    ProgramModelBlock(ProgramModel* model, const double* inputs,
+                      int nInputs, int nOutputs, int beginRow, int endRow,
+                      QAtomicInt* failedRow, QAtomicInt* failedRet) :
+        _model(model), _inputs(inputs),
+        _nInputs(nInputs), _nOutputs(nOutputs),
+        _beginRow(beginRow), _endRow(endRow),
+        _failedRow(failedRow), _failedRet(failedRet)
+    {
+    }
+
+    void run()
+    {
+        if ( _failedRow->load() >= 0 ) {
+            return;
+        }
+        int ret = _model->_runProgram(_inputs,_nInputs,_nOutputs,
+                                      _beginRow,_endRow);
+        if ( ret != 0 && _failedRow->testAndSetOrdered(-1,_beginRow) ) {
+            _failedRet->store(ret);
+        }
+    }
+
+  private:
+    ProgramModel* _model;
+    const double* _inputs;
+    int _nInputs;
+    int _nOutputs;
+    int _beginRow;
+    int _endRow;
+    QAtomicInt* _failedRow;
+    QAtomicInt* _failedRet;
 };
 
 class ProgramModelIterator : public ModelIterator
@@ -122,17 +192,17 @@ class ProgramModelIterator : public ModelIterator
 
     inline double t() const
     {
-        return _model->_data[i*_model->_ncols+_tcol];
+        return _model->_data[_tcol*_model->_nrows+i];
     }
 
     inline double x() const
     {
-        return _model->_data[i*_model->_ncols+_xcol];
+        return _model->_data[_xcol*_model->_nrows+i];
     }
 
     inline double y() const
     {
-        return _model->_data[i*_model->_ncols+_ycol];
+        return _model->_data[_ycol*_model->_nrows+i];
     }
 
   private:
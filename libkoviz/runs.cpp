@@ -6,7 +6,9 @@ QTextStream Runs::_err_stream(&Runs::_err_string);
 Runs::Runs() :
     _runDirs(QStringList()),
     _varMap(QHash<QString,QStringList>()),
-    _isShowProgress(true)
+    _isShowProgress(true),
+    _isUseHeaderCache(true),
+    _loadThreads(0)
 {
 }
 
@@ -15,13 +17,17 @@ Runs::Runs(const QStringList &timeNames,
            const QHash<QString,QStringList>& varMap,
            const QString &filterPattern,
            const QString &excludePattern,
-           bool isShowProgress) :
+           bool isShowProgress,
+           bool isUseHeaderCache,
+           int loadThreads) :
     _timeNames(timeNames),
     _runDirs(runDirs),
     _varMap(varMap),
     _filterPattern(filterPattern),
     _excludePattern(excludePattern),
-    _isShowProgress(isShowProgress)
+    _isShowProgress(isShowProgress),
+    _isUseHeaderCache(isUseHeaderCache),
+    _loadThreads(loadThreads)
 {
     if ( runDirs.isEmpty() ) {
         return;
@@ -109,23 +115,66 @@ void Runs::_init()
         progress->setMinimumDuration(500);
     }
 
+    // Load models on a pool of their own, so -loadThreads does not limit
+    // the global pool's other users
+    QVector<DataModel*> fileModels(nFiles,0);
+    QStringList fileErrors;
+    for ( int i = 0; i < nFiles; ++i ) {
+        fileErrors << QString();
+    }
+    QAtomicInt next(0);
+    QAtomicInt done(0);
+    QAtomicInt isCancel(0);
+    TrickHeaderCache headerCache;
+    TrickHeaderCache* cache = _isUseHeaderCache ? &headerCache : 0;
+    QThreadPool pool;
+    if ( _loadThreads > 0 ) {
+        pool.setMaxThreadCount(_loadThreads);
+    }
+    int nWorkers = qMin(pool.maxThreadCount(),nFiles);
+    for ( int w = 0; w < nWorkers; ++w ) {
+        pool.start(new DataModelLoader(_timeNames,files,
+                                       &fileModels,&fileErrors,
+                                       &next,&done,&isCancel,
+                                       QThread::currentThread(),cache));
+    }
+
+    while ( !pool.waitForDone(50) ) {
+        if ( _isShowProgress && nFiles > 7 ) {
+            // Only show progress when loading many files (7 is arbitrary)
+            progress->setValue(done.load());
+            if (progress->wasCanceled()) {
+                // Let loaders finish their files before statics go away
+                isCancel.store(1);
+                pool.waitForDone();
+                exit(0);
+            }
+        }
+    }
+
+    if ( cache ) {
+        cache->save();
+    }
+
+    // Report first failure in file order (same as a serial load would)
+    for ( int i = 0; i < nFiles; ++i ) {
+        if ( !fileErrors.at(i).isEmpty() ) {
+            foreach ( DataModel* m, fileModels ) {
+                delete m;
+            }
+            if ( _isShowProgress ) {
+                delete progress;
+            }
+            _err_string = fileErrors.at(i);
+            throw std::runtime_error(_err_string.toLatin1().constData());
+        }
+    }
+
     QHash<QString,QStringList> runToParams;
     QHash<QPair<QString,QString>,DataModel*> pfnameToModel;
     int i = 0;
     foreach (QString fname, files ) {
-        if ( _isShowProgress ) {
-            if ( nFiles > 7 ) {
-                // Only show progress when loading many files (7 is arbitrary)
-                progress->setValue(i);
-                if (progress->wasCanceled()) {
-                    exit(0);
-                }
-            } else {
-                progress->setValue(files.size());
-            }
-        }
-        DataModel* m = DataModel::createDataModel(_timeNames,fname);
-        m->unmap();
+        DataModel* m = fileModels.at(i);
         _models.append(m);
         int ncols = m->columnCount();
         QStringList mParams;
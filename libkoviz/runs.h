@@ -14,11 +14,17 @@
 #include <QStandardItemModel>
 #include <QProgressDialog>
 #include <QRegExp>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QThread>
+#include <QAtomicInt>
+#include <QVector>
 #include <stdexcept>
 #include "datamodel.h"
 #include "curvemodel.h"
 #include "numsortitem.h"
 #include "mapvalue.h"
+#include "trickheadercache.h"
 
 class Runs
 {
@@ -29,10 +35,13 @@ class Runs
          const QHash<QString,QStringList> &varMap,
          const QString& filterPattern,
          const QString& excludePattern,
-         bool isShowProgress);
+         bool isShowProgress,
+         bool isUseHeaderCache=true,
+         int loadThreads=0);
     virtual ~Runs();
     virtual QStringList params() const { return _params; }
     virtual QStringList runDirs() const { return _runDirs; }
+    QList<DataModel*> models() const { return _models; }
     CurveModel* curveModel(int row,
                       const QString& tName,
                       const QString& xName,
@@ -57,6 +66,8 @@ class Runs
     QString _filterPattern;
     QString _excludePattern;
     bool _isShowProgress;
+    bool _isUseHeaderCache;
+    int _loadThreads;       // 0 is one per core
     QStringList _params;
     QHash<QString,QList<DataModel*>* > _paramToModels;
     QList<DataModel*> _models;
@@ -70,5 +81,66 @@ class Runs
     static QTextStream _err_stream;
 };
 
+//
+// Pool worker for Runs::_init().  Each worker pulls the next unclaimed
+// file off a shared counter so slow files do not stall the others.
+// Models are stored by file index so ordering is deterministic.
+//
+class DataModelLoader : public QRunnable
+{
+  public:
+    DataModelLoader(const QStringList& timeNames,
+                    const QStringList& files,
+                    QVector<DataModel*>* models,
+                    QStringList* errors,
+                    QAtomicInt* next,
+                    QAtomicInt* done,
+                    QAtomicInt* isCancel,
+                    QThread* mainThread,
+                    TrickHeaderCache* headerCache) :
+        _timeNames(timeNames),
+        _files(files),
+        _models(models),
+        _errors(errors),
+        _next(next),
+        _done(done),
+        _isCancel(isCancel),
+        _mainThread(mainThread),
+        _headerCache(headerCache)
+    {
+    }
+
+    void run()
+    {
+        while ( !_isCancel->load() ) {
+            int i = _next->fetchAndAddOrdered(1);
+            if ( i >= _files.size() ) {
+                break;
+            }
+            try {
+                DataModel* m = DataModel::createDataModel(_timeNames,
+                                                          _files.at(i),
+                                                          _headerCache);
+                m->unmap();
+                m->moveToThread(_mainThread);
+                (*_models)[i] = m;
+            } catch (std::exception &e) {
+                (*_errors)[i] = QString(e.what());
+            }
+            _done->fetchAndAddOrdered(1);
+        }
+    }
+
+  private:
+    QStringList _timeNames;
+    QStringList _files;
+    QVector<DataModel*>* _models;
+    QStringList* _errors;
+    QAtomicInt* _next;
+    QAtomicInt* _done;
+    QAtomicInt* _isCancel;  // stop after the file being loaded
+    QThread* _mainThread;
+    TrickHeaderCache* _headerCache;
+};
 
 #endif // RUNS_H
@@ -63,7 +63,8 @@ void Snap::_load()
 
     _curr_sort_method = SortByJobAvgTime;
 
-    _threads = new Threads(_rundir,_jobs,_timeNames);
+    _threads = new Threads(_rundir,_jobs,_timeNames,_threadRuntimes);
+    _threadRuntimes.clear();
 
     _thread0 = 0 ;
     foreach ( Thread* thread, threads()->hash()->values() ) {
@@ -442,11 +443,38 @@ void Snap::_process_models()
     }
 
 
-    _process_jobs(_trickJobModel);
+    // Job stats take a single pass per model, models in parallel
+    QList<JobStats*> jobStatsList;
+    jobStatsList << new JobStats(_trickJobModel);
+    _process_jobs(_trickJobModel,jobStatsList.last());
     foreach ( DataModel* userJobModel, _userJobModels ) {
-        _process_jobs(userJobModel);
+        jobStatsList << new JobStats(userJobModel);
+        _process_jobs(userJobModel,jobStatsList.last());
+    }
+
+    QThreadPool pool;
+    foreach ( JobStats* jobStats, jobStatsList ) {
+        pool.start(jobStats);
+    }
+    pool.waitForDone();
+
+    // Per thread frame time sums, a thread's jobs may span models
+    _threadRuntimes.clear();
+    foreach ( JobStats* jobStats, jobStatsList ) {
+        QMap<int,QVector<double> >::const_iterator i;
+        for ( i = jobStats->threadRuntimes().constBegin();
+              i != jobStats->threadRuntimes().constEnd(); ++i ) {
+            QVector<double>& sums = _threadRuntimes[i.key()];
+            const QVector<double>& rts = i.value();
+            if ( sums.size() < rts.size() ) {
+                sums.resize(rts.size()); // new elements are zeroed
+            }
+            for ( int j = 0; j < rts.size(); ++j ) {
+                sums[j] += rts.at(j);
+            }
+        }
+        delete jobStats;
     }
-
 }
 
 double Snap::frame_rate() const
@@ -574,7 +602,7 @@ double Snap::_calc_frame_stddev(double frameAvg)
     return sqrt(sum/_frames.length()) ;
 }
 
-bool Snap::_process_jobs(DataModel* model )
+bool Snap::_process_jobs(DataModel* model, JobStats* jobStats)
 {
     bool ret = true;
 
@@ -590,6 +618,7 @@ bool Snap::_process_jobs(DataModel* model )
         QString job_id = job->job_id();
         _id_to_job[job_id] = job;
         _jobs.append(job);
+        jobStats->addJob(job,i);
     }
 
     return ret;
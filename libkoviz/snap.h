@@ -14,8 +14,11 @@
 #include <QPropertyAnimation>
 #include <QEasingCurve>
 #include <QThread>
+#include <QThreadPool>
+#include <QVector>
 
 #include "job.h"
+#include "jobstats.h"
 #include "thread.h"
 #include "simobject.h"
 #include "frame.h"
@@ -116,7 +119,8 @@ private:
     void _process_models();
     bool _parse_s_job_execution(const QString& rundir);
     QList<Frame> _process_frames();
-    bool _process_jobs(DataModel* model);
+    bool _process_jobs(DataModel* model, JobStats* jobStats);
+    QMap<int,QVector<double> > _threadRuntimes; // see JobStats
 
     DataModel* _trickJobModel;
     QList<DataModel*> _userJobModels;
@@ -0,0 +1,155 @@
+#include "tablerowindex.h"
+
+TableRowIndex::TableRowIndex(const QList<CurveModel *> &curves,
+                             double start, double stop) :
+    _curves(curves),
+    _start(start),
+    _stop(stop)
+{
+    // Group columns by file (columns in a file share the time column)
+    QHash<QString,int> key2file;
+    foreach ( CurveModel* curve, _curves ) {
+        QString key = curve->fileName() + "\n" + curve->t()->name();
+        if ( !key2file.contains(key) ) {
+            key2file.insert(key,_fileCurves.size());
+            _fileCurves.append(curve);
+            _fileRows.append(QVector<int>());
+        }
+        _col2file.append(key2file.value(key));
+    }
+}
+
+bool TableRowIndex::build(const QAtomicInt *isCancel)
+{
+    int nFiles = _fileCurves.size();
+    QList<Cursor> cursors;
+    foreach ( CurveModel* curve, _fileCurves ) {
+        curve->pin(); // the GUI thread may unmap the file meanwhile
+        Cursor cursor;
+        cursor.curve = curve;
+        cursor.nRows = curve->rowCount();
+        cursor.row = 0;
+        cursor.bufBeg = 0;
+        cursors.append(cursor);
+    }
+
+    _times.clear();
+    for ( int f = 0; f < nFiles; ++f ) {
+        _fileRows[f].clear();
+    }
+
+    bool isCanceled = false;
+    int n = 0;
+    while ( 1 ) {
+
+        if ( isCancel && (++n % 1024) == 0 && isCancel->load() ) {
+            isCanceled = true;
+            break;
+        }
+
+        // Smallest unmerged time across files is the next table row
+        bool isFound = false;
+        double tmin = 0.0;
+        for ( int f = 0; f < nFiles; ++f ) {
+            Cursor& c = cursors[f];
+            while ( c.row < c.nRows ) {
+                double t = _t(c);
+                if ( t < _start ) {
+                    ++c.row;
+                    continue;
+                }
+                if ( t > _stop ) {
+                    c.row = c.nRows;
+                    break;
+                }
+                if ( !isFound || t < tmin ) {
+                    tmin = t;
+                    isFound = true;
+                }
+                break;
+            }
+        }
+        if ( !isFound ) {
+            break;
+        }
+
+        // Files logged at tmin step past it (duplicate stamps
+        // collapse into one row showing the last of them)
+        _times.append(tmin);
+        for ( int f = 0; f < nFiles; ++f ) {
+            Cursor& c = cursors[f];
+            int modelRow = -1;
+            while ( c.row < c.nRows && _t(c) == tmin ) {
+                modelRow = c.row;
+                ++c.row;
+            }
+            _fileRows[f].append(modelRow);
+        }
+    }
+
+    // Unpin only, the map belongs to the GUI thread (see TrickModel::pin())
+    foreach ( CurveModel* curve, _fileCurves ) {
+        curve->unpin();
+    }
+
+    if ( isCanceled ) {
+        _times.clear();
+        for ( int f = 0; f < nFiles; ++f ) {
+            _fileRows[f].clear();
+        }
+        return false;
+    }
+
+    _times.squeeze();
+    for ( int f = 0; f < nFiles; ++f ) {
+        _fileRows[f].squeeze();
+    }
+
+    return true;
+}
+
+// Time at cursor row, reads the next chunk when the row is past the buffer
+double TableRowIndex::_t(Cursor &c)
+{
+    if ( c.row >= c.bufBeg+c.t.size() ) {
+        int end = qMin(c.nRows,c.row+_chunkSize);
+        c.bufBeg = c.row;
+        c.t.resize(end-c.row);
+        c.curve->values(c.row,end,c.t.data(),0,0);
+    }
+    return c.t.at(c.row-c.bufBeg);
+}
+
+// Returns -1 if the column has no sample at row's time
+int TableRowIndex::modelRow(int col, int row) const
+{
+    return _fileRows.at(_col2file.at(col)).at(row);
+}
+
+// Row with time closest to given time (later row on a tie)
+int TableRowIndex::rowAtTime(double time) const
+{
+    int n = _times.size();
+    if ( n == 0 ) {
+        return -1;
+    }
+
+    const double* t = _times.constData();
+    int lo = 0;
+    int hi = n;
+    while ( lo < hi ) {
+        int mid = (lo+hi)/2;
+        if ( t[mid] < time ) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    if ( lo == n ) {
+        return n-1;
+    }
+    if ( lo > 0 && time-t[lo-1] < t[lo]-time ) {
+        return lo-1;
+    }
+    return lo;
+}
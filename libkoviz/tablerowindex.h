@@ -0,0 +1,111 @@
+#ifndef TABLE_ROW_INDEX_H
+#define TABLE_ROW_INDEX_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QString>
+#include "curvemodel.h"
+
+//
+// Merged row index over the variables (columns) of a table.
+//
+// Table rows are the union of the time stamps of every column in
+// [start,stop].  For each row, modelRow() gives the column's curve model
+// row logged at exactly that time, or -1 if the column has no sample
+// there (the cell is blank).  Columns from the same file share a time
+// column, so rows are kept per file, not per column.  A 1M row table
+// over a couple of RUNs costs a few tens of MB, regardless of how many
+// columns it has.
+//
+// build() does the merge and may run on a worker thread.  The caller
+// keeps the curve models alive until build() returns.
+//
+class TableRowIndex
+{
+  public:
+    TableRowIndex(const QList<CurveModel*>& curves, double start, double stop);
+
+    bool build(const QAtomicInt* isCancel=0); // false if canceled
+
+    int rowCount() const { return _times.size(); }
+    int columnCount() const { return _col2file.size(); }
+    CurveModel* curve(int col) const { return _curves.at(col); }
+    double time(int row) const { return _times.at(row); }
+    int modelRow(int col, int row) const;
+    int rowAtTime(double time) const;
+
+  private:
+    // Time cursor over a file, times are read a chunk at a time
+    struct Cursor
+    {
+        CurveModel* curve;
+        int nRows;
+        int row;
+        int bufBeg;
+        QVector<double> t;
+    };
+
+    QList<CurveModel*> _curves;
+    double _start;
+    double _stop;
+    QVector<int> _col2file;
+    QList<CurveModel*> _fileCurves;  // a curve per file for reading time
+    QVector<double> _times;
+    QList<QVector<int> > _fileRows;  // per file, model row per table row
+
+    static const int _chunkSize = 4096;
+
+    double _t(Cursor& c);
+};
+
+// Builds a table's row index on a pool thread.  The generation is handed
+// back with finished() so the view can drop results of replaced jobs.
+class TableRowIndexJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    TableRowIndexJob(TableRowIndex* rowIndex, int generation) :
+        _rowIndex(rowIndex),
+        _generation(generation),
+        _isCancel(0),
+        _isDone(false)
+    {
+        setAutoDelete(false); // BookTableView owns jobs
+    }
+
+    ~TableRowIndexJob()
+    {
+        delete _rowIndex;
+    }
+
+    void run()
+    {
+        _isDone = _rowIndex->build(&_isCancel);
+        emit finished(_generation);
+    }
+
+    void cancel() { _isCancel.store(1); }
+    bool isDone() const { return _isDone; }
+    TableRowIndex* takeRowIndex()
+    {
+        TableRowIndex* rowIndex = _rowIndex;
+        _rowIndex = 0;
+        return rowIndex;
+    }
+
+signals:
+    void finished(int generation);
+
+private:
+    TableRowIndex* _rowIndex;
+    int _generation;
+    QAtomicInt _isCancel;
+    bool _isDone;
+};
+
+#endif // TABLE_ROW_INDEX_H
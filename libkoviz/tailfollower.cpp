@@ -0,0 +1,65 @@
+#include "tailfollower.h"
+
+TailFollower::TailFollower(Runs *runs, PlotBookModel *bookModel,
+                           int interval, QObject *parent) :
+    QObject(parent),
+    _bookModel(bookModel)
+{
+    foreach ( DataModel* model, runs->models() ) {
+        _file2model.insert(model->fileName(),model);
+    }
+    if ( !_file2model.isEmpty() ) {
+        _watcher.addPaths(_file2model.keys());
+    }
+
+    _timer.setSingleShot(true);
+    _timer.setInterval(interval);
+
+    connect(&_watcher,SIGNAL(fileChanged(QString)),
+            this,SLOT(_fileChanged(QString)));
+    connect(&_timer,SIGNAL(timeout()),this,SLOT(_update()));
+}
+
+void TailFollower::_fileChanged(const QString &fileName)
+{
+    _dirtyFiles.insert(fileName);
+    if ( !_timer.isActive() ) {
+        _timer.start();
+    }
+
+    // Some writers replace the file, which drops it from the watch list
+    if ( !_watcher.files().contains(fileName) ) {
+        _watcher.addPath(fileName);
+    }
+}
+
+void TailFollower::_update()
+{
+    if ( _bookModel->isPrinting() ) {
+        _timer.start(); // models must not change under page workers
+        return;
+    }
+
+    bool isGrown = false;
+    QSet<QString> busyFiles;
+    foreach ( QString fileName, _dirtyFiles ) {
+        DataModel* model = _file2model.value(fileName,0);
+        if ( !model ) {
+            continue;
+        }
+        int nrows = model->grow();
+        if ( nrows < 0 ) {
+            busyFiles.insert(fileName); // pinned by a worker, try again
+        } else if ( nrows > 0 ) {
+            isGrown = true;
+        }
+    }
+    _dirtyFiles = busyFiles;
+    if ( !_dirtyFiles.isEmpty() ) {
+        _timer.start();
+    }
+
+    if ( isGrown ) {
+        _bookModel->growCurves();
+    }
+}
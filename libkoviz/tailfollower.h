@@ -0,0 +1,43 @@
+#ifndef TAIL_FOLLOWER_H
+#define TAIL_FOLLOWER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include "runs.h"
+#include "datamodel.h"
+#include "bookmodel.h"
+
+//
+// Live mode for RUNs that a sim is still logging (see -follow).
+//
+// The RUNs' files are watched (inotify on Linux) for writes.  A write
+// only marks its file dirty.  At most once per interval, dirty models
+// pick up their appended records (DataModel::grow()) and the book
+// extends its curves by the new rows.  A sim may write many times a
+// second, the interval bounds how often koviz repaints regardless.
+//
+class TailFollower : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TailFollower(Runs* runs, PlotBookModel* bookModel, int interval,
+                 QObject* parent=0);
+
+  private slots:
+    void _fileChanged(const QString& fileName);
+    void _update();
+
+  private:
+    PlotBookModel* _bookModel;
+    QFileSystemWatcher _watcher;
+    QTimer _timer;
+    QHash<QString,DataModel*> _file2model;
+    QSet<QString> _dirtyFiles;
+};
+
+#endif // TAIL_FOLLOWER_H
@@ -171,27 +171,7 @@ void Thread::_do_stats()
             while ( !it->isDone() && it->t()+epsilon < tnext ) {
 
                 jobTimeStampsAcrossFrame.append(it->t());
-
-                foreach ( Job* job, _jobs ) {
-
-                    if ( job->isFrameTimerJob() ) {
-                        // For Trick 13
-                        // Do not use child frame scheduling time for frame
-                        // time sum.  Koviz reports the sum of the userjobs,
-                        // not the frame scheduling time since the frame
-                        // scheduling time includes executive overhead
-                        // (e.g. the frame logging itself).
-                        continue;
-                    }
-
-                    ModelIterator* it2 = job->curve()->begin();
-                    double ft = it2->at(tidx)->x();
-                    delete it2;
-                    if ( ft < 0 ) {
-                        ft = 0.0;
-                    }
-                    frame_time += ft;
-                }
+                frame_time += _jobsRuntime(tidx);
                 ++tidx;
                 it->next();
 
@@ -243,6 +223,37 @@ void Thread::_do_stats()
     }
 }
 
+// Sum of the thread's job runtimes logged at row tidx
+double Thread::_jobsRuntime(int tidx) const
+{
+    if ( tidx < _jobsRuntimes.size() ) {
+        return _jobsRuntimes.at(tidx); // summed by JobStats
+    }
+
+    double rt = 0.0;
+    foreach ( Job* job, _jobs ) {
+
+        if ( job->isFrameTimerJob() ) {
+            // For Trick 13
+            // Do not use child frame scheduling time for frame
+            // time sum.  Koviz reports the sum of the userjobs,
+            // not the frame scheduling time since the frame
+            // scheduling time includes executive overhead
+            // (e.g. the frame logging itself).
+            continue;
+        }
+
+        ModelIterator* it2 = job->curve()->begin();
+        double ft = it2->at(tidx)->x();
+        delete it2;
+        if ( ft < 0 ) {
+            ft = 0.0;
+        }
+        rt += ft;
+    }
+    return rt;
+}
+
 //
 // Guess the thread freq by:
 //
@@ -466,7 +477,8 @@ double Thread::avgJobLoad(Job *job) const
 }
 
 Threads::Threads(const QString &runDir, const QList<Job*>& jobs,
-                 const QStringList &timeNames) :
+                 const QStringList &timeNames,
+                 const QMap<int, QVector<double> > &threadRuntimes) :
     _jobs(jobs),_timeNames(timeNames)
 {
     foreach ( Job* job, _jobs ) {
@@ -486,6 +498,7 @@ Threads::Threads(const QString &runDir, const QList<Job*>& jobs,
 
     bool isRealTime = false;
     foreach ( Thread* thread, _threads.values() ) {
+        thread->_jobsRuntimes = threadRuntimes.value(thread->threadId());
         thread->_do_stats();
         if ( thread->threadId() == 0 && thread->isRealTime()) {
             isRealTime = true;
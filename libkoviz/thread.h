@@ -14,6 +14,8 @@
 #include <QDataStream>
 #include <QRegExp>
 #include <QFileInfo>
+#include <QMap>
+#include <QVector>
 
 #include "datamodel.h"
 
@@ -83,6 +85,9 @@ class Thread
 
     QMap<double,double> _jobtimestamp2frametime;
 
+    QVector<double> _jobsRuntimes; // per row sum of job runtimes (JobStats)
+    double _jobsRuntime(int tidx) const;
+
     SnapTable* _runtimeCurve; // t,runtime curve
 
     DataModel* _frameModel;
@@ -99,7 +104,9 @@ class Threads
 {
   public:
     Threads(const QString& runDir, const QList<Job *> &jobs,
-            const QStringList &timeNames);
+            const QStringList &timeNames,
+            const QMap<int,QVector<double> >& threadRuntimes=
+                                            QMap<int,QVector<double> >());
     ~Threads();
     const QMap<int,Thread*>* hash() { return &_threads; }
 
@@ -0,0 +1,106 @@
+#include "timeindex.h"
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+TimeIndex::TimeIndex(const QVector<double> &times) :
+    _t(times),
+    _rate(0.0)
+{
+    _calcRate();
+}
+
+void TimeIndex::append(const double *times, int n)
+{
+    if ( n <= 0 ) {
+        return;
+    }
+    int i0 = _t.size();
+    _t.resize(i0+n);
+    memcpy(_t.data()+i0,times,n*sizeof(double));
+    _calcRate();
+}
+
+void TimeIndex::_calcRate()
+{
+    _rate = 0.0;
+    int n = _t.size();
+    if ( n > 1 ) {
+        double span = _t.last()-_t.first();
+        if ( span > 0.0 && std::isfinite(span) ) {
+            _rate = (n-1)/span;
+        }
+    }
+}
+
+int TimeIndex::indexAtTime(double time) const
+{
+    int n = _t.size();
+    if ( n <= 1 ) {
+        return 0;
+    }
+
+    int i = _lowerBound(time);
+    if ( i == n ) {
+        i = n-1;
+    } else if ( i > 0 && _t.at(i) != time &&
+                qAbs(time-_t.at(i-1)) < qAbs(_t.at(i)-time) ) {
+        // Time not found, closest is the earlier row
+        i = i-1;
+    }
+
+    // Duplicate stamps (e.g. around a checkpoint reload) go to the last
+    // row logged with the time
+    const double* t = _t.constData();
+    return std::upper_bound(t+i,t+n,t[i])-t-1;
+}
+
+int TimeIndex::upperBound(double time) const
+{
+    int n = _t.size();
+    const double* t = _t.constData();
+    return std::upper_bound(t+_lowerBound(time),t+n,time)-t;
+}
+
+// First row with t >= time (n if none)
+int TimeIndex::_lowerBound(double time) const
+{
+    int n = _t.size();
+    const double* t = _t.constData();
+    int lo = 0;
+    int hi = n;
+
+    if ( _rate > 0.0 ) {
+        // Guess, then gallop until [lo,hi] brackets the answer
+        double g = (time-t[0])*_rate;
+        int guess = 0;
+        if ( g >= n-1 ) {
+            guess = n-1;
+        } else if ( g > 0.0 ) {    // false for nan too
+            guess = (int)g;
+        }
+
+        int step = 1;
+        if ( t[guess] < time ) {
+            lo = guess+1;
+            int p = lo;
+            while ( p < n && t[p] < time ) {
+                lo = p+1;
+                p = lo+step;
+                step *= 2;
+            }
+            hi = qMin(p,n);
+        } else {
+            hi = guess;
+            int p = hi-1;
+            while ( p >= 0 && !(t[p] < time) ) {
+                hi = p;
+                p = hi-step;
+                step *= 2;
+            }
+            lo = qMax(p+1,0);
+        }
+    }
+
+    return std::lower_bound(t+lo,t+hi,time)-t;
+}
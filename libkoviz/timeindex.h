@@ -0,0 +1,46 @@
+#ifndef TIME_INDEX_H
+#define TIME_INDEX_H
+
+#include <QVector>
+
+//
+// Decoded copy of a time column for closest row lookups.
+//
+// Models used to binary search their time column through an iterator,
+// decoding a (scattered) mmap'd row at every probe.  A TimeIndex holds
+// the times contiguously.  The search starts from a guess interpolated
+// from the first/last times, so uniform rate logs resolve in O(1), and
+// gallops + binary searches from there otherwise (O(log n)).
+//
+// Rows are assumed to be in time order.  Read only once built, so it
+// is safe to share between threads.  The exception is append(), which
+// the owning model only calls while no worker has it pinned.
+//
+class TimeIndex
+{
+  public:
+    explicit TimeIndex(const QVector<double>& times);
+
+    int count() const { return _t.size(); }
+    double time(int i) const { return _t.at(i); }
+
+    // Row closest to time.  Ties, and duplicate time stamps, go to the
+    // later row.
+    int indexAtTime(double time) const;
+
+    // First row with t >= time, or with t > time for upperBound()
+    // (count() if none)
+    int lowerBound(double time) const { return _lowerBound(time); }
+    int upperBound(double time) const;
+
+    // Rows logged since the index was built (see DataModel::grow())
+    void append(const double* times, int n);
+
+  private:
+    QVector<double> _t;
+    double _rate;   // rows per unit time, 0 if unknown
+    int _lowerBound(double time) const;
+    void _calcRate();
+};
+
+#endif // TIME_INDEX_H
@@ -0,0 +1,148 @@
+#include "trickheadercache.h"
+
+const quint32 TrickHeaderCache::_magic = 0x6b6f7663; // "kovc"
+const qint32 TrickHeaderCache::_version = 1;
+
+TrickHeaderCache::TrickHeaderCache()
+{
+}
+
+bool TrickHeaderCache::header(const QString &trkFile, TrickHeader *hdr)
+{
+    QFileInfo fi(trkFile);
+    QString dir = fi.absolutePath();
+    QString fname = fi.fileName();
+
+    QMutexLocker locker(&_mutex);
+
+    if ( !_loadedDirs.contains(dir) ) {
+        _load(dir);
+    }
+
+    QHash<QString,TrickHeader> headers = _dirToHeaders.value(dir);
+    if ( !headers.contains(fname) ) {
+        return false;
+    }
+
+    TrickHeader cached = headers.value(fname);
+    if ( !_isCurrent(fi,cached) ) {
+        // Log changed since cached, caller reparses and inserts
+        return false;
+    }
+
+    *hdr = cached;
+
+    return true;
+}
+
+void TrickHeaderCache::insert(const QString &trkFile, const TrickHeader &hdr)
+{
+    QFileInfo fi(trkFile);
+    QString dir = fi.absolutePath();
+
+    // Size is that of the parsed rows, not a stat of the file now.  A sim
+    // still appending may have grown the file since hdr was parsed, so
+    // a stat would pair the new size with the old nrows (and pass
+    // _isCurrent() next load with rows missing).
+    qint64 rowSize = 0;
+    foreach ( TrickHeaderParam p, hdr.params ) {
+        rowSize += p.size;
+    }
+    TrickHeader h = hdr;
+    h.fileSize = hdr.posBegData + hdr.nrows*rowSize;
+    h.mtime = fi.lastModified().toMSecsSinceEpoch();
+
+    QMutexLocker locker(&_mutex);
+    _dirToHeaders[dir].insert(fi.fileName(),h);
+    _dirtyDirs.insert(dir);
+}
+
+void TrickHeaderCache::save()
+{
+    QMutexLocker locker(&_mutex);
+
+    foreach ( QString dir, _dirtyDirs ) {
+
+        // Drop entries for logs that no longer exist
+        QHash<QString,TrickHeader> headers = _dirToHeaders.value(dir);
+        foreach ( QString fname, headers.keys() ) {
+            if ( !QFileInfo(dir + "/" + fname).exists() ) {
+                headers.remove(fname);
+            }
+        }
+
+        QFile file(dir + "/" + cacheFileName());
+        if ( !file.open(QIODevice::WriteOnly|QIODevice::Truncate) ) {
+            // RUN dir may be read only, the cache is only an optimization
+            continue;
+        }
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_4_8);
+
+        out << _magic << _version << (qint32)headers.size();
+        foreach ( QString fname, headers.keys() ) {
+            TrickHeader h = headers.value(fname);
+            out << fname << h.fileSize << h.mtime << h.trickVersion
+                << h.posBegData << h.nrows << (qint32)h.params.size();
+            foreach ( TrickHeaderParam p, h.params ) {
+                out << p.name << p.unit << p.type << p.size;
+            }
+        }
+        file.close();
+    }
+
+    _dirtyDirs.clear();
+}
+
+void TrickHeaderCache::_load(const QString &dir)
+{
+    _loadedDirs.insert(dir);
+
+    QFile file(dir + "/" + cacheFileName());
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        return;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_8);
+
+    quint32 magic;
+    qint32 version;
+    qint32 nEntries;
+    in >> magic >> version >> nEntries;
+    if ( magic != _magic || version != _version || nEntries < 0 ) {
+        // Unknown or stale format, rebuild
+        _dirtyDirs.insert(dir);
+        return;
+    }
+
+    QHash<QString,TrickHeader> headers;
+    for ( int i = 0; i < nEntries; ++i ) {
+        QString fname;
+        TrickHeader h;
+        qint32 nParams;
+        in >> fname >> h.fileSize >> h.mtime >> h.trickVersion
+           >> h.posBegData >> h.nrows >> nParams;
+        if ( in.status() != QDataStream::Ok || nParams < 0 ) {
+            _dirtyDirs.insert(dir);
+            return;
+        }
+        for ( int j = 0; j < nParams; ++j ) {
+            TrickHeaderParam p;
+            in >> p.name >> p.unit >> p.type >> p.size;
+            h.params.append(p);
+        }
+        if ( in.status() != QDataStream::Ok ) {
+            _dirtyDirs.insert(dir);
+            return;
+        }
+        headers.insert(fname,h);
+    }
+
+    _dirToHeaders.insert(dir,headers);
+}
+
+bool TrickHeaderCache::_isCurrent(const QFileInfo &fi, const TrickHeader &hdr)
+{
+    return ( fi.size() == hdr.fileSize &&
+             fi.lastModified().toMSecsSinceEpoch() == hdr.mtime );
+}
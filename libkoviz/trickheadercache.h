@@ -0,0 +1,79 @@
+#ifndef TRICK_HEADER_CACHE_H
+#define TRICK_HEADER_CACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QDataStream>
+#include <QMutex>
+#include <QMutexLocker>
+
+//
+// Parsed trk header as stored in the cache
+//
+class TrickHeaderParam
+{
+  public:
+    TrickHeaderParam() : type(0), size(0) {}
+    QString name;
+    QString unit;
+    qint32 type;
+    qint32 size;
+};
+
+class TrickHeader
+{
+  public:
+    TrickHeader() :
+        fileSize(0),
+        mtime(0),
+        trickVersion(0),
+        posBegData(0),
+        nrows(0)
+    {}
+
+    qint64 fileSize;
+    qint64 mtime;        // msecs since epoch
+    qint32 trickVersion; // TrickModel::TrickVersion
+    qint64 posBegData;
+    qint64 nrows;
+    QList<TrickHeaderParam> params;
+};
+
+//
+// On-disk cache of trk headers, one cache file per RUN directory.
+// An entry is only used when the trk file size and mtime still match,
+// otherwise the header is reparsed and the entry replaced on save().
+// Lookups and inserts may be called from the Runs loader threads.
+//
+class TrickHeaderCache
+{
+  public:
+    TrickHeaderCache();
+
+    bool header(const QString& trkFile, TrickHeader* hdr);
+    void insert(const QString& trkFile, const TrickHeader& hdr);
+    void save();
+
+    static QString cacheFileName() { return QString(".koviz_cache"); }
+
+  private:
+    QMutex _mutex;
+    QHash<QString,QHash<QString,TrickHeader> > _dirToHeaders;
+    QSet<QString> _loadedDirs;
+    QSet<QString> _dirtyDirs;
+
+    void _load(const QString& dir);
+    static bool _isCurrent(const QFileInfo& fi, const TrickHeader& hdr);
+
+    static const quint32 _magic;
+    static const qint32 _version;
+};
+
+#endif // TRICK_HEADER_CACHE_H
@@ -4,9 +4,11 @@
  */
 
 #include "unit.h"
+#include <algorithm>
 
 QHash<QPair<QString,QString>,double> Unit::_scales = Unit::_initScales();
 QHash<QPair<QString,QString>,double> Unit::_biases = Unit::_initBiases();
+Unit::Table Unit::_table = Unit::_initTable();  // after _scales and _biases
 
 Unit::Unit() :
     _name("--")
@@ -39,75 +41,63 @@ bool Unit::isEmpty() const
 
 bool Unit::canConvert(const QString& from, const QString &to)
 {
-    bool can = false;
-
-    QString fam1 = _family(from);
-    QString fam2 = _family(to);
-
-    if ( fam1 == fam2 ) {
-        can = true;
+    if ( from == to ) {
+        return true;   // even if not a unit (e.g. "--")
     }
+    return canConvert(id(from),id(to));
+}
 
-    return can;
+bool Unit::canConvert(int from, int to)
+{
+    if ( from < 0 || to < 0 ) {
+        return ( from == to );
+    }
+    return ( _table.families.at(from) == _table.families.at(to) );
 }
 
 bool Unit::isUnit(const QString &name)
 {
-    bool ok = false;
-
-    QList<QPair<QString,QString> > pairs = _scales.keys();
-    for ( int i = 0; i < pairs.size(); ++i ) {
-        QPair<QString,QString> pair = pairs.at(i);
-        if ( pair.second == name ) {
-            ok = true;
-            break;
-        }
-    }
+    return _table.ids.contains(name);
+}
 
-    return ok;
+int Unit::id(const QString &name)
+{
+    return _table.ids.value(name,-1);
 }
 
+int Unit::_checkedId(const QString &name)
+{
+    int i = id(name);
+    if ( i < 0 ) {
+        fprintf(stderr,"koviz [error]: Attempting to convert "
+                       "unsupported unit=\"%s\"\n",name.toLatin1().constData());
+        exit(-1);
+    }
+    return i;
+}
 
 double Unit::scale(const QString &from, const QString &to)
 {
     if ( from == to ) {
         return 1.0;
     }
+    return scale(_checkedId(from),_checkedId(to));
+}
 
-    if ( !isUnit(from) ) {
-        fprintf(stderr,"koviz [error]: Attempting to convert "
-                       "unsupported unit=\"%s\"\n",from.toLatin1().constData());
-        exit(-1);
-    }
-    if ( !isUnit(to) ) {
-        fprintf(stderr,"koviz [error]: Attempting to convert "
-                       "unsupported unit=\"%s\"\n",to.toLatin1().constData());
-        exit(-1);
+double Unit::scale(int from, int to)
+{
+    if ( from == to ) {
+        return 1.0;
     }
-
-    QString fam1 = _family(from);
-    QString fam2 = _family(to);
-
-    if ( fam1 != fam2 ) {
+    if ( !canConvert(from,to) ) {
         fprintf(stderr,"koviz [error]: Attempting to convert "
                        "unit=\"%s\" to unit=\"%s\"; however "
                        "these units are not in the same family.\n",
-                        from.toLatin1().constData(), to.toLatin1().constData());
+                       _table.names.value(from).toLatin1().constData(),
+                       _table.names.value(to).toLatin1().constData());
         exit(-1);
     }
-
-    QString family = fam1 = fam2;
-    double scale1 = _scales.value(qMakePair(family,from));
-    double scale2 = _scales.value(qMakePair(family,to));
-    double sf = scale1/scale2;
-
-    /*
-    fprintf(stderr,"scale factor from={%s} to={%s} is %g\n",
-                    from.toLatin1().constData(),
-                    to.toLatin1().constData(), sf);
-    */
-
-    return sf;
+    return _table.scales.at(from)/_table.scales.at(to);
 }
 
 double Unit::bias(const QString &from, const QString &to)
@@ -115,46 +105,24 @@ double Unit::bias(const QString &from, const QString &to)
     if ( from == to ) {
         return 0.0;
     }
+    return bias(_checkedId(from),_checkedId(to));
+}
 
-    if ( !isUnit(from) ) {
-        fprintf(stderr,"koviz [error]: Attempting to convert "
-                       "unsupported unit=\"%s\"\n",from.toLatin1().constData());
-        exit(-1);
-    }
-    if ( !isUnit(to) ) {
-        fprintf(stderr,"koviz [error]: Attempting to convert "
-                       "unsupported unit=\"%s\"\n",to.toLatin1().constData());
-        exit(-1);
+// Only temperatures have (nonzero) biases
+double Unit::bias(int from, int to)
+{
+    if ( from == to ) {
+        return 0.0;
     }
-
-    QString fam1 = _family(from);
-    QString fam2 = _family(to);
-    QString family = fam1 = fam2;
-
-    if ( fam1 != fam2 ) {
+    if ( !canConvert(from,to) ) {
         fprintf(stderr,"koviz [error]: Attempting to convert "
                        "unit=\"%s\" to unit=\"%s\"; however "
                        "these units are not in the same family.\n",
-                        from.toLatin1().constData(), to.toLatin1().constData());
+                       _table.names.value(from).toLatin1().constData(),
+                       _table.names.value(to).toLatin1().constData());
         exit(-1);
     }
-
-    double b = 0.0;
-
-    if ( family == "C" ) {
-        double bias1 = _biases.value(qMakePair(family,from));
-        double bias2 = _biases.value(qMakePair(family,to));
-        double scale2 = _scales.value(qMakePair(family,to));
-        b = (bias1-bias2)/scale2;
-    }
-
-    /*
-    fprintf(stderr,"bias factor from={%s} to={%s} is %g\n",
-                    from.toLatin1().constData(),
-                    to.toLatin1().constData(), b);
-    */
-
-    return b;
+    return (_table.biases.at(from)-_table.biases.at(to))/_table.scales.at(to);
 }
 
 QString Unit::next(const QString &unit)
@@ -754,16 +722,37 @@ QString Unit::_family(const QString &name)
 {
     QString family;
 
+    int i = id(name);
+    if ( i >= 0 ) {
+        family = _table.familyNames.at(_table.families.at(i));
+    }
+
+    return family;
+}
+
+// Ids are given in (family,unit) order so they are the same every run
+Unit::Table Unit::_initTable()
+{
+    Table table;
+
     QList<QPair<QString,QString> > pairs = _scales.keys();
-    for ( int i = 0; i < pairs.size(); ++i ) {
-        QPair<QString,QString> pair = pairs.at(i);
-        if ( pair.second == name ) {
-            family = pair.first;
-            break;
+    std::sort(pairs.begin(),pairs.end());
+
+    foreach ( QPair<QString,QString> pair, pairs ) {
+        if ( !table.familyNames.contains(pair.first) ) {
+            table.familyNames.append(pair.first);
         }
+        if ( table.ids.contains(pair.second) ) {
+            continue;  // a unit in two families keeps its first
+        }
+        table.ids.insert(pair.second,table.names.size());
+        table.names.append(pair.second);
+        table.families.append(table.familyNames.indexOf(pair.first));
+        table.scales.append(_scales.value(pair));
+        table.biases.append(_biases.value(pair,0.0));
     }
 
-    return family;
+    return table;
 }
 
 QStringList Unit::_sortUnits(const QStringList &unitsIn)
@@ -10,6 +10,7 @@
 #include <QPair>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
 #include <stdio.h>
@@ -38,11 +39,32 @@ class Unit {
     static QString derivative(const QString& unit);
     static QString integral(const QString& unit);
 
+    // Units are interned to small ids (-1 if not a unit), conversions
+    // between ids are array lookups
+    static int id(const QString& name);
+    static bool canConvert(int from, int to);
+    static double scale(int from, int to);
+    static double bias(int from, int to);
+
   private:
 
     QString _name;
     static QHash<QPair<QString,QString>,double> _scales;
     static QHash<QPair<QString,QString>,double> _biases;
+
+    // Dense table built from _scales and _biases, indexed by unit id
+    struct Table
+    {
+        QHash<QString,int> ids;
+        QVector<QString> names;
+        QVector<int> families;      // index into familyNames
+        QVector<double> scales;     // to the family's base unit
+        QVector<double> biases;
+        QStringList familyNames;
+    };
+    static Table _table;
+    static Table _initTable();
+    static int _checkedId(const QString& name);
     static QHash<QPair<QString,QString>,double> _initScales();
     static QHash<QPair<QString,QString>,double> _initBiases();
     static QString _family(const QString& name);